@@ -12,5 +12,6 @@
 
 #cmakedefine HAVE_MALLOC_H 1
 #cmakedefine HAVE_PTHREAD_H 1
+#cmakedefine KDENLIVE_TRACING 1
 
 #endif
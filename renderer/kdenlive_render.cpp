@@ -165,6 +165,17 @@ int main(int argc, char **argv)
         QCommandLineOption subtitleOption("subtitle", "Subtitle file.", "file");
         parser.addOption(subtitleOption);
 
+        QCommandLineOption segmentsOption("segments", "Number of time segments rendered in parallel and joined without re-encoding.", "count",
+                                          QString::number(1));
+        parser.addOption(segmentsOption);
+
+        QCommandLineOption inOption("in", "First frame to render, optional. If set it overrides the \"in\" property of the consumer in the source file.", "frame");
+        parser.addOption(inOption);
+
+        QCommandLineOption outOption("out", "Last frame to render, optional. If set it overrides the \"out\" property of the consumer in the source file.",
+                                     "frame");
+        parser.addOption(outOption);
+
         parser.process(app);
         args = parser.positionalArguments();
 
@@ -206,9 +217,18 @@ int main(int argc, char **argv)
             QString output = parser.value(outputOption);
             if (!output.isEmpty()) {
                 // A custom output target was set.
-                // To apply it we store a copy of the source file with the modified target
-                // in a temporary file and use this file instead of the original source file.
                 consumer.setAttribute(QStringLiteral("target"), output);
+            }
+            // A custom range was set, this happens when several jobs share the same source file.
+            if (parser.isSet(inOption)) {
+                consumer.setAttribute(QStringLiteral("in"), parser.value(inOption));
+            }
+            if (parser.isSet(outOption)) {
+                consumer.setAttribute(QStringLiteral("out"), parser.value(outOption));
+            }
+            if (!output.isEmpty() || parser.isSet(inOption) || parser.isSet(outOption)) {
+                // To apply the changes we store a copy of the source file with the modified consumer
+                // in a temporary file and use this file instead of the original source file.
                 QTemporaryFile tmp(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.mlt")));
                 tmp.setAutoRemove(false);
                 if (tmp.open()) {
@@ -218,7 +238,11 @@ int main(int argc, char **argv)
                         qDebug() << "Failed to set custom output destination, falling back to target set in source file: " << target;
                     } else {
                         playlist = tmp.fileName();
-                        target = output;
+                        if (!output.isEmpty()) {
+                            target = output;
+                        }
+                        in = consumer.attribute(QStringLiteral("in"), QString::number(-1)).toInt();
+                        out = consumer.attribute(QStringLiteral("out"), QString::number(-1)).toInt();
                         QTextStream outStream(&file);
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
                         outStream.setCodec("UTF-8");
@@ -236,6 +260,7 @@ int main(int argc, char **argv)
         QString subtitleFile = parser.value(subtitleOption);
 
         auto *rJob = new RenderJob(render, playlist, target, pid, in, out, subtitleFile, &app);
+        rJob->setSegmentCount(parser.value(segmentsOption).toInt());
         QObject::connect(rJob, &RenderJob::renderingFinished, rJob, [&]() {
             rJob->deleteLater();
             app.quit();
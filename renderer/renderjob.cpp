@@ -16,8 +16,11 @@
 #endif
 #include <QDebug>
 #include <QDir>
+#include <QDomDocument>
 #include <QElapsedTimer>
+#include <QRegularExpression>
 #include <QStandardPaths>
+#include <QTemporaryFile>
 #include <utility>
 // Can't believe I need to do this to sleep.
 class SleepThread : QThread
@@ -77,10 +80,16 @@ RenderJob::~RenderJob()
     }
     delete m_kdenlivesocket;
 #endif
+    cleanupSegments();
     delete m_renderProcess;
     m_logfile.close();
 }
 
+void RenderJob::setSegmentCount(int count)
+{
+    m_segmentCount = qMax(1, count);
+}
+
 void RenderJob::slotAbort(const QString &url)
 {
     if (m_dest == url) {
@@ -119,6 +128,7 @@ void RenderJob::sendFinish(int status, const QString &error)
 void RenderJob::slotAbort()
 {
     m_renderProcess->kill();
+    cleanupSegments();
     sendFinish(-3, QString());
     if (m_erase) {
         QFile(m_scenelist).remove();
@@ -271,14 +281,309 @@ void RenderJob::start()
     }
 #endif
 
-    // Because of the logging, we connect to stderr in all cases.
-    connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
-    m_renderProcess->start(m_prog, m_args);
-    m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << "\n";
-    m_logstream.flush();
+    if (m_segmentCount > 1 && prepareSegments()) {
+        startSegments();
+    } else {
+        // Because of the logging, we connect to stderr in all cases.
+        connect(m_renderProcess, &QProcess::readyReadStandardError, this, &RenderJob::receivedStderr);
+        m_renderProcess->start(m_prog, m_args);
+        m_logstream << "Started render process: " << m_prog << ' ' << m_args.join(QLatin1Char(' ')) << "\n";
+        m_logstream.flush();
+    }
     m_looper.exec();
 }
 
+bool RenderJob::prepareSegments()
+{
+    if (m_framein < 0 || m_frameout <= m_framein) {
+        m_logstream << "Unknown render range, rendering in a single process\n";
+        return false;
+    }
+    if (QStandardPaths::findExecutable(QStringLiteral("ffmpeg")).isEmpty()) {
+        m_logstream << "FFmpeg not found, cannot join segments, rendering in a single process\n";
+        return false;
+    }
+    QFile file(m_scenelist);
+    QDomDocument doc;
+    if (!file.open(QIODevice::ReadOnly) || !doc.setContent(&file, false)) {
+        return false;
+    }
+    file.close();
+    QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+    if (consumer.isNull() || consumer.hasAttribute(QStringLiteral("pass")) || m_dest.contains(QLatin1Char('%'))) {
+        // Two pass and image sequences cannot be joined
+        return false;
+    }
+
+    // Every segment starts with a keyframe, so align segment boundaries on the GOP size
+    // to keep the regular keyframe interval of a single process render
+    int gop = consumer.attribute(QStringLiteral("g")).toInt();
+    if (gop <= 0) {
+        // Default to one second
+        QDomElement profile = doc.documentElement().firstChildElement(QStringLiteral("profile"));
+        const int num = profile.attribute(QStringLiteral("frame_rate_num"), QStringLiteral("25")).toInt();
+        const int den = qMax(1, profile.attribute(QStringLiteral("frame_rate_den"), QStringLiteral("1")).toInt());
+        gop = qMax(1, qRound(double(num) / den));
+    }
+    const int total = m_frameout - m_framein + 1;
+    const int count = qMin(m_segmentCount, total / gop);
+    if (count < 2) {
+        return false;
+    }
+    const int length = ((total + count - 1) / count + gop - 1) / gop * gop;
+    if (consumer.attribute(QStringLiteral("vn")) == QLatin1String("1") || consumer.attribute(QStringLiteral("video_off")) == QLatin1String("1")) {
+        // Audio only renders are not worth splitting
+        return false;
+    }
+    // Audio encoders add priming samples at the start of each stream, joining audio segments would leave gaps.
+    // The audio is rendered in a single pass while the video segments are rendered without audio.
+    const bool hasAudio = consumer.attribute(QStringLiteral("an")) != QLatin1String("1") && consumer.attribute(QStringLiteral("audio_off")) != QLatin1String("1");
+    if (hasAudio) {
+        consumer.setAttribute(QStringLiteral("an"), 1);
+        consumer.setAttribute(QStringLiteral("audio_off"), 1);
+    }
+
+    const QFileInfo destInfo(m_dest);
+    auto addSegment = [this, &doc, &consumer](Segment &segment) {
+        consumer.setAttribute(QStringLiteral("in"), segment.in);
+        consumer.setAttribute(QStringLiteral("out"), segment.out);
+        consumer.setAttribute(QStringLiteral("target"), segment.output);
+
+        QTemporaryFile tmp(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.mlt")));
+        tmp.setAutoRemove(false);
+        if (!tmp.open()) {
+            cleanupSegments();
+            return false;
+        }
+        QTextStream outStream(&tmp);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+        outStream.setCodec("UTF-8");
+#endif
+        outStream << doc.toString();
+        outStream.flush();
+        tmp.close();
+        segment.playlist = tmp.fileName();
+        m_segments.push_back(segment);
+        return true;
+    };
+    for (int in = m_framein, index = 1; in <= m_frameout; in += length, ++index) {
+        Segment segment;
+        segment.in = in;
+        segment.out = qMin(in + length - 1, m_frameout);
+        segment.frame = in;
+        segment.output = destInfo.absoluteDir().absoluteFilePath(QStringLiteral("%1.part%2.%3").arg(destInfo.completeBaseName()).arg(index).arg(destInfo.suffix()));
+        if (!addSegment(segment)) {
+            return false;
+        }
+    }
+    if (hasAudio) {
+        Segment segment;
+        segment.in = m_framein;
+        segment.out = m_frameout;
+        segment.frame = m_framein;
+        segment.audio = true;
+        segment.output = destInfo.absoluteDir().absoluteFilePath(QStringLiteral("%1.partaudio.%2").arg(destInfo.completeBaseName(), destInfo.suffix()));
+        consumer.removeAttribute(QStringLiteral("an"));
+        consumer.removeAttribute(QStringLiteral("audio_off"));
+        consumer.setAttribute(QStringLiteral("vn"), 1);
+        consumer.setAttribute(QStringLiteral("video_off"), 1);
+        if (!addSegment(segment)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RenderJob::startSegments()
+{
+    m_segmentsCanceled = false;
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+        Segment &segment = m_segments[i];
+        segment.process = new QProcess(&m_looper);
+        segment.process->setReadChannel(QProcess::StandardError);
+        connect(segment.process, &QProcess::readyReadStandardError, this, [this, i]() { receivedSegmentStderr(i); });
+        connect(segment.process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, i](int exitCode, QProcess::ExitStatus exitStatus) { segmentFinished(i, exitCode, exitStatus); });
+        const QStringList args = {QStringLiteral("-progress"), segment.playlist};
+        segment.process->start(m_prog, args);
+        m_logstream << "Started render process for frames " << segment.in << '-' << segment.out << ": " << m_prog << ' ' << args.join(QLatin1Char(' '))
+                    << "\n";
+    }
+    m_logstream.flush();
+}
+
+void RenderJob::receivedSegmentStderr(size_t index)
+{
+    if (m_segmentsCanceled || index >= m_segments.size()) {
+        return;
+    }
+    Segment &segment = m_segments[index];
+    if (segment.process == nullptr) {
+        // A queued signal of an already finished segment
+        return;
+    }
+    const QString result = QString::fromLocal8Bit(segment.process->readAllStandardError()).simplified();
+    static const QRegularExpression frameExpr(QStringLiteral("Current Frame:\\s*(\\d+)"));
+    QRegularExpressionMatchIterator matches = frameExpr.globalMatch(result);
+    if (!matches.hasNext()) {
+        if (!result.isEmpty()) {
+            m_errorMessage.append(result + QStringLiteral("<br>"));
+            m_logstream << result;
+        }
+        return;
+    }
+    while (matches.hasNext()) {
+        segment.frame = matches.next().captured(1).toInt();
+    }
+
+    // Aggregate the progress of all segments
+    int done = 0;
+    for (const Segment &s : m_segments) {
+        if (s.audio) {
+            // Audio encoding is much faster than the video segments, it does not weigh on the progress
+            continue;
+        }
+        done += s.finished ? s.out - s.in + 1 : qBound(0, s.frame - s.in, s.out - s.in + 1);
+    }
+    const int total = m_frameout - m_framein + 1;
+    // Keep the last percent for joining the segments
+    const int progress = qMin(99, int(100LL * done / total));
+    if (progress <= m_progress) {
+        return;
+    }
+    m_progress = progress;
+    qint64 elapsedTime = m_startTime.secsTo(QDateTime::currentDateTime());
+    if (elapsedTime == m_seconds) {
+        return;
+    }
+    int speed = int((m_framein + done - m_frame) / (elapsedTime - m_seconds));
+    m_seconds = elapsedTime;
+    m_frame = m_framein + done;
+    updateProgress(speed);
+}
+
+void RenderJob::segmentFinished(size_t index, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (m_segmentsCanceled || index >= m_segments.size()) {
+        return;
+    }
+    Segment &segment = m_segments[index];
+    // Read the last messages, the process signals are disconnected before it is deleted
+    receivedSegmentStderr(index);
+    segment.finished = true;
+    segment.process->disconnect(this);
+    segment.process->deleteLater();
+    segment.process = nullptr;
+    if (exitStatus == QProcess::CrashExit || exitCode != 0 || !QFile::exists(segment.output)) {
+        m_segmentsCanceled = true;
+        m_frame = segment.frame;
+        m_errorMessage.append(tr("Rendering of frames %1 to %2 failed.").arg(segment.in).arg(segment.out) + QStringLiteral("<br>"));
+        cleanupSegments();
+        slotIsOver(QProcess::CrashExit);
+        return;
+    }
+    m_logstream << "Frames " << segment.in << '-' << segment.out << " rendered\n";
+    for (const Segment &s : m_segments) {
+        if (!s.finished) {
+            return;
+        }
+    }
+    // All segments are ready, join them
+    m_progress = 99;
+    m_frame = m_frameout;
+    updateProgress();
+    if (!concatSegments()) {
+        cleanupSegments();
+        slotIsOver(QProcess::CrashExit);
+    }
+}
+
+bool RenderJob::concatSegments()
+{
+    QTemporaryFile list(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-XXXXXX.txt")));
+    list.setAutoRemove(false);
+    if (!list.open()) {
+        m_errorMessage.append(tr("Cannot create temporary file.") + QStringLiteral("<br>"));
+        return false;
+    }
+    QTextStream listStream(&list);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    listStream.setCodec("UTF-8");
+#endif
+    QString audio;
+    for (const Segment &segment : m_segments) {
+        if (segment.audio) {
+            audio = segment.output;
+            continue;
+        }
+        QString path = segment.output;
+        path.replace(QLatin1Char('\''), QStringLiteral("'\\''"));
+        listStream << "file '" << path << "'\n";
+    }
+    listStream.flush();
+    list.close();
+    m_concatList = list.fileName();
+
+    // Video segments use the same encoding parameters, stream copy them into the destination with the audio rendered in one pass
+    QStringList args = {"-y", "-v", "error", "-f", "concat", "-safe", "0", "-i", m_concatList};
+    if (audio.isEmpty()) {
+        args << "-map" << "0";
+    } else {
+        args << "-i" << audio << "-map" << "0:v" << "-map" << "1:a";
+    }
+    args << "-c" << "copy" << m_dest;
+    m_logstream << "Joining segments: ffmpeg " << args.join(QLatin1Char(' ')) << "\n";
+    m_concatProcess = new QProcess(this);
+    m_concatProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_concatProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &RenderJob::concatFinished);
+    m_concatProcess->start(QStandardPaths::findExecutable(QStringLiteral("ffmpeg")), args);
+    return true;
+}
+
+void RenderJob::concatFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    const QString output = QString::fromLocal8Bit(m_concatProcess->readAll()).simplified();
+    if (!output.isEmpty()) {
+        m_logstream << output << "\n";
+    }
+    const bool joined = exitStatus == QProcess::NormalExit && exitCode == 0 && QFile::exists(m_dest);
+    if (!joined) {
+        m_errorMessage.append(tr("Joining the rendered segments failed.") + QStringLiteral("<br>") + output);
+    }
+    cleanupSegments();
+    slotIsOver(joined ? QProcess::NormalExit : QProcess::CrashExit);
+}
+
+void RenderJob::cleanupSegments()
+{
+    m_segmentsCanceled = true;
+    for (Segment &segment : m_segments) {
+        if (segment.process) {
+            if (segment.process->state() != QProcess::NotRunning) {
+                segment.process->kill();
+                segment.process->waitForFinished();
+            }
+            segment.process->deleteLater();
+        }
+        QFile::remove(segment.playlist);
+        QFile::remove(segment.output);
+    }
+    m_segments.clear();
+    if (m_concatProcess) {
+        if (m_concatProcess->state() != QProcess::NotRunning) {
+            m_concatProcess->disconnect(this);
+            m_concatProcess->kill();
+            m_concatProcess->waitForFinished();
+        }
+        m_concatProcess->deleteLater();
+        m_concatProcess = nullptr;
+    }
+    if (!m_concatList.isEmpty()) {
+        QFile::remove(m_concatList);
+        m_concatList.clear();
+    }
+}
+
 #ifndef NODBUS
 void RenderJob::initKdenliveDbusInterface()
 {
@@ -19,6 +19,8 @@
 // Testing
 #include <QTextStream>
 
+#include <vector>
+
 class RenderJob : public QObject
 {
     Q_OBJECT
@@ -27,6 +29,9 @@ public:
     RenderJob(const QString &render, const QString &scenelist, const QString &target, int pid = -1, int in = -1, int out = -1,
               const QString &subtitleFile = QString(), QObject *parent = nullptr);
     ~RenderJob() override;
+    /** @brief Render in @param count time segments by parallel processes, joined without re-encoding when all are done.
+     *  The audio is rendered in a separate single pass so that no encoder priming gap is introduced at the joins. */
+    void setSegmentCount(int count);
 
 public Q_SLOTS:
     void start();
@@ -72,6 +77,37 @@ private:
     QStringList m_args;
     /** @brief Used to write to the log file. */
     QTextStream m_logstream;
+    struct Segment
+    {
+        int in;
+        int out;
+        /** @brief Last frame reported by the segment's render process */
+        int frame;
+        QString playlist;
+        QString output;
+        QProcess *process = nullptr;
+        bool finished = false;
+        /** @brief The whole range rendered without video, joined to the video segments */
+        bool audio = false;
+    };
+    int m_segmentCount = 1;
+    std::vector<Segment> m_segments;
+    /** @brief Set when a segment failed or the job was aborted, other segments are then ignored */
+    bool m_segmentsCanceled = false;
+    /** @brief Split the scene list in segment playlists. @returns false if the job cannot be segmented */
+    bool prepareSegments();
+    void startSegments();
+    void receivedSegmentStderr(size_t index);
+    void segmentFinished(size_t index, int exitCode, QProcess::ExitStatus exitStatus);
+    /** @brief The process joining the rendered segments */
+    QProcess *m_concatProcess = nullptr;
+    /** @brief The segment list file read by the join process */
+    QString m_concatList;
+    /** @brief Start joining the rendered segments into the destination file. @returns false if the join could not be started */
+    bool concatSegments();
+    void concatFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    /** @brief Stop running segment processes and remove all intermediate files */
+    void cleanupSegments();
 #ifdef NODBUS
     void fromServer();
 #else
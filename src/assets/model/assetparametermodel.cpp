@@ -302,7 +302,13 @@ void AssetParameterModel::setParameter(const QString &name, int value, bool upda
     }
     if (update) {
         Q_EMIT modelChanged();
-        Q_EMIT dataChanged(index(0, 0), index(m_rows.count() - 1, 0), {});
+        int row = m_rows.indexOf(name);
+        if (row > -1) {
+            Q_EMIT dataChanged(index(row, 0), index(row, 0), {});
+        } else {
+            // Not a displayed parameter (for example in or out), it may affect all rows
+            Q_EMIT dataChanged(index(0, 0), index(m_rows.count() - 1, 0), {});
+        }
         // Update fades in timeline
         pCore->updateItemModel(m_ownerId, m_assetId, name);
         if (!m_isAudio) {
@@ -453,6 +459,16 @@ const QChar AssetParameterModel::getKeyframeType(const QString keyframeString)
 }
 
 void AssetParameterModel::setParameter(const QString &name, const QString &paramValue, bool update, const QModelIndex &paramIndex)
+{
+    doSetParameter(name, paramValue, update, paramIndex, true);
+}
+
+void AssetParameterModel::setIntermediateParameter(const QString &name, const QString &paramValue, const QModelIndex &paramIndex)
+{
+    doSetParameter(name, paramValue, false, paramIndex, false);
+}
+
+void AssetParameterModel::doSetParameter(const QString &name, const QString &paramValue, bool update, const QModelIndex &paramIndex, bool finalValue)
 {
     qDebug() << "// PROCESSING PARAM CHANGE: " << name << ", UPDATE: " << update << ", VAL: " << paramValue;
     internalSetParameter(name, paramValue, paramIndex);
@@ -507,8 +523,10 @@ void AssetParameterModel::setParameter(const QString &name, const QString &param
         if (!m_isAudio) {
             // Trigger monitor refresh
             pCore->refreshProjectItem(m_ownerId);
-            // Invalidate timeline preview
-            pCore->invalidateItem(m_ownerId);
+            if (finalValue) {
+                // Invalidate timeline preview
+                pCore->invalidateItem(m_ownerId);
+            }
         }
     }
 }
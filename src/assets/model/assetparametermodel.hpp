@@ -149,6 +149,10 @@ public:
      */
     Q_INVOKABLE void setParameter(const QString &name, const QString &paramValue, bool update = true, const QModelIndex &paramIndex = QModelIndex());
     void setParameter(const QString &name, int value, bool update = true);
+    /** @brief Set a parameter while its value is interactively changed, for example when dragging a slider.
+       The monitor is refreshed but the timeline preview is only invalidated by the setParameter call storing the final value
+     */
+    void setIntermediateParameter(const QString &name, const QString &paramValue, const QModelIndex &paramIndex);
 
     /** @brief Return all the parameters as pairs (parameter name, parameter value) */
     QVector<QPair<QString, QVariant>> getAllParameters() const;
@@ -278,6 +282,8 @@ protected:
      *  building an effect in the constructor, so that we don't call shared_from_this
      */
     void internalSetParameter(const QString name, const QString paramValue, const QModelIndex &paramIndex = QModelIndex());
+    /** @brief Set the parameter and update the views, the timeline preview is invalidated if @param finalValue is true */
+    void doSetParameter(const QString &name, const QString &paramValue, bool update, const QModelIndex &paramIndex, bool finalValue);
 
 Q_SIGNALS:
     void modelChanged();
@@ -23,6 +23,7 @@
 #include <QMenu>
 #include <QStandardPaths>
 #include <QVBoxLayout>
+#include <algorithm>
 #include <utility>
 
 AssetParameterView::AssetParameterView(QWidget *parent)
@@ -36,6 +37,14 @@ AssetParameterView::AssetParameterView(QWidget *parent)
     setFont(QFontDatabase::systemFont(QFontDatabase::SmallestReadableFont));
     // Presets Combo
     m_presetMenu = new QMenu(this);
+    m_intermediateTimer.setSingleShot(true);
+    connect(&m_intermediateTimer, &QTimer::timeout, this, [this]() {
+        if (!m_intermediateValues.isEmpty()) {
+            applyIntermediateValues();
+            // Keep throttling while values keep coming
+            m_intermediateTimer.start();
+        }
+    });
 }
 
 void AssetParameterView::setModel(const std::shared_ptr<AssetParameterModel> &model, QSize frameSize, bool addSpacer)
@@ -172,6 +181,13 @@ void AssetParameterView::disableCurrentFilter(bool disable)
 void AssetParameterView::commitChanges(const QModelIndex &index, const QString &value, bool storeUndo)
 {
     // Warning: please note that some widgets (for example keyframes) do NOT send the valueChanged signal and do modifications on their own
+    if (!storeUndo && !m_model->data(index, AssetParameterModel::NameRole).toString().contains(QLatin1Char('\n'))) {
+        // Intermediate value, for example while dragging a slider
+        queueIntermediateValue(index, value);
+        return;
+    }
+    // The undo command must start from the last applied value
+    applyIntermediateValues();
     const QString previousValue = m_model->data(index, AssetParameterModel::ValueRole).toString();
     auto *command = new AssetCommand(m_model, index, value);
     if (storeUndo && m_model->getOwnerId().itemId != -1) {
@@ -185,6 +201,37 @@ void AssetParameterView::commitChanges(const QModelIndex &index, const QString &
     }
 }
 
+void AssetParameterView::queueIntermediateValue(const QModelIndex &index, const QString &value)
+{
+    auto it = std::find_if(m_intermediateValues.begin(), m_intermediateValues.end(),
+                           [&index](const QPair<QPersistentModelIndex, QString> &pending) { return pending.first == index; });
+    if (it != m_intermediateValues.end()) {
+        it->second = value;
+    } else {
+        m_intermediateValues.append({QPersistentModelIndex(index), value});
+    }
+    if (!m_intermediateTimer.isActive()) {
+        // Apply the first value of a burst immediately and the next ones when the timer fires
+        applyIntermediateValues();
+        m_intermediateTimer.start(qMax(1, qRound(1000. / pCore->getCurrentFps())));
+    }
+}
+
+void AssetParameterView::applyIntermediateValues()
+{
+    m_intermediateTimer.stop();
+    const QVector<QPair<QPersistentModelIndex, QString>> pending = m_intermediateValues;
+    m_intermediateValues.clear();
+    if (!m_model) {
+        return;
+    }
+    for (const auto &value : pending) {
+        if (value.first.isValid()) {
+            m_model->setIntermediateParameter(m_model->data(value.first, AssetParameterModel::NameRole).toString(), value.second, value.first);
+        }
+    }
+}
+
 void AssetParameterView::commitMultipleChanges(const QList<QModelIndex> &indexes, const QStringList &values, bool storeUndo)
 {
     // Warning: please note that some widgets (for example keyframes) do NOT send the valueChanged signal and do modifications on their own
@@ -199,6 +246,7 @@ void AssetParameterView::commitMultipleChanges(const QList<QModelIndex> &indexes
 
 void AssetParameterView::unsetModel()
 {
+    applyIntermediateValues();
     QMutexLocker lock(&m_lock);
     if (m_model) {
         // if a model is already there, we have to disconnect signals first
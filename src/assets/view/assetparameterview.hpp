@@ -8,6 +8,7 @@
 #include "definitions.h"
 #include <QModelIndex>
 #include <QMutex>
+#include <QTimer>
 #include <QVector>
 #include <QWidget>
 #include <memory>
@@ -80,7 +81,13 @@ protected:
     std::shared_ptr<QActionGroup> m_presetGroup;
 
 private:
+    /** @brief Values sent while a parameter is interactively changed, for example by dragging a slider. Only the last value of each
+       parameter is kept, they are applied at most once per monitor frame */
+    QVector<QPair<QPersistentModelIndex, QString>> m_intermediateValues;
+    QTimer m_intermediateTimer;
     QVector<QPair<QString, QVariant>> getDefaultValues() const;
+    void queueIntermediateValue(const QModelIndex &index, const QString &value);
+    void applyIntermediateValues();
 
 private Q_SLOTS:
     /** @brief Apply a change of parameter sent by the view
@@ -21,6 +21,7 @@ AudioLevelWidget::AudioLevelWidget(int width, int sliderHandle, QWidget *parent)
     , audioChannels(pCore->audioChannels())
     , m_width(width)
     , m_offset(fontMetrics().boundingRect(QStringLiteral("-45")).width() + 4)
+    , m_loudness(-100.)
     , m_channelWidth(width / 2)
     , m_channelDistance(2)
     , m_channelFillWidth(m_channelWidth)
@@ -215,6 +216,12 @@ void AudioLevelWidget::setAudioValues(const QVector<double> &values)
     update();
 }
 
+void AudioLevelWidget::setLoudness(const QVector<double> &peakHold, double loudness)
+{
+    m_peakHold = peakHold;
+    m_loudness = loudness;
+}
+
 void AudioLevelWidget::setVisibility(bool enable)
 {
     if (enable) {
@@ -273,5 +280,13 @@ void AudioLevelWidget::updateToolTip()
             tip.append(i18nc("R as in Right", "\nR:"));
         }
     }
+    if (m_peakHold.size() == channels) {
+        double peak = -100.;
+        for (double value : qAsConst(m_peakHold)) {
+            peak = qMax(peak, value);
+        }
+        tip.append(i18n("\nPeak: %1dB", QString::number(peak, 'f', 2)));
+        tip.append(i18n("\nLoudness (3s): %1dB", QString::number(m_loudness, 'f', 2)));
+    }
     QToolTip::showText(QCursor::pos(), tip, this);
 }
@@ -40,6 +40,8 @@ private:
     QPixmap m_pixmap;
     QVector<double> m_peaks;
     QVector<double> m_values;
+    QVector<double> m_peakHold;
+    double m_loudness;
     int m_maxDb;
     int m_channelWidth;
     int m_channelDistance;
@@ -52,4 +54,6 @@ private:
 
 public Q_SLOTS:
     void setAudioValues(const QVector<double> &values);
+    /** @brief Set the peak hold (per channel) and short-term loudness values displayed in the tooltip, in dB */
+    void setLoudness(const QVector<double> &peakHold, double loudness);
 };
@@ -0,0 +1,194 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audiometerservice.hpp"
+#include "kdenlivesettings.h"
+
+#include <cmath>
+
+TrackLevelBuffer::TrackLevelBuffer(int channels, int capacity)
+    : m_channels(qBound(1, channels, int(MaxChannels)))
+{
+    int size = 16;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_mask = size - 1;
+    m_slots.reset(new Slot[size_t(size)]);
+}
+
+void TrackLevelBuffer::store(int position, const double *levels, int count)
+{
+    Slot &slot = m_slots[size_t(position & m_mask)];
+    // Invalidate the slot first so that a concurrent reader never mixes values of two frames
+    slot.position.store(-1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    count = qMin(count, m_channels);
+    for (int i = 0; i < count; i++) {
+        slot.levels[size_t(i)].store(float(levels[i]), std::memory_order_relaxed);
+    }
+    for (int i = count; i < m_channels; i++) {
+        slot.levels[size_t(i)].store(-100.f, std::memory_order_relaxed);
+    }
+    slot.position.store(position, std::memory_order_release);
+}
+
+bool TrackLevelBuffer::read(int position, QVector<double> &levels) const
+{
+    const Slot &slot = m_slots[size_t(position & m_mask)];
+    if (slot.position.load(std::memory_order_acquire) != position) {
+        return false;
+    }
+    levels.resize(m_channels);
+    for (int i = 0; i < m_channels; i++) {
+        levels[i] = double(slot.levels[size_t(i)].load(std::memory_order_relaxed));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // If the writer reused the slot while we were copying, the values are not reliable
+    return slot.position.load(std::memory_order_relaxed) == position;
+}
+
+void TrackLevelBuffer::clear()
+{
+    for (int i = 0; i <= m_mask; i++) {
+        m_slots[size_t(i)].position.store(-1, std::memory_order_relaxed);
+    }
+}
+
+int TrackLevelBuffer::channels() const
+{
+    return m_channels;
+}
+
+int TrackLevelBuffer::capacity() const
+{
+    return m_mask + 1;
+}
+
+AudioMeterService::AudioMeterService(QObject *parent)
+    : QObject(parent)
+    , m_pendingPosition(-1)
+    , m_peakHoldFrames(50)
+{
+    m_pendingTimer.setSingleShot(true);
+    connect(&m_pendingTimer, &QTimer::timeout, this, &AudioMeterService::publish);
+}
+
+std::shared_ptr<TrackLevelBuffer> AudioMeterService::registerTrack(int tid, int channels, double fps)
+{
+    TrackState &state = m_tracks[tid];
+    // Keep 1.5 seconds of levels, so that no frame is lost between two refreshes
+    state.buffer = std::make_shared<TrackLevelBuffer>(channels, qMax(30, int(fps * 1.5)));
+    // Short-term loudness is measured over 3 seconds
+    state.power.assign(size_t(qMax(1, qRound(fps * 3))), 0.);
+    m_peakHoldFrames = qMax(1, qRound(fps * 2));
+    resetState(state);
+    return state.buffer;
+}
+
+void AudioMeterService::deregisterTrack(int tid)
+{
+    m_tracks.erase(tid);
+}
+
+const AudioMeterReading &AudioMeterService::reading(int tid) const
+{
+    auto it = m_tracks.find(tid);
+    if (it == m_tracks.end()) {
+        return m_emptyReading;
+    }
+    return it->second.reading;
+}
+
+void AudioMeterService::clear()
+{
+    m_pendingTimer.stop();
+    m_pendingPosition = -1;
+    for (auto &track : m_tracks) {
+        track.second.buffer->clear();
+        resetState(track.second);
+    }
+}
+
+void AudioMeterService::resetState(TrackState &state)
+{
+    int channels = state.buffer->channels();
+    state.reading.levels.fill(-100., channels);
+    state.reading.peakHold.fill(-100., channels);
+    state.reading.shortTermLoudness = -100.;
+    state.peakAge.fill(0, channels);
+    std::fill(state.power.begin(), state.power.end(), 0.);
+    state.powerSum = 0.;
+    state.powerIndex = 0;
+    state.lastPosition = -1;
+}
+
+void AudioMeterService::frameDisplayed(int pos)
+{
+    m_pendingPosition = pos;
+    int interval = 1000 / qBound(1, KdenliveSettings::mixerRefreshRate(), 120);
+    if (!m_refreshTimer.isValid() || m_refreshTimer.elapsed() >= interval) {
+        publish();
+    } else if (!m_pendingTimer.isActive()) {
+        // Make sure the last displayed frame is shown when playback stops
+        m_pendingTimer.start(int(interval - m_refreshTimer.elapsed()));
+    }
+}
+
+void AudioMeterService::publish()
+{
+    m_pendingTimer.stop();
+    if (m_pendingPosition < 0) {
+        return;
+    }
+    m_refreshTimer.start();
+    for (auto &track : m_tracks) {
+        collect(track.second, m_pendingPosition);
+    }
+    m_pendingPosition = -1;
+    Q_EMIT levelsUpdated();
+}
+
+void AudioMeterService::collect(TrackState &state, int pos)
+{
+    const std::shared_ptr<TrackLevelBuffer> &buffer = state.buffer;
+    int first = state.lastPosition + 1;
+    if (state.lastPosition < 0 || pos < first || pos - first >= buffer->capacity()) {
+        // Seek or first refresh, statistics of the previous frames are meaningless
+        resetState(state);
+        first = pos;
+    }
+    state.lastPosition = pos;
+    const int channels = buffer->channels();
+    QVector<double> levels;
+    bool found = false;
+    // Accumulate every frame played since the last refresh, not only the displayed one
+    for (int frame = first; frame <= pos; frame++) {
+        if (!buffer->read(frame, levels)) {
+            continue;
+        }
+        found = true;
+        double power = 0.;
+        for (int i = 0; i < channels; i++) {
+            double level = levels.at(i);
+            if (level >= state.reading.peakHold.at(i) || --state.peakAge[i] <= 0) {
+                state.reading.peakHold[i] = level;
+                state.peakAge[i] = m_peakHoldFrames;
+            }
+            power += level > -100. ? pow(10., level / 10.) : 0.;
+        }
+        power /= channels;
+        state.powerSum += power - state.power[state.powerIndex];
+        state.power[state.powerIndex] = power;
+        state.powerIndex = (state.powerIndex + 1) % state.power.size();
+    }
+    if (found && buffer->read(pos, levels)) {
+        state.reading.levels = levels;
+    } else {
+        state.reading.levels.fill(-100., channels);
+    }
+    double meanPower = qMax(0., state.powerSum) / double(state.power.size());
+    state.reading.shortTermLoudness = meanPower > 1e-10 ? 10. * log10(meanPower) : -100.;
+}
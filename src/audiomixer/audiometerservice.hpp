@@ -0,0 +1,115 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/** @class TrackLevelBuffer
+    @brief Lock-free ring of the per-frame audio levels produced by one track's audiolevel filter.
+    There is a single writer (the MLT thread processing the track) and a single reader (the GUI thread).
+    Levels are stored by frame position, so a reader asking for a frame that was never produced or
+    already overwritten simply gets no value.
+ */
+class TrackLevelBuffer
+{
+public:
+    static constexpr int MaxChannels = 8;
+    /** @param capacity minimum number of frames kept, rounded up to a power of 2 */
+    TrackLevelBuffer(int channels, int capacity);
+    /** @brief Store the levels (in dB) of a frame. Called from the MLT thread */
+    void store(int position, const double *levels, int count);
+    /** @brief Read the levels stored for a frame. Returns false if they are not available */
+    bool read(int position, QVector<double> &levels) const;
+    /** @brief Discard all stored levels */
+    void clear();
+    int channels() const;
+    int capacity() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<int> position{-1};
+        std::array<std::atomic<float>, MaxChannels> levels{};
+    };
+    int m_channels;
+    int m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+};
+
+/** @brief Values displayed by a mixer's vu-meter for one refresh */
+struct AudioMeterReading
+{
+    /** @brief Level of each channel for the displayed frame, in dB */
+    QVector<double> levels;
+    /** @brief Highest level of each channel over the hold period, in dB */
+    QVector<double> peakHold;
+    /** @brief Mean power of all channels over the last 3 seconds, in dB */
+    double shortTermLoudness{-100.};
+};
+
+/** @class AudioMeterService
+    @brief Collects the levels of all mixer tracks in one place.
+    Each track's audiolevel filter writes into its own TrackLevelBuffer without locking. When the
+    project monitor displays a frame, the service reads all tracks for that frame in one pass,
+    accumulates the peak hold and short-term loudness from every frame played since the last pass,
+    and notifies the mixers at most at the configured refresh rate.
+ */
+class AudioMeterService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioMeterService(QObject *parent = nullptr);
+    /** @brief Create the level buffer for a track, to be filled by its audiolevel filter */
+    std::shared_ptr<TrackLevelBuffer> registerTrack(int tid, int channels, double fps);
+    void deregisterTrack(int tid);
+    /** @brief Returns the last published values for a track */
+    const AudioMeterReading &reading(int tid) const;
+    /** @brief Discard stored levels and statistics of all tracks */
+    void clear();
+
+public Q_SLOTS:
+    /** @brief A frame was displayed, publish its levels if the refresh rate allows it */
+    void frameDisplayed(int pos);
+
+private Q_SLOTS:
+    void publish();
+
+private:
+    struct TrackState
+    {
+        std::shared_ptr<TrackLevelBuffer> buffer;
+        AudioMeterReading reading;
+        /** @brief Frames remaining before the peak hold value of each channel is released */
+        QVector<int> peakAge;
+        /** @brief Mean power of the frames in the short-term window, as a ring */
+        std::vector<double> power;
+        double powerSum{0.};
+        size_t powerIndex{0};
+        int lastPosition{-1};
+    };
+    std::unordered_map<int, TrackState> m_tracks;
+    AudioMeterReading m_emptyReading;
+    QElapsedTimer m_refreshTimer;
+    QTimer m_pendingTimer;
+    int m_pendingPosition;
+    int m_peakHoldFrames;
+    void collect(TrackState &state, int pos);
+    void resetState(TrackState &state);
+
+Q_SIGNALS:
+    /** @brief New readings are available for all tracks */
+    void levelsUpdated();
+};
@@ -4,6 +4,7 @@
 */
 
 #include "mixermanager.hpp"
+#include "audiometerservice.hpp"
 #include "capture/mediacapture.h"
 #include "core.h"
 #include "effects/effectsrepository.hpp"
@@ -41,6 +42,7 @@ int MySlider::getHandleHeight()
 MixerManager::MixerManager(QWidget *parent)
     : QWidget(parent)
     , m_masterMixer(nullptr)
+    , m_meter(new AudioMeterService(this))
     , m_visibleMixerManager(false)
     , m_expandedWidth(-1)
     , m_recommendedWidth(300)
@@ -74,6 +76,9 @@ MixerManager::MixerManager(QWidget *parent)
     setLayout(m_box);
     MySlider slider;
     m_sliderHandle = slider.getHandleHeight();
+    connect(pCore.get(), &Core::updateMixerLevels, m_meter, &AudioMeterService::frameDisplayed);
+    connect(m_meter, &AudioMeterService::levelsUpdated, this, &MixerManager::updateMixerLevels);
+    connect(this, &MixerManager::clearMixers, m_meter, &AudioMeterService::clear);
 }
 
 void MixerManager::checkAudioLevelVersion()
@@ -124,7 +129,6 @@ void MixerManager::registerTrack(int tid, Mlt::Tractor *service, const QString &
     if (m_visibleMixerManager) {
         mixer->connectMixer(!KdenliveSettings::mixerCollapse());
     }
-    connect(pCore.get(), &Core::updateMixerLevels, mixer.get(), &MixerWidget::updateAudioLevel);
     connect(this, &MixerManager::clearMixers, mixer.get(), &MixerWidget::clear);
     connect(mixer.get(), &MixerWidget::toggleSolo, this, [&](int trid, bool solo) {
         if (!solo) {
@@ -166,6 +170,7 @@ void MixerManager::deregisterTrack(int tid)
 {
     Q_ASSERT(m_mixers.count(tid) > 0);
     m_mixers.erase(tid);
+    m_meter->deregisterTrack(tid);
 }
 
 void MixerManager::cleanup()
@@ -177,6 +182,9 @@ void MixerManager::cleanup()
         delete item;
     }
     m_channelsLayout->addStretch(10);
+    for (const auto &item : m_mixers) {
+        m_meter->deregisterTrack(item.first);
+    }
     m_mixers.clear();
     m_monitorTrack = -1;
     if (m_masterMixer) {
@@ -297,3 +305,15 @@ bool MixerManager::audioLevelV2() const
 {
     return m_filterIsV2;
 }
+
+AudioMeterService *MixerManager::meter() const
+{
+    return m_meter;
+}
+
+void MixerManager::updateMixerLevels()
+{
+    for (const auto &item : m_mixers) {
+        item.second->setMeterReading(m_meter->reading(item.first));
+    }
+}
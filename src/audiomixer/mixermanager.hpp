@@ -16,6 +16,7 @@ namespace Mlt {
 class Tractor;
 }
 
+class AudioMeterService;
 class MixerWidget;
 class QHBoxLayout;
 class TimelineItemModel;
@@ -53,6 +54,8 @@ public:
     int recordTrack() const;
     /** @brief Return true if we have MLT's audiolevel filter version 2 or above (fixes reading track audio level) */
     bool audioLevelV2() const;
+    /** @brief The service collecting the audio levels of all tracks */
+    AudioMeterService *meter() const;
 
 public Q_SLOTS:
     void recordStateChanged(int tid, bool recording);
@@ -61,6 +64,8 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void resetSizePolicy();
+    /** @brief Pass the levels collected by the meter service to all track mixers */
+    void updateMixerLevels();
 
 Q_SIGNALS:
     void updateLevels(int);
@@ -76,6 +81,7 @@ protected:
 
 private:
     std::shared_ptr<Mlt::Tractor> m_masterService;
+    AudioMeterService *m_meter;
     std::shared_ptr<TimelineItemModel> m_model;
     QHBoxLayout *m_box;
     QHBoxLayout *m_masterBox;
@@ -6,6 +6,7 @@
 #include "mixerwidget.hpp"
 
 #include "audiolevelwidget.hpp"
+#include "audiometerservice.hpp"
 #include "capture/mediacapture.h"
 #include "core.h"
 #include "iecscale.h"
@@ -33,38 +34,34 @@
 
 void MixerWidget::property_changed(mlt_service, MixerWidget *widget, mlt_event_data data)
 {
-    if (widget && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
+    if (widget && widget->m_levelBuffer && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES(widget->m_monitorFilter->get_filter());
         int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                // NOTE: this is an approximation. To get the real peak level, we need version 2 of audiolevel MLT filter, see property_changedV2
-                levels << log10(mlt_properties_get_double(filter_props, QString("_audio_level.%1").arg(i).toUtf8().constData()) / 1.18) * 20;
-            }
-            widget->m_levels[pos] = std::move(levels);
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
+        double levels[TrackLevelBuffer::MaxChannels];
+        int channels = qMin(widget->m_channels, int(TrackLevelBuffer::MaxChannels));
+        char propertyName[32];
+        for (int i = 0; i < channels; i++) {
+            snprintf(propertyName, sizeof(propertyName), "_audio_level.%d", i);
+            // NOTE: this is an approximation. To get the real peak level, we need version 2 of audiolevel MLT filter, see property_changedV2
+            levels[i] = log10(mlt_properties_get_double(filter_props, propertyName) / 1.18) * 20;
         }
+        widget->m_levelBuffer->store(pos, levels, channels);
     }
 }
 
 void MixerWidget::property_changedV2(mlt_service, MixerWidget *widget, mlt_event_data data)
 {
-    if (widget && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
+    if (widget && widget->m_levelBuffer && !strcmp(Mlt::EventData(data).to_string(), "_position")) {
         mlt_properties filter_props = MLT_FILTER_PROPERTIES(widget->m_monitorFilter->get_filter());
         int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                levels << mlt_properties_get_double(filter_props, QString("_audio_level.%1").arg(i).toUtf8().constData());
-            }
-            widget->m_levels[pos] = std::move(levels);
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
+        double levels[TrackLevelBuffer::MaxChannels];
+        int channels = qMin(widget->m_channels, int(TrackLevelBuffer::MaxChannels));
+        char propertyName[32];
+        for (int i = 0; i < channels; i++) {
+            snprintf(propertyName, sizeof(propertyName), "_audio_level.%d", i);
+            levels[i] = mlt_properties_get_double(filter_props, propertyName);
         }
+        widget->m_levelBuffer->store(pos, levels, channels);
     }
 }
 
@@ -78,7 +75,6 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, QString trackTag, const
     , m_channels(pCore->audioChannels())
     , m_balanceSpin(nullptr)
     , m_balanceSlider(nullptr)
-    , m_maxLevels(qMax(30, int(service->get_fps() * 1.5)))
     , m_solo(nullptr)
     , m_collapse(nullptr)
     , m_monitor(nullptr)
@@ -88,6 +84,9 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, QString trackTag, const
     , m_trackTag(std::move(trackTag))
     , m_sliderHandleSize(sliderHandle)
 {
+    if (m_tid != -1 && m_manager) {
+        m_levelBuffer = m_manager->meter()->registerTrack(m_tid, m_channels, service->get_fps());
+    }
     buildUI(service, trackName);
 }
 
@@ -335,7 +334,9 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackName)
             m_volumeSpin->setValue(dbValue);
             m_levelFilter->set("level", dbValue);
             m_levelFilter->set("disable", value == 60 ? 1 : 0);
-            m_levels.clear();
+            if (m_levelBuffer) {
+                m_levelBuffer->clear();
+            }
             Q_EMIT m_manager->purgeCache();
             pCore->setDocumentModified();
         }
@@ -347,7 +348,9 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackName)
             if (m_balanceFilter != nullptr) {
                 m_balanceFilter->set("start", (value + 50) / 100.);
                 m_balanceFilter->set("disable", value == 0 ? 1 : 0);
-                m_levels.clear();
+                if (m_levelBuffer) {
+                    m_levelBuffer->clear();
+                }
                 Q_EMIT m_manager->purgeCache();
                 pCore->setDocumentModified();
             }
@@ -454,28 +457,27 @@ void MixerWidget::updateLabel()
     }
 }
 
-void MixerWidget::updateAudioLevel(int pos)
+void MixerWidget::setMeterReading(const AudioMeterReading &reading)
 {
-    QMutexLocker lk(&m_storeMutex);
-    if (m_levels.contains(pos)) {
-        m_audioMeterWidget->setAudioValues(m_levels.value(pos));
-        // m_levels.remove(pos);
-    } else {
+    if (reading.levels.isEmpty()) {
         m_audioMeterWidget->setAudioValues(m_audioData);
+    } else {
+        m_audioMeterWidget->setAudioValues(reading.levels);
     }
+    m_audioMeterWidget->setLoudness(reading.peakHold, reading.shortTermLoudness);
 }
 
 void MixerWidget::reset()
 {
-    QMutexLocker lk(&m_storeMutex);
-    m_levels.clear();
+    clear();
     m_audioMeterWidget->setAudioValues(m_audioData);
 }
 
 void MixerWidget::clear()
 {
-    QMutexLocker lk(&m_storeMutex);
-    m_levels.clear();
+    if (m_levelBuffer) {
+        m_levelBuffer->clear();
+    }
 }
 
 bool MixerWidget::isMute() const
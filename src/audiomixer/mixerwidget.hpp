@@ -8,13 +8,14 @@
 #include "definitions.h"
 #include "mlt++/MltService.h"
 
-#include <QMutex>
 #include <QWidget>
 #include <memory>
 #include <unordered_map>
 
 class KDualAction;
 class AudioLevelWidget;
+class TrackLevelBuffer;
+struct AudioMeterReading;
 class QSlider;
 class QDial;
 class QSpinBox;
@@ -41,6 +42,8 @@ public:
     void reset();
     /** @brief discard stored audio values */
     void clear();
+    /** @brief Display the levels collected by the mixer's meter service */
+    void setMeterReading(const AudioMeterReading &reading);
     static void property_changed(mlt_service, MixerWidget *self, mlt_event_data data);
     static void property_changedV2(mlt_service, MixerWidget *widget, mlt_event_data data);
     void setTrackName(const QString &name);
@@ -64,7 +67,6 @@ protected:
     void mousePressEvent(QMouseEvent *event) override;
 
 public Q_SLOTS:
-    void updateAudioLevel(int pos);
     void setRecordState(bool recording);
 
 private Q_SLOTS:
@@ -76,13 +78,13 @@ protected:
     std::shared_ptr<Mlt::Filter> m_levelFilter;
     std::shared_ptr<Mlt::Filter> m_monitorFilter;
     std::shared_ptr<Mlt::Filter> m_balanceFilter;
-    QMap<int, QVector<double>> m_levels;
+    /** @brief Lock-free store filled by the audiolevel filter, read by the mixer's meter service */
+    std::shared_ptr<TrackLevelBuffer> m_levelBuffer;
     int m_channels;
     KDualAction *m_muteAction;
     QSpinBox *m_balanceSpin;
     QSlider *m_balanceSlider;
     QDoubleSpinBox *m_volumeSpin;
-    int m_maxLevels;
 
 private:
     std::shared_ptr<AudioLevelWidget> m_audioMeterWidget;
@@ -91,7 +93,6 @@ private:
     QToolButton *m_collapse;
     QToolButton *m_monitor;
     KSqueezedTextLabel *m_trackLabel;
-    QMutex m_storeMutex;
     double m_lastVolume;
     QVector<double> m_audioData;
     Mlt::Event *m_listener;
@@ -21,6 +21,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "doc/kthumb.h"
 #include "effects/effectstack/model/abstracteffectitem.hpp"
 #include "effects/effectstack/model/effectstackmodel.hpp"
+#include "effects/effectsrepository.hpp"
 #include "filefilter.h"
 #include "glaxnimatelauncher.h"
 #include "jobs/abstracttask.h"
@@ -50,6 +51,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "projectsortproxymodel.h"
 #include "projectsubclip.h"
 #include "tagwidget.hpp"
+#include "timeline2/model/timelineitemmodel.hpp"
+#include "timeline2/view/previewmanager.h"
 #include "titler/titlewidget.h"
 #include "ui_newtimeline_ui.h"
 #include "ui_qtextclip_ui.h"
@@ -1508,6 +1511,15 @@ Bin::Bin(std::shared_ptr<ProjectItemModel> model, QWidget *parent, bool isMainBi
     m_infoMessage->hide();
     connect(this, &Bin::requesteInvalidRemoval, this, &Bin::slotQueryRemoval);
     connect(pCore.get(), &Core::updatePalette, this, &Bin::slotUpdatePalette);
+    if (m_isMainBin) {
+        // Proxies of the used parts of a clip must grow when the clip is trimmed outwards
+        connect(pCore.get(), &Core::clipInstanceResized, this, [this](const QString &binId) {
+            std::shared_ptr<ProjectClip> clip = m_itemModel->getClipByBinID(binId);
+            if (clip) {
+                clip->checkProxyRanges();
+            }
+        });
+    }
     connect(m_itemModel.get(), &QAbstractItemModel::rowsInserted, this, &Bin::updateClipsCount);
     connect(m_itemModel.get(), &QAbstractItemModel::rowsRemoved, this, &Bin::updateClipsCount);
     connect(this, SIGNAL(displayBinMessage(QString, KMessageWidget::MessageType)), this, SLOT(doDisplayMessage(QString, KMessageWidget::MessageType)));
@@ -4041,8 +4053,9 @@ bool Bin::doPasteEffect(std::vector<QString> ids, const QStringList &effectData)
             res = res && m_itemModel->getClipByBinID(id)->copyEffectWithUndo(sourceStack, effectData.at(3).toInt(), undo, redo);
         }
     } else {
+        const QDomElement effectXml = EffectsRepository::get()->getXml(effectData.constFirst());
         for (auto &id : ids) {
-            res = res && m_itemModel->getClipByBinID(id)->getEffectStack()->appendEffectWithUndo(effectData.constFirst(), undo, redo);
+            res = res && m_itemModel->getClipByBinID(id)->getEffectStack()->appendEffectWithUndo(effectData.constFirst(), undo, redo, effectXml);
         }
     }
     if (res) {
@@ -6028,6 +6041,21 @@ void Bin::updateSequenceClip(const QUuid &uuid, int duration, int pos, bool forc
         std::shared_ptr<ProjectClip> clip = m_itemModel->getClipByBinID(binId);
         Q_ASSERT(clip != nullptr);
         if (m_doc->sequenceThumbRequiresRefresh(uuid) || forceUpdate) {
+            std::shared_ptr<TimelineItemModel> sequence = m_doc->getTimeline(uuid, true);
+            if (sequence) {
+                // Use the rendered sequence in its instances if the timeline preview covers it. The preview is rendered on an opaque
+                // background while nested sequences are transparent, so it is only used if the sequence content is opaque
+                std::shared_ptr<PreviewManager> preview = sequence->previewManager();
+                const QStringList rendered = preview && sequence->isOpaque() ? preview->renderedTimeline() : QStringList();
+                bool renderChanged = clip->setSequenceRender(rendered, KdenliveSettings::timelinechunks());
+                const QString contentHash = sequence->sequenceHash();
+                if (!forceUpdate && !renderChanged && contentHash == m_doc->getSequenceProperty(uuid, QStringLiteral("contenthash"))) {
+                    // Only the selection or other data that is not rendered changed, the timeline instances are still valid
+                    m_doc->sequenceThumbUpdated(uuid);
+                    return;
+                }
+                m_doc->setSequenceProperty(uuid, QStringLiteral("contenthash"), contentHash);
+            }
             // Store general sequence properties
             QMap<QString, QString> properties;
             properties.insert(QStringLiteral("length"), QString::number(duration));
@@ -6120,6 +6148,16 @@ void Bin::moveTimeWarpToFolder(const QDir sequenceFolder, bool copy)
     }
 }
 
+void Bin::suspendSequenceRenders(bool suspend)
+{
+    QList<std::shared_ptr<ProjectClip>> allClips = m_itemModel->getRootFolder()->childClips();
+    for (auto &c : allClips) {
+        if (c->clipType() == ClipType::Timeline) {
+            c->suspendSequenceRender(suspend);
+        }
+    }
+}
+
 void Bin::sequenceActivated()
 {
     updateTargets();
@@ -359,6 +359,8 @@ public:
     void setSequenceThumbnail(const QUuid &uuid, int frame);
     /** @brief When saving or rendering, copy timewarp temporary playlists to the correct folder. */
     void moveTimeWarpToFolder(const QDir sequenceFolder, bool copy);
+    /** @brief When saving or rendering, use the nested sequences instead of their rendered previews. */
+    void suspendSequenceRenders(bool suspend);
     /** @brief Create new sequence clip
      * @param aTracks the audio tracks count, use default if -1
      * @param vTracks the video tracks count, use default if -1 */
@@ -0,0 +1,238 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "binsearchindex.h"
+#include "abstractprojectitem.h"
+#include "bin/model/markerlistmodel.hpp"
+#include "projectclip.h"
+
+#include <algorithm>
+
+bool BinSearchIndex::Query::isEmpty() const
+{
+    return text.isEmpty() && tags.isEmpty() && ratings.isEmpty() && types.isEmpty() && usage == UsageFilter::All;
+}
+
+QString BinSearchIndex::foldCase(const QString &text)
+{
+    return text.toCaseFolded();
+}
+
+QSet<quint64> BinSearchIndex::trigrams(const QString &text)
+{
+    QSet<quint64> result;
+    for (int i = 0; i + 2 < text.size(); ++i) {
+        result.insert((quint64(text.at(i).unicode()) << 32) | (quint64(text.at(i + 1).unicode()) << 16) | quint64(text.at(i + 2).unicode()));
+    }
+    return result;
+}
+
+void BinSearchIndex::update(const AbstractProjectItem *item)
+{
+    Entry entry;
+    if (auto parent = item->parent()) {
+        entry.parentId = parent->getId();
+    }
+    QStringList text = {item->getData(AbstractProjectItem::DataName).toString(), item->getData(AbstractProjectItem::DataDate).toString(),
+                        item->getData(AbstractProjectItem::DataDescription).toString()};
+    if (item->itemType() == AbstractProjectItem::ClipItem) {
+        const QList<CommentedTime> markers = static_cast<const ProjectClip *>(item)->getMarkerModel()->getAllMarkers();
+        for (const auto &marker : markers) {
+            text << marker.comment();
+        }
+    }
+    entry.text = foldCase(text.join(QLatin1Char('\n')));
+    entry.tags = item->getData(AbstractProjectItem::DataTag).toString();
+    entry.rating = item->getData(AbstractProjectItem::DataRating).toInt();
+    entry.type = item->getData(AbstractProjectItem::ClipType).toInt();
+    // The usage text is either "count" or "count in current sequence|total count"
+    entry.usage = item->getData(AbstractProjectItem::UsageCount).toString().section(QLatin1Char('|'), 0, 0).toInt();
+
+    const int itemId = item->getId();
+    QWriteLocker locker(&m_lock);
+    auto existing = m_entries.find(itemId);
+    if (existing != m_entries.end()) {
+        unindex(itemId, existing.value());
+    }
+    index(itemId, entry);
+    m_entries.insert(itemId, entry);
+}
+
+void BinSearchIndex::remove(int itemId)
+{
+    QWriteLocker locker(&m_lock);
+    auto existing = m_entries.find(itemId);
+    if (existing != m_entries.end()) {
+        unindex(itemId, existing.value());
+        m_entries.erase(existing);
+    }
+}
+
+void BinSearchIndex::clear()
+{
+    QWriteLocker locker(&m_lock);
+    m_entries.clear();
+    m_trigrams.clear();
+    m_ratings.clear();
+    m_types.clear();
+}
+
+bool BinSearchIndex::contains(int itemId) const
+{
+    QReadLocker locker(&m_lock);
+    return m_entries.contains(itemId);
+}
+
+void BinSearchIndex::index(int itemId, const Entry &entry)
+{
+    const QSet<quint64> keys = trigrams(entry.text);
+    for (quint64 key : keys) {
+        m_trigrams[key].insert(itemId);
+    }
+    m_ratings[entry.rating].insert(itemId);
+    m_types[entry.type].insert(itemId);
+}
+
+void BinSearchIndex::unindex(int itemId, const Entry &entry)
+{
+    const QSet<quint64> keys = trigrams(entry.text);
+    for (quint64 key : keys) {
+        auto ids = m_trigrams.find(key);
+        if (ids != m_trigrams.end()) {
+            ids->remove(itemId);
+            if (ids->isEmpty()) {
+                m_trigrams.erase(ids);
+            }
+        }
+    }
+    m_ratings[entry.rating].remove(itemId);
+    m_types[entry.type].remove(itemId);
+}
+
+bool BinSearchIndex::entryMatches(const Entry &entry, const Query &query, const QString &foldedText)
+{
+    if ((query.usage == UsageFilter::Unused && entry.usage > 0) || (query.usage == UsageFilter::Used && entry.usage == 0)) {
+        return false;
+    }
+    bool filtered = false;
+    if (!query.ratings.isEmpty()) {
+        if (!query.ratings.contains(entry.rating)) {
+            return false;
+        }
+        filtered = true;
+    }
+    if (!query.types.isEmpty()) {
+        if (!query.types.contains(entry.type)) {
+            return false;
+        }
+        filtered = true;
+    }
+    if (!query.tags.isEmpty()) {
+        bool found = false;
+        for (const QString &tag : query.tags) {
+            // a single # means we are looking for clips without tags
+            if (tag == QLatin1Char('#') ? entry.tags.isEmpty() : entry.tags.contains(tag, Qt::CaseInsensitive)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        filtered = true;
+    }
+    // Items accepted by the tag, rating or type filters are displayed whatever the search text
+    return filtered || entry.text.contains(foldedText);
+}
+
+bool BinSearchIndex::candidates(const Query &query, const QString &foldedText, QSet<int> &ids) const
+{
+    if (!query.ratings.isEmpty() || !query.types.isEmpty()) {
+        // Both filters must match, start from the smallest one
+        QSet<int> ratings;
+        for (int rating : query.ratings) {
+            ratings.unite(m_ratings.value(rating));
+        }
+        QSet<int> types;
+        for (int type : query.types) {
+            types.unite(m_types.value(type));
+        }
+        if (query.ratings.isEmpty() || (!query.types.isEmpty() && types.size() < ratings.size())) {
+            ids = types;
+        } else {
+            ids = ratings;
+        }
+        return true;
+    }
+    if (!query.tags.isEmpty() || foldedText.size() < 3) {
+        return false;
+    }
+    // Items containing the text contain all its trigrams
+    const QSet<quint64> keys = trigrams(foldedText);
+    QList<const QSet<int> *> postings;
+    for (quint64 key : keys) {
+        auto posting = m_trigrams.constFind(key);
+        if (posting == m_trigrams.constEnd()) {
+            ids.clear();
+            return true;
+        }
+        postings << &posting.value();
+    }
+    std::sort(postings.begin(), postings.end(), [](const QSet<int> *a, const QSet<int> *b) { return a->size() < b->size(); });
+    ids = *postings.constFirst();
+    for (int i = 1; i < postings.size() && !ids.isEmpty(); ++i) {
+        ids.intersect(*postings.at(i));
+    }
+    return true;
+}
+
+QSet<int> BinSearchIndex::matches(const Query &query) const
+{
+    const QString foldedText = foldCase(query.text);
+    QReadLocker locker(&m_lock);
+    QSet<int> result;
+    QSet<int> ids;
+    if (!candidates(query, foldedText, ids)) {
+        for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+            if (entryMatches(it.value(), query, foldedText)) {
+                result.insert(it.key());
+            }
+        }
+        return result;
+    }
+    for (int id : qAsConst(ids)) {
+        auto entry = m_entries.constFind(id);
+        if (entry != m_entries.constEnd() && entryMatches(entry.value(), query, foldedText)) {
+            result.insert(id);
+        }
+    }
+    return result;
+}
+
+bool BinSearchIndex::matches(int itemId, const Query &query) const
+{
+    QReadLocker locker(&m_lock);
+    auto entry = m_entries.constFind(itemId);
+    return entry != m_entries.constEnd() && entryMatches(entry.value(), query, foldCase(query.text));
+}
+
+QSet<int> BinSearchIndex::withAncestors(const QSet<int> &ids) const
+{
+    QReadLocker locker(&m_lock);
+    QSet<int> result = ids;
+    for (int id : ids) {
+        auto entry = m_entries.constFind(id);
+        while (entry != m_entries.constEnd()) {
+            const int parentId = entry->parentId;
+            if (result.contains(parentId)) {
+                // The rest of the branch was already added
+                break;
+            }
+            result.insert(parentId);
+            entry = m_entries.constFind(parentId);
+        }
+    }
+    return result;
+}
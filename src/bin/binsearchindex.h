@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+class AbstractProjectItem;
+
+/** @class BinSearchIndex
+    @brief Inverted index of the searchable data of the project bin items.
+    Names, dates, descriptions and marker comments are indexed by trigrams, ratings and clip types by value, so
+    that the bin filters only have to check the few candidates returned by the index instead of every item.
+    The index is kept up to date by the ProjectItemModel each time an item is added, modified or removed.
+ */
+class BinSearchIndex
+{
+public:
+    enum UsageFilter { All, Used, Unused };
+
+    /** @brief The bin filters, with the same semantics as the filter widgets of the bin */
+    struct Query
+    {
+        QString text;
+        /** @brief Accept items containing one of these tags, a single '#' matches items without tags */
+        QStringList tags;
+        QList<int> ratings;
+        QList<int> types;
+        UsageFilter usage{UsageFilter::All};
+        bool isEmpty() const;
+    };
+
+    /** @brief Add or refresh the entry of @param item */
+    void update(const AbstractProjectItem *item);
+    void remove(int itemId);
+    void clear();
+    bool contains(int itemId) const;
+    /** @brief The ids of all items matching @param query on their own merits */
+    QSet<int> matches(const Query &query) const;
+    /** @brief Returns true if the item @param itemId matches @param query on its own merits */
+    bool matches(int itemId, const Query &query) const;
+    /** @brief Returns @param ids with all their parent folders added, these are the rows a filtered view displays */
+    QSet<int> withAncestors(const QSet<int> &ids) const;
+
+private:
+    struct Entry
+    {
+        int parentId{-1};
+        /** @brief Case folded name, date, description and marker comments, separated by new lines */
+        QString text;
+        QString tags;
+        int rating{0};
+        int type{0};
+        int usage{0};
+    };
+    mutable QReadWriteLock m_lock;
+    QHash<int, Entry> m_entries;
+    QHash<quint64, QSet<int>> m_trigrams;
+    QHash<int, QSet<int>> m_ratings;
+    QHash<int, QSet<int>> m_types;
+
+    static QString foldCase(const QString &text);
+    static QSet<quint64> trigrams(const QString &text);
+    static bool entryMatches(const Entry &entry, const Query &query, const QString &foldedText);
+    void unindex(int itemId, const Entry &entry);
+    void index(int itemId, const Entry &entry);
+    /** @brief Fill @param ids with a small set of items that may match @param query, returns false if all items have to be checked */
+    bool candidates(const Query &query, const QString &foldedText, QSet<int> &ids) const;
+};
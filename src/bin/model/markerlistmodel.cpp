@@ -346,7 +346,7 @@ int MarkerListModel::getRowfromId(int mid) const
 {
     READ_LOCK();
     Q_ASSERT(m_markerList.count(mid) > 0);
-    return (int)std::distance(m_markerList.begin(), m_markerList.find(mid));
+    return m_markerList.rank(mid);
 }
 
 int MarkerListModel::getIdFromPos(const GenTime &pos) const
@@ -536,11 +536,13 @@ void MarkerListModel::removeSnapPoint(GenTime pos)
 QVariant MarkerListModel::data(const QModelIndex &index, int role) const
 {
     READ_LOCK();
-    if (index.row() < 0 || index.row() >= static_cast<int>(m_markerList.size()) || !index.isValid()) {
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    auto it = m_markerList.nth(index.row());
+    if (it == m_markerList.end()) {
         return QVariant();
     }
-    auto it = m_markerList.begin();
-    std::advance(it, index.row());
     switch (role) {
     case Qt::DisplayRole:
     case Qt::EditRole:
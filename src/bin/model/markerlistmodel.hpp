@@ -8,6 +8,7 @@
 #include "definitions.h"
 #include "undohelper.hpp"
 #include "utils/gentime.h"
+#include "utils/rankedmap.hpp"
 
 #include <QAbstractListModel>
 #include <QReadWriteLock>
@@ -212,7 +213,8 @@ private:
     /** @brief This is a lock that ensures safety in case of concurrent access */
     mutable QReadWriteLock m_lock;
 
-    std::map<int, CommentedTime> m_markerList;
+    /** @brief The markers by id, the id order is the row order */
+    RankedMap<int, CommentedTime> m_markerList;
     /** @brief A list of {marker frame,marker id}, useful to quickly find a marker */
     QMap<int, int> m_markerPositions;
 
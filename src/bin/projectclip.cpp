@@ -31,6 +31,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "projectitemmodel.h"
 #include "projectsubclip.h"
 #include "timeline2/model/snapmodel.hpp"
+#include "utils/cachebudget.h"
 #include "utils/thumbnailcache.hpp"
 #include "utils/timecode.h"
 #include "xml/xml.hpp"
@@ -126,11 +127,19 @@ ProjectClip::ProjectClip(const QString &id, const QIcon &thumb, const std::share
     hash();
     m_boundaryTimer.setSingleShot(true);
     m_boundaryTimer.setInterval(500);
+    m_proxyRangeTimer.setSingleShot(true);
+    m_proxyRangeTimer.setInterval(1000);
+    connect(&m_proxyRangeTimer, &QTimer::timeout, this, &ProjectClip::updateProxyRanges);
     if (hasLimitedDuration()) {
         connect(&m_boundaryTimer, &QTimer::timeout, this, &ProjectClip::refreshBounds);
     }
-    connect(m_markerModel.get(), &MarkerListModel::modelChanged, this,
-            [&]() { setProducerProperty(QStringLiteral("kdenlive:markers"), m_markerModel->toJson()); });
+    connect(m_markerModel.get(), &MarkerListModel::modelChanged, this, [&]() {
+        setProducerProperty(QStringLiteral("kdenlive:markers"), m_markerModel->toJson());
+        if (auto ptr = m_model.lock()) {
+            // Marker comments are searchable in the bin
+            std::static_pointer_cast<ProjectItemModel>(ptr)->updateSearchIndex(this);
+        }
+    });
     QString markers = getProducerProperty(QStringLiteral("kdenlive:markers"));
     if (!markers.isEmpty()) {
         QMetaObject::invokeMethod(m_markerModel.get(), "importFromJson", Qt::QueuedConnection, Q_ARG(QString, markers), Q_ARG(bool, true), Q_ARG(bool, false));
@@ -213,8 +222,16 @@ ProjectClip::ProjectClip(const QString &id, const QDomElement &description, cons
     m_date = QFileInfo(m_temporaryUrl).lastModified();
     m_boundaryTimer.setSingleShot(true);
     m_boundaryTimer.setInterval(500);
-    connect(m_markerModel.get(), &MarkerListModel::modelChanged, this,
-            [&]() { setProducerProperty(QStringLiteral("kdenlive:markers"), m_markerModel->toJson()); });
+    m_proxyRangeTimer.setSingleShot(true);
+    m_proxyRangeTimer.setInterval(1000);
+    connect(&m_proxyRangeTimer, &QTimer::timeout, this, &ProjectClip::updateProxyRanges);
+    connect(m_markerModel.get(), &MarkerListModel::modelChanged, this, [&]() {
+        setProducerProperty(QStringLiteral("kdenlive:markers"), m_markerModel->toJson());
+        if (auto ptr = m_model.lock()) {
+            // Marker comments are searchable in the bin
+            std::static_pointer_cast<ProjectItemModel>(ptr)->updateSearchIndex(this);
+        }
+    });
 }
 
 std::shared_ptr<ProjectClip> ProjectClip::construct(const QString &id, const QDomElement &description, const QIcon &thumb,
@@ -673,6 +690,8 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool gene
     if (auto ptr = m_model.lock()) {
         updateRoles << AbstractProjectItem::DataDuration;
         std::static_pointer_cast<ProjectItemModel>(ptr)->onItemUpdated(std::static_pointer_cast<ProjectClip>(shared_from_this()), updateRoles);
+        // Type, tags and rating are only known once the producer is loaded
+        std::static_pointer_cast<ProjectItemModel>(ptr)->updateSearchIndex(this);
         std::static_pointer_cast<ProjectItemModel>(ptr)->updateWatcher(std::static_pointer_cast<ProjectClip>(shared_from_this()));
         if (currentStatus == FileStatus::StatusMissing) {
             std::static_pointer_cast<ProjectItemModel>(ptr)->missingClipTimer.start();
@@ -1061,9 +1080,23 @@ std::shared_ptr<Mlt::Producer> ProjectClip::getTimelineProducer(int trackId, int
                 trackId = -trackId;
             }
             if (m_audioProducers.count(trackId) == 0) {
+                const QString proxy = getProducerProperty(QStringLiteral("kdenlive:proxy"));
                 if (m_clipType == ClipType::Timeline) {
                     std::shared_ptr<Mlt::Producer> prod(m_masterProducer->cut(0, -1));
                     m_audioProducers[trackId] = prod;
+                } else if (audioStream > -1 && m_usesProxy && ProxyTask::isRangeProxy(proxy)) {
+                    // The xml producer of a range proxy ignores the stream properties, select the stream in its segments
+                    int astream = audioStreamIndex(audioStream);
+                    const int audioIndex = astream > -1 ? audioStream : -1;
+                    if (astream < 0 || astream > audioStreamsCount() - 1) {
+                        astream = 0;
+                    }
+                    const QByteArray xml = ProxyTask::rangeProxyXml(proxy, audioIndex, astream).toUtf8();
+                    m_audioProducers[trackId] = std::make_shared<Mlt::Producer>(pCore->getProjectProfile(), "xml-string", xml.constData());
+                    Mlt::Properties original(m_masterProducer->get_properties());
+                    Mlt::Properties cloneProps(m_audioProducers[trackId]->get_properties());
+                    cloneProps.pass_list(original, ClipController::getPassPropertiesList(false));
+                    m_audioProducers[trackId]->set("kdenlive:id", m_binId.toUtf8().constData());
                 } else {
                     m_audioProducers[trackId] = cloneProducer(true, true);
                 }
@@ -1117,7 +1150,9 @@ std::shared_ptr<Mlt::Producer> ProjectClip::getTimelineProducer(int trackId, int
             }
             if (m_videoProducers.count(trackId) == 0) {
                 if (m_clipType == ClipType::Timeline) {
-                    std::shared_ptr<Mlt::Producer> prod(m_masterProducer->cut(0, -1));
+                    // All instances share the rendered sequence if available, instead of compositing its tracks
+                    std::shared_ptr<Mlt::Producer> render = sequenceRenderProducer();
+                    std::shared_ptr<Mlt::Producer> prod(render ? render->cut(0, -1) : m_masterProducer->cut(0, -1));
                     m_videoProducers[trackId] = prod;
                 } else {
                     m_videoProducers[trackId] = cloneProducer(true, true);
@@ -2343,6 +2378,7 @@ void ProjectClip::registerTimelineClip(std::weak_ptr<TimelineModel> timeline, in
     }
     setRefCount(currentCount, totalCount);
     Q_EMIT registeredClipChanged();
+    checkProxyRanges();
 }
 
 void ProjectClip::checkClipBounds()
@@ -2350,6 +2386,45 @@ void ProjectClip::checkClipBounds()
     m_boundaryTimer.start();
 }
 
+QVector<QPoint> ProjectClip::timelineRanges() const
+{
+    QVector<QPoint> ranges;
+    QMapIterator<QUuid, QList<int>> i(m_registeredClipsByUuid);
+    while (i.hasNext()) {
+        i.next();
+        auto timeline = pCore->currentDoc()->getTimeline(i.key(), true);
+        if (timeline == nullptr) {
+            continue;
+        }
+        for (int clipId : i.value()) {
+            if (timeline->isClip(clipId)) {
+                ranges << timeline->getClipSourceRange(clipId);
+            }
+        }
+    }
+    return ranges;
+}
+
+void ProjectClip::checkProxyRanges()
+{
+    if (ProxyTask::isRangeProxy(getProducerProperty(QStringLiteral("kdenlive:proxy")))) {
+        m_proxyRangeTimer.start();
+    }
+}
+
+void ProjectClip::updateProxyRanges()
+{
+    if (!statusReady() || !ProxyTask::isRangeProxy(getProducerProperty(QStringLiteral("kdenlive:proxy")))) {
+        return;
+    }
+    // Handles are only added when encoding, so that trimming a clip inside its handles does not rebuild the proxy
+    const QVector<QPoint> used = ProxyTask::mergeRanges(timelineRanges(), 0, int(frameDuration()));
+    const QVector<QPoint> covered = ProxyTask::rangesFromString(getProducerProperty(QStringLiteral("kdenlive:proxyranges")));
+    if (!used.isEmpty() && !ProxyTask::coversRanges(covered, used)) {
+        ProxyTask::start(ObjectId(KdenliveObjectType::BinClip, m_binId.toInt(), QUuid()), this);
+    }
+}
+
 void ProjectClip::refreshBounds()
 {
     QVector<QPoint> boundaries;
@@ -2614,6 +2689,7 @@ void ProjectClip::reloadTimeline(std::shared_ptr<EffectStackModel> stack)
     // Release audio producers
     m_audioProducers.clear();
     m_videoProducers.clear();
+    m_sequenceRender.reset();
     if (m_timewarpProducers.size() > 0) {
         if (m_clipType == ClipType::Timeline) {
             bool ok;
@@ -2633,6 +2709,87 @@ void ProjectClip::reloadTimeline(std::shared_ptr<EffectStackModel> stack)
     }
 }
 
+bool ProjectClip::setSequenceRender(const QStringList &chunks, int chunkSize)
+{
+    if (m_clipType != ClipType::Timeline || !m_masterProducer) {
+        return false;
+    }
+    if (chunks == m_sequenceRenderChunks && chunkSize == m_sequenceRenderChunkSize) {
+        return false;
+    }
+    m_sequenceRenderChunks = chunks;
+    m_sequenceRenderChunkSize = chunkSize;
+    m_sequenceRender.reset();
+    return true;
+}
+
+void ProjectClip::suspendSequenceRender(bool suspend)
+{
+    if (suspend == m_sequenceRenderSuspended) {
+        return;
+    }
+    if (suspend && !m_sequenceRender) {
+        // No timeline instance uses the rendered preview
+        return;
+    }
+    m_sequenceRenderSuspended = suspend;
+    reloadSequenceInstances();
+}
+
+void ProjectClip::reloadSequenceInstances()
+{
+    for (auto &p : m_videoProducers) {
+        m_effectStack->removeService(p.second);
+    }
+    m_videoProducers.clear();
+    m_sequenceRender.reset();
+    // The sequence content did not change, swap the producers in place instead of reloading the clips
+    QMapIterator<QUuid, QList<int>> i(m_registeredClipsByUuid);
+    while (i.hasNext()) {
+        i.next();
+        auto timeline = pCore->currentDoc()->getTimeline(i.key());
+        if (!timeline) {
+            continue;
+        }
+        for (int cid : i.value()) {
+            if (timeline->getClipState(cid) == PlaylistState::VideoOnly) {
+                timeline->swapClipProducer(cid);
+            }
+        }
+    }
+}
+
+std::shared_ptr<Mlt::Producer> ProjectClip::sequenceRenderProducer()
+{
+    if (m_sequenceRender || m_sequenceRenderSuspended) {
+        return m_sequenceRender;
+    }
+    const QStringList &chunks = m_sequenceRenderChunks;
+    const int chunkSize = m_sequenceRenderChunkSize;
+    const int duration = m_masterProducer->time_to_frames(m_masterProducer->get("kdenlive:duration"));
+    if (chunks.isEmpty() || chunkSize <= 0 || chunks.count() != (duration + chunkSize - 1) / chunkSize) {
+        return nullptr;
+    }
+    std::shared_ptr<Mlt::Playlist> playlist = std::make_shared<Mlt::Playlist>(pCore->getProjectProfile());
+    int position = 0;
+    for (const QString &chunk : chunks) {
+        if (!QFile::exists(chunk)) {
+            // Removed from the cache
+            return nullptr;
+        }
+        Mlt::Producer prod(pCore->getProjectProfile(), QString("avformat:%1").arg(chunk).toUtf8().constData());
+        if (!prod.is_valid()) {
+            return nullptr;
+        }
+        CacheBudget::touch(chunk);
+        const int length = qMin(chunkSize, duration - position);
+        playlist->append(prod, 0, length - 1);
+        position += length;
+    }
+    m_sequenceRender = playlist;
+    return m_sequenceRender;
+}
+
 Fun ProjectClip::getAudio_lambda()
 {
     return [this]() {
@@ -271,6 +271,12 @@ public:
     int getAudioMax(int stream);
     /** @brief A timeline clip was modified, reload its other timeline instances. */
     void reloadTimeline(std::shared_ptr<EffectStackModel> stack = nullptr);
+    /** @brief Use the rendered preview @param chunks of @param chunkSize frames for the video of this sequence timeline instances.
+        An empty list composites the sequence tracks again. Returns true if the used chunks changed */
+    bool setSequenceRender(const QStringList &chunks, int chunkSize);
+    /** @brief The rendered preview is only meant for monitor playback: when saving or rendering, @param suspend
+        reloads the timeline instances with the sequence itself, false switches them back to the rendered preview. */
+    void suspendSequenceRender(bool suspend);
     /** @brief Copy sequence clip timewarp producers to a new location (when saving / rendering). */
     void copyTimeWarpProducers(const QDir sequenceFolder, bool copy);
     /** @brief Refresh zones of insertion in timeline. */
@@ -303,6 +309,8 @@ public:
     QPixmap pixmap(int position = 0, int width = 0, int height = 0);
     /** @brief Returns true if this clip has a variable framerate */
     bool hasVariableFps();
+    /** @brief Returns the frames of this clip played by its instances in all timelines, one range per instance */
+    QVector<QPoint> timelineRanges() const;
 
 protected:
     friend class ClipModel;
@@ -363,6 +371,8 @@ public Q_SLOTS:
     void checkClipBounds();
     /** @brief Check if proxy clip should be build for this clip. */
     void checkProxy(bool rebuildProxy = false);
+    /** @brief If the proxy only contains the used parts of the clip, check soon if it still contains all the frames used in the timelines. */
+    void checkProxyRanges();
 
 private:
     /** @brief Generate and store file hash if not available. */
@@ -379,6 +389,9 @@ private:
     void createDisabledMasterProducer();
     QMap<QUuid, QList<int>> m_registeredClipsByUuid;
     QTimer m_boundaryTimer;
+    QTimer m_proxyRangeTimer;
+    /** @brief Extend the proxy if some frames used in the timelines are not in its ranges */
+    void updateProxyRanges();
 
     /** @brief the following holds a producer for each audio clip in the timeline
      * keys are the id of the clips in the timeline, values are their values */
@@ -386,6 +399,17 @@ private:
     std::unordered_map<int, std::shared_ptr<Mlt::Producer>> m_videoProducers;
     std::unordered_map<int, std::shared_ptr<Mlt::Producer>> m_timewarpProducers;
     std::shared_ptr<Mlt::Producer> m_disabledProducer;
+    /** @brief The video of a sequence built from its rendered preview chunks, shared by all its timeline instances */
+    std::shared_ptr<Mlt::Producer> m_sequenceRender;
+    /** @brief The rendered preview chunks of this sequence, they are cache files and never saved in the project */
+    QStringList m_sequenceRenderChunks;
+    int m_sequenceRenderChunkSize = 0;
+    /** @brief True while the timeline instances use the sequence instead of its rendered preview, see suspendSequenceRender */
+    bool m_sequenceRenderSuspended = false;
+    /** @brief Replace the video producer of the timeline instances of this sequence */
+    void reloadSequenceInstances();
+    /** @brief Returns the rendered video of this sequence, or nullptr if it is not fully rendered */
+    std::shared_ptr<Mlt::Producer> sequenceRenderProducer();
     // A temporary uuid used to reset thumbnails on producer change
     QUuid m_uuid;
     // The sequence unique identifier
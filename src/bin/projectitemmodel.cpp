@@ -37,6 +37,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QProgressDialog>
 #include <QTemporaryFile>
 
+#include <algorithm>
 #include <mlt++/Mlt.h>
 #include <queue>
 #include <qvarlengtharray.h>
@@ -64,6 +65,7 @@ ProjectItemModel::ProjectItemModel(QObject *parent)
     missingClipTimer.setInterval(500);
     missingClipTimer.setSingleShot(true);
     connect(&missingClipTimer, &QTimer::timeout, this, &ProjectItemModel::slotUpdateInvalidCount);
+    connect(this, &QAbstractItemModel::dataChanged, this, &ProjectItemModel::slotUpdateSearchIndex);
 }
 
 std::shared_ptr<ProjectItemModel> ProjectItemModel::construct(QObject *parent)
@@ -759,6 +761,8 @@ void ProjectItemModel::registerItem(const std::shared_ptr<TreeItem> &item)
     Q_ASSERT(m_binPlaylist != nullptr);
     m_binPlaylist->manageBinItemInsertion(clip);
     m_allIds.append(clip->clipId().toInt());
+    m_searchIndex.update(clip.get());
+    Q_EMIT searchIndexChanged(clip->getId());
     if (clip->itemType() == AbstractProjectItem::ClipItem) {
         auto clipItem = std::static_pointer_cast<ProjectClip>(clip);
         m_allClipItems[clip->clipId().toInt()] = clipItem;
@@ -778,6 +782,10 @@ void ProjectItemModel::deregisterItem(int id, TreeItem *item)
     m_allIds.removeAll(clip->clipId().toInt());
     m_allClipItems.erase(clip->clipId().toInt());
     m_binPlaylist->manageBinItemDeletion(clip);
+    if (m_searchIndex.contains(id)) {
+        m_searchIndex.remove(id);
+        Q_EMIT searchIndexChanged(id);
+    }
     // TODO : here, we should suspend jobs belonging to the item we delete. They can be restarted if the item is reinserted by undo
     AbstractTreeModel::deregisterItem(id, item);
     if (clip->itemType() == AbstractProjectItem::ClipItem) {
@@ -792,6 +800,46 @@ void ProjectItemModel::deregisterItem(int id, TreeItem *item)
     }
 }
 
+const BinSearchIndex &ProjectItemModel::searchIndex() const
+{
+    return m_searchIndex;
+}
+
+void ProjectItemModel::updateSearchIndex(const AbstractProjectItem *item)
+{
+    if (!m_searchIndex.contains(item->getId())) {
+        // Item is not registered yet, or was removed
+        return;
+    }
+    m_searchIndex.update(item);
+    Q_EMIT searchIndexChanged(item->getId());
+}
+
+void ProjectItemModel::slotUpdateSearchIndex(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    static const QVector<int> searchRoles = {Qt::EditRole,
+                                             AbstractProjectItem::DataName,
+                                             AbstractProjectItem::DataDate,
+                                             AbstractProjectItem::DataDescription,
+                                             AbstractProjectItem::ClipType,
+                                             AbstractProjectItem::DataTag,
+                                             AbstractProjectItem::DataRating,
+                                             AbstractProjectItem::UsageCount};
+    if (!roles.isEmpty() && std::none_of(roles.cbegin(), roles.cend(), [](int role) { return searchRoles.contains(role); })) {
+        // Thumbnail, job progress, ... are not searchable
+        return;
+    }
+    if (!topLeft.isValid() || !bottomRight.isValid()) {
+        return;
+    }
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        std::shared_ptr<AbstractProjectItem> item = getBinItemByIndex(index(row, 0, topLeft.parent()));
+        if (item) {
+            updateSearchIndex(item.get());
+        }
+    }
+}
+
 bool ProjectItemModel::hasSequenceId(const QUuid &uuid) const
 {
     return m_binPlaylist->hasSequenceId(uuid);
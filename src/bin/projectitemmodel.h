@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstractmodel/abstracttreemodel.hpp"
 #include "bin/abstractprojectitem.h"
+#include "bin/binsearchindex.h"
 #include "definitions.h"
 #include "undohelper.hpp"
 #include <QDomElement>
@@ -260,6 +261,10 @@ public:
     /** @brief Check that all sequences are correctly stored in the model */
     void checkSequenceIntegrity(const QString activeSequenceId);
     std::shared_ptr<EffectStackModel> getClipEffectStack(int itemId);
+    /** @brief The index used to filter the bin items */
+    const BinSearchIndex &searchIndex() const;
+    /** @brief Refresh the searchable data of an item, for example when its markers changed */
+    void updateSearchIndex(const AbstractProjectItem *item);
 
 protected:
     bool closing;
@@ -292,6 +297,8 @@ public Q_SLOTS:
 private Q_SLOTS:
     /** @brief Check how many invalid clips we have. */
     void slotUpdateInvalidCount();
+    /** @brief Refresh the search index when the searchable data of items changed */
+    void slotUpdateSearchIndex(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
 
 private:
     /** @brief Return reference to column specific data */
@@ -308,6 +315,7 @@ private:
     std::shared_ptr<Mlt::Tractor> m_projectTractor;
     std::map<int, std::shared_ptr<ProjectClip>> m_allClipItems;
     QList<int> m_allIds;
+    BinSearchIndex m_searchIndex;
 
     int m_nextId;
     QIcon m_blankThumb;
@@ -335,4 +343,6 @@ Q_SIGNALS:
     void addTag(const QString &, const QModelIndex &);
     void addClipCut(const QString &, int, int);
     void resetPlayOrLoopZone(const QString &id);
+    /** @brief The searchable data of an item changed, or the item was added or removed */
+    void searchIndexChanged(int itemId);
 };
@@ -7,6 +7,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "projectsortproxymodel.h"
 #include "abstractprojectitem.h"
+#include "projectitemmodel.h"
 
 #include <QItemSelectionModel>
 
@@ -19,109 +20,68 @@ ProjectSortProxyModel::ProjectSortProxyModel(QObject *parent)
     m_selection = new QItemSelectionModel(this);
     connect(m_selection, &QItemSelectionModel::selectionChanged, this, &ProjectSortProxyModel::onCurrentRowChanged);
     setDynamicSortFilter(true);
+    m_invalidateTimer.setSingleShot(true);
+    m_invalidateTimer.setInterval(0);
+    connect(&m_invalidateTimer, &QTimer::timeout, this, &ProjectSortProxyModel::invalidateFilter);
 }
 
-// Responsible for item sorting!
-bool ProjectSortProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+void ProjectSortProxyModel::setSourceModel(QAbstractItemModel *model)
 {
-    if (filterAcceptsRowItself(sourceRow, sourceParent)) {
-        return true;
+    if (m_itemModel) {
+        disconnect(m_itemModel, &ProjectItemModel::searchIndexChanged, this, &ProjectSortProxyModel::onSearchIndexChanged);
     }
-    // accept if any of the children is accepted on it's own merits
-    return hasAcceptedChildren(sourceRow, sourceParent);
+    m_itemModel = qobject_cast<ProjectItemModel *>(model);
+    if (m_itemModel) {
+        connect(m_itemModel, &ProjectItemModel::searchIndexChanged, this, &ProjectSortProxyModel::onSearchIndexChanged);
+    }
+    QSortFilterProxyModel::setSourceModel(model);
+    updateMatches();
 }
 
-bool ProjectSortProxyModel::filterAcceptsRowItself(int sourceRow, const QModelIndex &sourceParent) const
+bool ProjectSortProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
-    if (m_usageFilter != UsageFilter::All) {
-        // Column 8 contains the usage
-        QModelIndex indexTag = sourceModel()->index(sourceRow, 8, sourceParent);
-        int usageCount = sourceModel()->data(indexTag).toInt();
-        if ((usageCount > 0 && m_usageFilter == UsageFilter::Unused) || (usageCount == 0 && m_usageFilter == UsageFilter::Used)) {
-            return false;
-        }
-    }
-    bool result = false;
-    if (!m_searchRating.isEmpty()) {
-        // Column 7 contains the rating
-        QModelIndex indexTag = sourceModel()->index(sourceRow, 7, sourceParent);
-        if (!m_searchRating.contains(sourceModel()->data(indexTag).toInt())) {
-            return false;
-        }
-        result = true;
-    }
-    if (!m_searchType.isEmpty()) {
-        // Column 3 contains the item type (video, image, title, etc)
-        QModelIndex indexTag = sourceModel()->index(sourceRow, 3, sourceParent);
-        if (!m_searchType.contains(sourceModel()->data(indexTag).toInt())) {
-            return false;
-        }
-        result = true;
-    }
-    if (!m_searchTag.isEmpty()) {
-        // Column 4 contains the item tag data
-        QModelIndex indexTag = sourceModel()->index(sourceRow, 4, sourceParent);
-        auto tagData = sourceModel()->data(indexTag);
-        bool found = false;
-        for (const QString &tag : m_searchTag) {
-            if (tag == QLatin1Char('#')) {
-                // a single # means we are looking for clips without tags
-                if (tagData.toString().isEmpty()) {
-                    // a single # means we are looking for clips without tags
-                    found = true;
-                    break;
-                }
-            } else if (tagData.toString().contains(tag, Qt::CaseInsensitive)) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            return false;
-        }
-        result = true;
-    }
-
-    if (result && m_searchString.isEmpty()) {
+    if (m_query.isEmpty() || m_itemModel == nullptr) {
         return true;
     }
-    for (int i = 0; i < 3; i++) {
-        QModelIndex index0 = sourceModel()->index(sourceRow, i, sourceParent);
-        if (!index0.isValid()) {
-            return false;
-        }
-        auto data = sourceModel()->data(index0);
-        if (data.toString().contains(m_searchString, Qt::CaseInsensitive)) {
-            result = true;
-            break;
-        }
-    }
-    return result;
+    // The internal id of the bin model indexes is the item id
+    const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
+    return index.isValid() && m_acceptedItems.contains(int(index.internalId()));
 }
 
-bool ProjectSortProxyModel::hasAcceptedChildren(int sourceRow, const QModelIndex &source_parent) const
+void ProjectSortProxyModel::updateMatches()
 {
-    QModelIndex item = sourceModel()->index(sourceRow, 0, source_parent);
-    if (!item.isValid()) {
-        return false;
+    m_invalidateTimer.stop();
+    if (m_query.isEmpty() || m_itemModel == nullptr) {
+        m_matches.clear();
+        m_acceptedItems.clear();
+    } else {
+        const BinSearchIndex &searchIndex = m_itemModel->searchIndex();
+        m_matches = searchIndex.matches(m_query);
+        m_acceptedItems = searchIndex.withAncestors(m_matches);
     }
+    invalidateFilter();
+}
 
-    // check if there are children
-    int childCount = item.model()->rowCount(item);
-    if (childCount == 0) {
-        return false;
+void ProjectSortProxyModel::onSearchIndexChanged(int itemId)
+{
+    if (m_query.isEmpty()) {
+        return;
     }
-
-    for (int i = 0; i < childCount; ++i) {
-        if (filterAcceptsRowItself(i, item)) {
-            return true;
-        }
-        // recursive call -> NOTICE that this is depth-first searching, you're probably better off with breadth first search...
-        if (hasAcceptedChildren(i, item)) {
-            return true;
+    // This can be called while the source model inserts or removes rows, so the view is only refiltered later.
+    // Rows inserted or changed in the source model are filtered with the updated sets by the base class.
+    const BinSearchIndex &searchIndex = m_itemModel->searchIndex();
+    if (searchIndex.matches(itemId, m_query)) {
+        m_matches.insert(itemId);
+        // The item may be new or moved to another folder
+        const QSet<int> branch = searchIndex.withAncestors({itemId});
+        if (!m_acceptedItems.contains(branch)) {
+            m_acceptedItems.unite(branch);
+            m_invalidateTimer.start();
         }
+    } else if (m_matches.remove(itemId)) {
+        m_acceptedItems = searchIndex.withAncestors(m_matches);
+        m_invalidateTimer.start();
     }
-    return false;
 }
 
 bool ProjectSortProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
@@ -171,26 +131,36 @@ QItemSelectionModel *ProjectSortProxyModel::selectionModel()
 
 void ProjectSortProxyModel::slotSetSearchString(const QString &str)
 {
-    m_searchString = str;
-    invalidateFilter();
+    m_query.text = str;
+    updateMatches();
 }
 
 void ProjectSortProxyModel::slotSetFilters(const QStringList &tagFilters, const QList<int> rateFilters, const QList<int> typeFilters, UsageFilter unusedFilter)
 {
-    m_searchType = typeFilters;
-    m_searchRating = rateFilters;
-    m_searchTag = tagFilters;
-    m_usageFilter = unusedFilter;
-    invalidateFilter();
+    m_query.types = typeFilters;
+    m_query.ratings = rateFilters;
+    m_query.tags = tagFilters;
+    switch (unusedFilter) {
+    case UsageFilter::Used:
+        m_query.usage = BinSearchIndex::UsageFilter::Used;
+        break;
+    case UsageFilter::Unused:
+        m_query.usage = BinSearchIndex::UsageFilter::Unused;
+        break;
+    default:
+        m_query.usage = BinSearchIndex::UsageFilter::All;
+        break;
+    }
+    updateMatches();
 }
 
 void ProjectSortProxyModel::slotClearSearchFilters()
 {
-    m_searchTag.clear();
-    m_searchRating.clear();
-    m_searchType.clear();
-    m_usageFilter = UsageFilter::All;
-    invalidateFilter();
+    m_query.tags.clear();
+    m_query.ratings.clear();
+    m_query.types.clear();
+    m_query.usage = BinSearchIndex::UsageFilter::All;
+    updateMatches();
 }
 
 void ProjectSortProxyModel::onCurrentRowChanged(const QItemSelection &current, const QItemSelection &previous)
@@ -7,9 +7,14 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #pragma once
 
+#include "binsearchindex.h"
+
 #include <QCollator>
+#include <QSet>
 #include <QSortFilterProxyModel>
+#include <QTimer>
 
+class ProjectItemModel;
 class QItemSelectionModel;
 
 /**
@@ -25,6 +30,8 @@ public:
 
     explicit ProjectSortProxyModel(QObject *parent = nullptr);
     QItemSelectionModel *selectionModel();
+    /** @brief Reimplemented to follow the search index of the bin model */
+    void setSourceModel(QAbstractItemModel *model) override;
 
 public Q_SLOTS:
     /** @brief Set search string that will filter the view */
@@ -41,6 +48,8 @@ public Q_SLOTS:
 private Q_SLOTS:
     /** @brief Called when a row change is detected by selection model */
     void onCurrentRowChanged(const QItemSelection &current, const QItemSelection &previous);
+    /** @brief Update the matching items when the searchable data of an item changed */
+    void onSearchIndexChanged(int itemId);
 
 protected:
     /** @brief Decide which items should be displayed depending on the search string  */
@@ -48,17 +57,20 @@ protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
     /** @brief Reimplemented to show folders first  */
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
-    bool filterAcceptsRowItself(int source_row, const QModelIndex &source_parent) const;
-    bool hasAcceptedChildren(int source_row, const QModelIndex &source_parent) const;
 
 private:
     QItemSelectionModel *m_selection;
-    QString m_searchString;
-    QStringList m_searchTag;
-    QList<int> m_searchType;
-    QList<int> m_searchRating;
-    UsageFilter m_usageFilter{UsageFilter::All};
+    ProjectItemModel *m_itemModel{nullptr};
+    BinSearchIndex::Query m_query;
+    /** @brief Ids of the items matching the filters on their own merits */
+    QSet<int> m_matches;
+    /** @brief Ids of the displayed items: the matching items and their parent folders */
+    QSet<int> m_acceptedItems;
+    /** @brief Refilters the view after incremental updates of the accepted items */
+    QTimer m_invalidateTimer;
     QCollator m_collator;
+    /** @brief Query the search index for the current filters and refilter the view */
+    void updateMatches();
 
 Q_SIGNALS:
     /** @brief Emitted when the row changes, used to prepare action for selected item  */
@@ -212,7 +212,6 @@ void Core::initGUI(const QString &MltPath, const QUrl &Url, const QString &clips
         KdenliveSettings::setDefault_profile(m_profile);
     }
     setCurrentProfile(m_profile);
-    profileChanged();
     resetThumbProfile();
 
     if (!ProfileRepository::get()->profileExists(m_profile)) {
@@ -245,7 +244,6 @@ void Core::initGUI(const QString &MltPath, const QUrl &Url, const QString &clips
             m_profile = QStringLiteral("dv_pal");
         }
         KdenliveSettings::setDefault_profile(m_profile);
-        profileChanged();
     }
     // Init producer shown for unavailable media
     // TODO make it a more proper image, it currently causes a crash on exit
@@ -627,7 +625,6 @@ bool Core::setCurrentProfile(const QString profilePath)
         resetThumbProfile();
         // inform render widget
         m_timecode.setFormat(currentProfile->fps());
-        profileChanged();
         if (m_guiConstructed) {
             Q_EMIT m_mainWindow->updateRenderWidgetProfile();
             m_monitorManager->resetProfiles();
@@ -960,11 +957,6 @@ int Core::projectDuration() const
     return 0;
 }
 
-void Core::profileChanged()
-{
-    GenTime::setFps(getCurrentFps());
-}
-
 void Core::pushUndo(const Fun &undo, const Fun &redo, const QString &text)
 {
     undoStack()->push(new FunctionalUndoCommand(undo, redo, text));
@@ -186,8 +186,6 @@ public:
     void seekMonitor(int id, int position);
     /** @brief Returns timeline's active track info (position and tag) */
     QPair<int, QString> currentTrackInfo() const;
-    /** @brief This function must be called whenever the profile used changes */
-    void profileChanged();
 
     /** @brief Create and push and undo object based on the corresponding functions
         Note that if you class permits and requires it, you should use the macro PUSH_UNDO instead*/
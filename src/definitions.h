@@ -231,7 +231,8 @@ enum CacheType {
     CacheAudio = 4,
     CacheThumbs = 5,
     CacheSequence = 6,
-    CacheTmpWorkFiles = 7
+    CacheTmpWorkFiles = 7,
+    CachePreviewChunks = 8
 };
 
 enum TrimMode { NormalTrim, RippleTrim, RollingTrim, SlipTrim, SlideTrim };
@@ -309,6 +309,8 @@ void KdenliveSettingsDialog::initProxyPage()
     m_configProxy.kcfg_proxyminsize->setEnabled(KdenliveSettings::generateproxy());
     connect(m_configProxy.kcfg_generateimageproxy, &QAbstractButton::toggled, m_configProxy.kcfg_proxyimageminsize, &QWidget::setEnabled);
     m_configProxy.kcfg_proxyimageminsize->setEnabled(KdenliveSettings::generateimageproxy());
+    connect(m_configProxy.kcfg_proxyusedranges, &QAbstractButton::toggled, m_configProxy.kcfg_proxyrangehandles, &QWidget::setEnabled);
+    m_configProxy.kcfg_proxyrangehandles->setEnabled(KdenliveSettings::proxyusedranges());
     loadExternalProxyProfiles();
     connect(m_configProxy.button_external, &QToolButton::clicked, this, &KdenliveSettingsDialog::configureExternalProxies);
 }
@@ -18,6 +18,7 @@
 #include "profiles/profilemodel.hpp"
 #include "profiles/profilerepository.hpp"
 #include "project/projectmanager.h"
+#include "render/renderqueuescheduler.h"
 #include "render/renderrequest.h"
 #include "utils/qstringutils.h"
 #include "utils/timecode.h"
@@ -53,6 +54,7 @@
 #include <QProcess>
 #include <QScreen>
 #include <QScrollBar>
+#include <QSet>
 #include <QStandardPaths>
 #include <QString>
 #include <QTemporaryFile>
@@ -79,9 +81,16 @@ enum {
     LastTimeRole,
     LastFrameRole,
     OpenBrowserRole,
-    PlayAfterRole
+    PlayAfterRole,
+    ThreadsRole,
+    MemoryRole,
+    DependencyRole,
+    FpsHistoryRole
 };
 
+// Maximum number of throughput samples kept per job
+#define FPS_HISTORY_SIZE 600
+
 // Running job status
 enum JOBSTATUS { WAITINGJOB = 0, STARTINGJOB, RUNNINGJOB, FINISHEDJOB, FAILEDJOB, ABORTEDJOB };
 
@@ -250,6 +259,12 @@ RenderWidget::RenderWidget(bool enableProxy, QWidget *parent)
     m_view.encoder_threads->setValue(KdenliveSettings::encodethreads());
     connect(m_view.encoder_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setEncodethreads);
     connect(m_view.encoder_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &RenderWidget::refreshParams);
+    m_view.render_segments->setMaximum(QThread::idealThreadCount());
+    m_view.render_segments->setValue(KdenliveSettings::renderSegments());
+    connect(m_view.render_segments, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setRenderSegments);
+    m_view.parallel_exports->setMaximum(QThread::idealThreadCount());
+    m_view.parallel_exports->setValue(KdenliveSettings::renderParallelExports());
+    connect(m_view.parallel_exports, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &KdenliveSettings::setRenderParallelExports);
 
     connect(m_view.video_box, &QGroupBox::toggled, this, &RenderWidget::refreshParams);
     connect(m_view.audio_box, &QGroupBox::toggled, this, &RenderWidget::refreshParams);
@@ -705,6 +720,13 @@ void RenderWidget::slotPrepareExport2(bool delayedRendering)
     request->setProxyRendering(m_view.proxy_render->isChecked());
     request->setEmbedSubtitles(m_view.embed_subtitles->isEnabled() && m_view.embed_subtitles->isChecked());
     request->setTwoPass(m_view.checkTwoPass->isChecked());
+    request->setSegmentCount(m_view.render_segments->value());
+    int parallelExports = m_view.parallel_exports->value();
+    if (parallelExports <= 0) {
+        // Encoders rarely scale well beyond 4 threads per job on short sections
+        parallelExports = qMax(1, QThread::idealThreadCount() / 4);
+    }
+    request->setParallelJobs(parallelExports);
     request->setAudioFilePerTrack(m_view.stemAudioExport->isChecked() && m_view.stemAudioExport->isEnabled());
 
     bool guideMultiExport = m_view.guide_multi_box->isChecked();
@@ -765,6 +787,16 @@ RenderJobItem *RenderWidget::createRenderJob(const RenderRequest::RenderJob &job
 {
     QList<QTreeWidgetItem *> existing = m_view.running_jobs->findItems(job.outputPath, Qt::MatchExactly, 1);
     RenderJobItem *renderItem = nullptr;
+    if (!job.dependsOn.isEmpty()) {
+        // The job we depend on writes the same file, this is expected
+        for (int i = 0; i < existing.count(); ++i) {
+            const QStringList args = existing.at(i)->data(1, ParametersRole).toStringList();
+            if (args.size() > 2 && args.at(2) == job.dependsOn) {
+                existing.removeAt(i);
+                break;
+            }
+        }
+    }
     if (!existing.isEmpty()) {
         renderItem = static_cast<RenderJobItem *>(existing.at(0));
         if (renderItem->status() == RUNNINGJOB || renderItem->status() == WAITINGJOB || renderItem->status() == STARTINGJOB) {
@@ -790,6 +822,12 @@ RenderJobItem *RenderWidget::createRenderJob(const RenderRequest::RenderJob &job
 
     renderItem->setData(1, ParametersRole, argsJob);
     qDebug() << "* CREATED JOB WITH ARGS: " << argsJob;
+    int threads;
+    int memory;
+    estimateJobResources(job, threads, memory);
+    renderItem->setData(1, ThreadsRole, threads);
+    renderItem->setData(1, MemoryRole, memory);
+    renderItem->setData(1, DependencyRole, job.dependsOn);
     renderItem->setData(1, OpenBrowserRole, m_view.open_browser->isChecked());
     renderItem->setData(1, PlayAfterRole, m_view.play_after->isChecked());
     if (!m_view.audio_box->isChecked()) {
@@ -802,6 +840,32 @@ RenderJobItem *RenderWidget::createRenderJob(const RenderRequest::RenderJob &job
     return renderItem;
 }
 
+void RenderWidget::estimateJobResources(const RenderRequest::RenderJob &job, int &threads, int &memory) const
+{
+    const int cpuThreads = QThread::idealThreadCount();
+    const bool audioOnly = !m_view.video_box->isChecked() || job.outputPath.endsWith(QLatin1String(".wav"));
+    if (audioOnly) {
+        threads = 1;
+        memory = 100;
+        return;
+    }
+    int encoderThreads = KdenliveSettings::encodethreads();
+    if (encoderThreads <= 0) {
+        encoderThreads = cpuThreads;
+    }
+    // Jobs rendered concurrently share the encoder threads
+    encoderThreads = qMax(1, encoderThreads / qMax(1, job.parallel));
+    const int processingThreads = KdenliveSettings::parallelrender() ? KdenliveSettings::processingthreads() : 1;
+    threads = qMin(cpuThreads, qMax(encoderThreads, processingThreads) * job.segments);
+    // Frames buffered by the consumer and the processing threads, in RGBA
+    QSize frameSize(pCore->getCurrentProfile()->width(), pCore->getCurrentProfile()->height());
+    if (m_view.rescale->isEnabled() && m_view.rescale->isChecked()) {
+        frameSize = QSize(m_view.rescale_width->value(), m_view.rescale_height->value());
+    }
+    const qint64 frameBytes = qint64(frameSize.width()) * frameSize.height() * 4;
+    memory = int((200 + frameBytes * (25 + processingThreads) / 1024 / 1024) * job.segments);
+}
+
 void RenderWidget::checkRenderStatus()
 {
     // check if we have a job waiting to render
@@ -809,46 +873,99 @@ void RenderWidget::checkRenderStatus()
         return;
     }
 
-    // Make sure no other rendering is running
-    if (runningJobsCount() > 0) {
-        return;
+    // Describe the queue to the scheduler
+    std::vector<RenderQueueScheduler::Job> queue;
+    std::vector<RenderJobItem *> items;
+    QSet<QString> ids;
+    auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    while (item != nullptr) {
+        RenderQueueScheduler::Job job;
+        const QStringList args = item->data(1, ParametersRole).toStringList();
+        const QString playlist = args.size() > 2 ? args.at(2) : item->text(1);
+        // Several jobs can render the same playlist, the first one keeps the playlist as id so that dependencies find it
+        job.id = playlist;
+        for (int n = 2; ids.contains(job.id); ++n) {
+            job.id = QStringLiteral("%1#%2").arg(playlist).arg(n);
+        }
+        ids.insert(job.id);
+        job.output = item->text(1);
+        job.dependsOn = item->data(1, DependencyRole).toString();
+        job.threads = qMax(1, item->data(1, ThreadsRole).toInt());
+        job.memory = item->data(1, MemoryRole).toInt();
+        switch (item->status()) {
+        case WAITINGJOB:
+            job.state = RenderQueueScheduler::State::Waiting;
+            break;
+        case STARTINGJOB:
+        case RUNNINGJOB:
+            job.state = RenderQueueScheduler::State::Running;
+            break;
+        case FINISHEDJOB:
+            job.state = RenderQueueScheduler::State::Done;
+            break;
+        default:
+            job.state = RenderQueueScheduler::State::Failed;
+            break;
+        }
+        queue.push_back(job);
+        items.push_back(item);
+        item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
 
-    auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
+    for (size_t ix : RenderQueueScheduler::blocked(queue)) {
+        items.at(ix)->setStatus(FAILEDJOB);
+        items.at(ix)->setData(1, Qt::UserRole, i18n("Not started, a required job failed"));
+    }
 
-    bool waitingJob = false;
+    RenderQueueScheduler::Budget budget;
+    budget.threads = KdenliveSettings::renderThreadBudget() > 0 ? KdenliveSettings::renderThreadBudget() : QThread::idealThreadCount();
+    budget.memory = KdenliveSettings::renderMemoryBudget();
+    const std::vector<size_t> admitted = RenderQueueScheduler::admit(queue, budget);
+    for (size_t ix : admitted) {
+        item = items.at(ix);
+        QDateTime t = QDateTime::currentDateTime();
+        item->setData(1, StartTimeRole, t);
+        item->setData(1, LastTimeRole, t);
+        startRendering(item);
+        // Remove the finished job we depended on (1st pass of a 2 pass encoding), it writes the same file
+        const QString dependency = queue.at(ix).dependsOn;
+        if (!dependency.isEmpty()) {
+            for (size_t j = 0; j < items.size(); ++j) {
+                if (queue.at(j).id == dependency && queue.at(j).state == RenderQueueScheduler::State::Done) {
+                    delete items.at(j);
+                    items[j] = nullptr;
+                    break;
+                }
+            }
+        }
+        item->setStatus(STARTINGJOB);
+    }
+    if (admitted.empty() && m_view.shutdown->isChecked() && runningJobsCount() == 0 && waitingJobsCount() == 0) {
+        Q_EMIT shutdown();
+    }
+}
 
-    // Find first waiting job
+void RenderWidget::removeSharedPlaylists()
+{
+    // Jobs sharing a playlist only differ by their range and output
+    QSet<QString> sharedPlaylists;
+    QSet<QString> usedPlaylists;
+    auto *item = static_cast<RenderJobItem *>(m_view.running_jobs->topLevelItem(0));
     while (item != nullptr) {
-        if (item->status() == WAITINGJOB) {
-            QDateTime t = QDateTime::currentDateTime();
-            item->setData(1, StartTimeRole, t);
-            item->setData(1, LastTimeRole, t);
-            waitingJob = true;
-            startRendering(item);
-            // Check for 2 pass encoding
-            QStringList jobData = item->data(1, ParametersRole).toStringList();
-            if (jobData.size() > 2 && jobData.at(1).endsWith(QStringLiteral("-pass2.mlt"))) {
-                // Find and remove 1st pass job
-                QTreeWidgetItem *above = m_view.running_jobs->itemAbove(item);
-                QString firstPassName = jobData.at(1).section(QLatin1Char('-'), 0, -2) + QStringLiteral(".mlt");
-                while (above) {
-                    QStringList aboveData = above->data(1, ParametersRole).toStringList();
-                    qDebug() << "// GOT  JOB: " << aboveData.at(1);
-                    if (aboveData.size() > 2 && aboveData.at(1) == firstPassName) {
-                        delete above;
-                        break;
-                    }
-                    above = m_view.running_jobs->itemAbove(above);
-                }
+        const QStringList args = item->data(1, ParametersRole).toStringList();
+        if (args.size() > 2 && args.contains(QStringLiteral("--in"))) {
+            sharedPlaylists.insert(args.at(2));
+            if (item->status() == WAITINGJOB || item->status() == STARTINGJOB || item->status() == RUNNINGJOB) {
+                usedPlaylists.insert(args.at(2));
             }
-            item->setStatus(STARTINGJOB);
-            break;
         }
         item = static_cast<RenderJobItem *>(m_view.running_jobs->itemBelow(item));
     }
-    if (!waitingJob && m_view.shutdown->isChecked()) {
-        Q_EMIT shutdown();
+    sharedPlaylists.subtract(usedPlaylists);
+    for (const QString &playlist : qAsConst(sharedPlaylists)) {
+        if (playlist.startsWith(QDir::tempPath())) {
+            QFile::remove(playlist);
+        }
     }
 }
 
@@ -1266,6 +1383,21 @@ void RenderWidget::setRenderProgress(const QString &dest, int progress, int fram
         int speed = (frame - item->data(1, LastFrameRole).toInt()) / dt;
         est.append(i18n(" (frame %1 @ %2 fps)", frame, speed));
         item->setData(1, Qt::UserRole, est);
+        QVariantList history = item->data(1, FpsHistoryRole).toList();
+        history.append(speed);
+        while (history.size() > FPS_HISTORY_SIZE) {
+            history.removeFirst();
+        }
+        item->setData(1, FpsHistoryRole, history);
+        int minSpeed = speed;
+        int maxSpeed = speed;
+        qint64 total = 0;
+        for (const QVariant &v : qAsConst(history)) {
+            minSpeed = qMin(minSpeed, v.toInt());
+            maxSpeed = qMax(maxSpeed, v.toInt());
+            total += v.toInt();
+        }
+        item->setToolTip(1, i18n("Rendering speed: %1 fps average, %2 to %3 fps", total / history.size(), minSpeed, maxSpeed));
         item->setData(1, LastTimeRole, elapsedTime);
         item->setData(1, LastFrameRole, frame);
     }
@@ -1347,6 +1479,7 @@ void RenderWidget::setRenderStatus(const QString &dest, int status, const QStrin
     } else {
         delete item;
     }
+    removeSharedPlaylists();
     slotCheckJob();
     checkRenderStatus();
 }
@@ -1359,6 +1492,7 @@ void RenderWidget::slotAbortCurrentJob()
             Q_EMIT abortProcess(current->text(1));
         } else {
             delete current;
+            removeSharedPlaylists();
             slotCheckJob();
             checkRenderStatus();
         }
@@ -223,9 +223,13 @@ private:
     /** @brief Check if a job needs to be started. */
     void checkRenderStatus();
     void startRendering(RenderJobItem *item);
+    /** @brief Remove the temporary playlists shared by several jobs once none of them is waiting or running */
+    void removeSharedPlaylists();
     /** @brief Create a rendering profile from MLT preset. */
     QTreeWidgetItem *loadFromMltPreset(const QString &groupName, const QString &path, QString profileName, bool codecInName = false);
     RenderJobItem *createRenderJob(const RenderRequest::RenderJob &job);
+    /** @brief Estimate the CPU threads and memory (in MB) used by a job with the current settings. */
+    void estimateJobResources(const RenderRequest::RenderJob &job, int &threads, int &memory) const;
     void updateRenderInfoMessage();
 
 Q_SIGNALS:
@@ -30,6 +30,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/model/timelineitemmodel.hpp"
 #include "titler/titlewidget.h"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/trace.h"
 #include <config-kdenlive.h>
 
 #include <KBookmark>
@@ -153,7 +154,7 @@ KdenliveDoc::KdenliveDoc(std::shared_ptr<DocUndoStack> undoStack, std::pair<int,
 DocOpenResult KdenliveDoc::Open(const QUrl &url, const QString &projectFolder, QUndoGroup *undoGroup,
     bool recoverCorruption, MainWindow *parent)
 {
-
+    KDENLIVE_TRACE("project", "KdenliveDoc::Open");
     DocOpenResult result = DocOpenResult{};
 
     if (url.isEmpty() || !url.isValid()) {
@@ -570,6 +571,7 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
 
 void KdenliveDoc::slotAutoSave(const QString &scene)
 {
+    KDENLIVE_TRACE("project", "writeAutoSave");
     if (m_autosave != nullptr) {
         if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
             // show error: could not open the autosave file
@@ -1647,7 +1649,11 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<std::shared_ptr<Proje
                         }
                     }
                 }
-                if (path.isEmpty()) {
+                if (path.isEmpty() && KdenliveSettings::proxyusedranges() && (t == ClipType::AV || t == ClipType::Video) &&
+                    !newProps.contains(QStringLiteral("kdenlive:camcorderproxy")) && !item->hasProducerProperty(QStringLiteral("kdenlive:camcorderproxy"))) {
+                    // Only the used parts are encoded, in files named after the proxy playlist
+                    path = dir.absoluteFilePath(item->hash() + extension + QStringLiteral(".mlt"));
+                } else if (path.isEmpty()) {
                     path = dir.absoluteFilePath(item->hash() + (t == ClipType::Image ? QStringLiteral(".png") : extension));
                 }
                 newProps.insert(QStringLiteral("kdenlive:proxy"), path);
@@ -2161,6 +2167,11 @@ const QDir KdenliveDoc::getCacheDir(CacheType type, bool *ok, const QUuid uuid)
         basePath = kdenliveCacheDir;
         basePath.append(QStringLiteral("/proxy"));
         break;
+    case CachePreviewChunks:
+        // Timeline preview chunks are named by their content and shared by all projects
+        basePath = kdenliveCacheDir;
+        basePath.append(QStringLiteral("/previewchunks"));
+        break;
     case CacheAudio:
         basePath.append(QStringLiteral("/audiothumbs"));
         break;
@@ -40,8 +40,13 @@ EffectItemModel::EffectItemModel(const QList<QVariant> &effectData, std::unique_
 std::shared_ptr<EffectItemModel> EffectItemModel::construct(const QString &effectId, std::shared_ptr<AbstractTreeModel> stack, bool effectEnabled)
 {
     Q_ASSERT(EffectsRepository::get()->exists(effectId));
-    QDomElement xml = EffectsRepository::get()->getXml(effectId);
+    return construct(effectId, EffectsRepository::get()->getXml(effectId), std::move(stack), effectEnabled);
+}
 
+// static
+std::shared_ptr<EffectItemModel> EffectItemModel::construct(const QString &effectId, const QDomElement &xml, std::shared_ptr<AbstractTreeModel> stack,
+                                                            bool effectEnabled)
+{
     std::unique_ptr<Mlt::Properties> effect = EffectsRepository::get()->getEffect(effectId);
     effect->set("kdenlive_id", effectId.toUtf8().constData());
 
@@ -21,6 +21,11 @@ public:
        @param is a ptr to the model this item belongs to. This is required to send update signals
      */
     static std::shared_ptr<EffectItemModel> construct(const QString &effectId, std::shared_ptr<AbstractTreeModel> stack, bool effectEnabled = true);
+    /** @brief This construct an effect of the given id from its description @param xml, as returned by the effects repository.
+       The description is only read, so it can be shared by all the effects created when applying an effect to many items
+     */
+    static std::shared_ptr<EffectItemModel> construct(const QString &effectId, const QDomElement &xml, std::shared_ptr<AbstractTreeModel> stack,
+                                                      bool effectEnabled = true);
     /** @brief This construct an effect with an already existing filter
        Only used when loading an existing clip
      */
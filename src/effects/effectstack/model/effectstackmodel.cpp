@@ -576,9 +576,9 @@ bool EffectStackModel::copyEffect(const std::shared_ptr<AbstractEffectItem> &sou
     return res;
 }
 
-bool EffectStackModel::appendEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo)
+bool EffectStackModel::appendEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo, const QDomElement &xml)
 {
-    return doAppendEffect(effectId, true, {}, undo, redo);
+    return doAppendEffect(effectId, true, {}, undo, redo, xml);
 }
 
 bool EffectStackModel::appendEffect(const QString &effectId, bool makeCurrent, stringMap params)
@@ -592,7 +592,7 @@ bool EffectStackModel::appendEffect(const QString &effectId, bool makeCurrent, s
     return result;
 }
 
-bool EffectStackModel::doAppendEffect(const QString &effectId, bool makeCurrent, stringMap params, Fun &undo, Fun &redo)
+bool EffectStackModel::doAppendEffect(const QString &effectId, bool makeCurrent, stringMap params, Fun &undo, Fun &redo, const QDomElement &xml)
 {
     QWriteLocker locker(&m_lock);
     if (m_ownerId.type == KdenliveObjectType::TimelineClip && EffectsRepository::get()->isUnique(effectId) && hasFilter(effectId)) {
@@ -602,10 +602,10 @@ bool EffectStackModel::doAppendEffect(const QString &effectId, bool makeCurrent,
     std::unordered_set<int> previousFadeIn = m_fadeIns;
     std::unordered_set<int> previousFadeOut = m_fadeOuts;
     if (EffectsRepository::get()->isGroup(effectId)) {
-        QDomElement doc = EffectsRepository::get()->getXml(effectId);
-        return copyXmlEffect(doc);
+        QDomElement doc = xml.isNull() ? EffectsRepository::get()->getXml(effectId) : xml;
+        return fromXml(doc, undo, redo);
     }
-    auto effect = EffectItemModel::construct(effectId, shared_from_this());
+    auto effect = xml.isNull() ? EffectItemModel::construct(effectId, shared_from_this()) : EffectItemModel::construct(effectId, xml, shared_from_this());
     PlaylistState::ClipState state = pCore->getItemState(m_ownerId);
     if (state == PlaylistState::VideoOnly) {
         if (effect->isAudio()) {
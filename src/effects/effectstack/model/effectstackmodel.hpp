@@ -44,7 +44,11 @@ protected:
 public:
     /** @brief Add an effect at the bottom of the stack */
     bool appendEffect(const QString &effectId, bool makeCurrent = false, stringMap params = {});
-    bool appendEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo);
+    /** @brief Add an effect at the bottom of the stack, storing the operations in @param undo and @param redo
+       @param xml is the effect description from the effects repository. When adding the same effect to many stacks, fetch it once and
+       pass it to all of them so that it is shared instead of cloned for each effect
+    */
+    bool appendEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo, const QDomElement &xml = QDomElement());
     /** @brief Copy an existing effect and append it at the bottom of the stack
      */
     bool copyEffect(const std::shared_ptr<AbstractEffectItem> &sourceItem, PlaylistState::ClipState state, bool logUndo = true);
@@ -198,7 +202,7 @@ private:
      *          in the producer, so we shouldn't plant them again. Setting this value to
      *          true will prevent planting in the producer */
     bool m_loadingExisting;
-    bool doAppendEffect(const QString &effectId, bool makeCurrent, stringMap params, Fun &undo, Fun &redo);
+    bool doAppendEffect(const QString &effectId, bool makeCurrent, stringMap params, Fun &undo, Fun &redo, const QDomElement &xml = QDomElement());
 
 private Q_SLOTS:
     /** @brief: Some effects do not support dynamic changes like sox, and need to be unplugged / replugged on each param change
@@ -96,6 +96,36 @@ bool AbstractTask::operator==(const AbstractTask &b)
     return m_owner == b.ownerId();
 }
 
+const char *AbstractTask::traceName() const
+{
+    switch (m_type) {
+    case PROXYJOB:
+        return "ProxyTask";
+    case CUTJOB:
+        return "CutTask";
+    case STABILIZEJOB:
+        return "StabilizeTask";
+    case TRANSCODEJOB:
+        return "TranscodeTask";
+    case FILTERCLIPJOB:
+        return "FilterTask";
+    case THUMBJOB:
+        return "ThumbTask";
+    case ANALYSECLIPJOB:
+        return "AnalyseTask";
+    case LOADJOB:
+        return "ClipLoadTask";
+    case AUDIOTHUMBJOB:
+        return "AudioLevelsTask";
+    case SPEEDJOB:
+        return "SpeedTask";
+    case CACHEJOB:
+        return "CacheTask";
+    default:
+        return "Task";
+    }
+}
+
 void AbstractTask::run()
 {
     qDebug() << "============0\n\nABSTRACT TASKSTARTRING\n\n==================";
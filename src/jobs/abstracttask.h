@@ -7,6 +7,7 @@
 #pragma once
 
 #include "definitions.h"
+#include "utils/trace.h"
 
 #include <QAtomicInt>
 #include <QMutex>
@@ -40,6 +41,8 @@ public:
     static void setPreferredPriority(qint64 pid);
     const ObjectId ownerId() const;
     bool operator==(const AbstractTask& b);
+    /** @brief Name of the task type in traces */
+    const char *traceName() const;
 
 protected:
     ObjectId m_owner;
@@ -53,13 +56,14 @@ protected:
     bool m_isForce;
     bool m_running;
     QUuid m_uuid;
+    /** @brief The priority in the thread pool, tasks with a higher priority start first */
+    int m_priority;
     void run() override;
     void cleanup();
 
 private:
     //QString cacheKey();
     JOBTYPE m_type;
-    int m_priority;
     bool cancelJob(bool softDelete = false);
     bool isCanceled() const;
 
@@ -69,14 +73,17 @@ Q_SIGNALS:
 
 /**
  * @brief When destroyed, notifies the taskManager that this task is done.
+ * It lives for the whole task run, which is recorded in traces.
  */
 class AbstractTaskDone {
 public:
     AbstractTaskDone(int cid, AbstractTask *task)
         : m_cid(cid)
-        , m_task(task) {}
+        , m_task(task)
+        , m_trace("task", task->traceName()) {}
     ~AbstractTaskDone();
 private:
     int m_cid;
     AbstractTask *m_task;
+    TraceScope m_trace;
 };
@@ -15,6 +15,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivesettings.h"
 #include "mltcontroller/clipcontroller.h"
 #include "project/dialogs/slideshowclip.h"
+#include "proxytask.h"
 #include "utils/thumbnailcache.hpp"
 
 #include "xml/xml.hpp"
@@ -316,6 +317,10 @@ void ClipLoadTask::run()
         type = ClipType::AV;
         service.clear();
     }
+    if ((type == ClipType::AV || type == ClipType::Video) && ProxyTask::isRangeProxy(resource)) {
+        // The proxy only contains the used parts of the clip, at their original position in a playlist
+        service = QStringLiteral("xml");
+    }
     std::shared_ptr<Mlt::Producer> producer;
     switch (type) {
     case ClipType::Color:
@@ -540,6 +545,16 @@ void ClipLoadTask::run()
         }
     }
     processProducerProperties(producer, m_xml);
+    if (mltService == QLatin1String("xml") && ProxyTask::isRangeProxy(resource)) {
+        // Keep the streams selected for the clip, the segments of the proxy provide the stream info
+        for (const QString &index : {QStringLiteral("audio_index"), QStringLiteral("video_index")}) {
+            const QString value = Xml::getXmlProperty(m_xml, index);
+            if (!value.isEmpty()) {
+                producer->set(index.toUtf8().constData(), value.toInt());
+            }
+        }
+        ProxyTask::passRangeProxyStreams(resource, *producer.get());
+    }
     QString clipName = Xml::getXmlProperty(m_xml, QStringLiteral("kdenlive:clipname"));
     if (clipName.isEmpty()) {
         clipName = QFileInfo(Xml::getXmlProperty(m_xml, QStringLiteral("kdenlive:originalurl"))).fileName();
@@ -613,7 +628,7 @@ void ClipLoadTask::run()
     bool isVariableFrameRate = false;
     bool seekable = true;
     bool checkProfile = pCore->bin()->shouldCheckProfile;
-    if (mltService == QLatin1String("xml") || mltService == QLatin1String("consumer")) {
+    if ((mltService == QLatin1String("xml") || mltService == QLatin1String("consumer")) && !ProxyTask::isRangeProxy(resource)) {
         // MLT playlist, create producer with blank profile to get real profile info
         QString tmpPath = resource;
         if (tmpPath.startsWith(QLatin1String("consumer:"))) {
@@ -13,16 +13,46 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
+#include "xml/xml.hpp"
 
+#include <QDir>
+#include <QElapsedTimer>
 #include <QProcess>
 #include <QTemporaryFile>
-#include <QThread>
+#include <QtMath>
+
+#include <algorithm>
+#include <cstring>
 
 #include <KLocalizedString>
+#include <mlt++/MltProducer.h>
+
+namespace {
+/** @brief Sources with the same codec and frame size are transcoded at a similar speed */
+QString transcodeSpeedKey(const std::shared_ptr<ProjectClip> &binClip)
+{
+    return QStringLiteral("%1 %2x%3")
+        .arg(binClip->videoCodecProperty(QStringLiteral("name")), binClip->getProducerProperty(QStringLiteral("meta.media.width")),
+             binClip->getProducerProperty(QStringLiteral("meta.media.height")));
+}
+
+/** @brief The position of the input option of @param source in FFmpeg @param parameters, or -1 */
+int inputIndex(const QStringList &parameters, const QString &source)
+{
+    for (int i = 0; i + 1 < parameters.size(); ++i) {
+        if (parameters.at(i) == QLatin1String("-i") && parameters.at(i + 1) == source) {
+            return i;
+        }
+    }
+    return -1;
+}
+} // namespace
 
 ProxyTask::ProxyTask(const ObjectId &owner, QObject *object)
     : AbstractTask(owner, AbstractTask::PROXYJOB, object)
     , m_jobDuration(0)
+    , m_doneDuration(0)
+    , m_encodedFrames(0)
     , m_isFfmpegJob(true)
     , m_jobProcess(nullptr)
 {
@@ -35,12 +65,170 @@ void ProxyTask::start(const ObjectId &owner, QObject *object, bool force)
     if (pCore->taskManager.hasPendingJob(owner, AbstractTask::PROXYJOB)) {
         return;
     }
+    QVector<QPoint> ranges;
+    auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(owner.itemId));
+    if (binClip && isRangeProxy(binClip->getProducerProperty(QStringLiteral("kdenlive:proxy")))) {
+        // The timelines cannot be read from the task thread, collect the used ranges now
+        const int handles = qRound(KdenliveSettings::proxyrangehandles() * pCore->getCurrentFps());
+        ranges = mergeRanges(binClip->timelineRanges(), handles, int(binClip->frameDuration()));
+        if (ranges.isEmpty()) {
+            // The clip is not used yet, its proxy will be created when it is inserted in a timeline
+            binClip->resetProducerProperty(QStringLiteral("_overwriteproxy"));
+            if (binClip->hasProxy()) {
+                QMetaObject::invokeMethod(binClip.get(), "updateProxyProducer", Qt::QueuedConnection,
+                                          Q_ARG(QString, binClip->getProducerProperty(QStringLiteral("kdenlive:originalurl"))));
+            }
+            return;
+        }
+    }
     ProxyTask *task = new ProxyTask(owner, object);
     // Otherwise, start a new proxy generation thread.
     task->m_isForce = force;
+    task->m_ranges = ranges;
+    if (binClip) {
+        // Start the shortest jobs first so that the proxies become available sooner
+        int frames = int(binClip->frameDuration());
+        if (!ranges.isEmpty()) {
+            frames = 0;
+            for (const QPoint &range : qAsConst(ranges)) {
+                frames += range.y() - range.x() + 1;
+            }
+        }
+        const double clipSpeed = binClip->getProducerProperty(QStringLiteral("kdenlive:proxyfps")).toDouble();
+        const double estimate = clipSpeed > 0. ? frames / clipSpeed : pCore->taskManager.estimatedTranscodeTime(transcodeSpeedKey(binClip), frames);
+        task->m_priority = -int(qMin(estimate, 1e6));
+    }
     pCore->taskManager.startTask(owner.itemId, task);
 }
 
+// static
+bool ProxyTask::isRangeProxy(const QString &path)
+{
+    return path.endsWith(QLatin1String(".mlt"));
+}
+
+// static
+QVector<QPoint> ProxyTask::mergeRanges(QVector<QPoint> ranges, int handles, int length)
+{
+    std::sort(ranges.begin(), ranges.end(), [](const QPoint &a, const QPoint &b) { return a.x() < b.x(); });
+    QVector<QPoint> merged;
+    for (const QPoint &range : qAsConst(ranges)) {
+        const int in = qMax(0, range.x() - handles);
+        const int out = range.y() >= length - handles ? length - 1 : range.y() + handles;
+        if (in > out) {
+            continue;
+        }
+        if (!merged.isEmpty() && in <= merged.last().y() + handles + 1) {
+            merged.last().setY(qMax(merged.last().y(), out));
+        } else {
+            merged << QPoint(in, out);
+        }
+    }
+    return merged;
+}
+
+// static
+bool ProxyTask::coversRanges(const QVector<QPoint> &covered, const QVector<QPoint> &used)
+{
+    for (const QPoint &range : used) {
+        auto match = std::find_if(covered.cbegin(), covered.cend(),
+                                  [&range](const QPoint &coveredRange) { return coveredRange.x() <= range.x() && coveredRange.y() >= range.y(); });
+        if (match == covered.cend()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// static
+QString ProxyTask::rangesToString(const QVector<QPoint> &ranges)
+{
+    QStringList values;
+    for (const QPoint &range : ranges) {
+        values << QStringLiteral("%1:%2").arg(range.x()).arg(range.y());
+    }
+    return values.join(QLatin1Char(';'));
+}
+
+// static
+QVector<QPoint> ProxyTask::rangesFromString(const QString &ranges)
+{
+    QVector<QPoint> result;
+    const QStringList values = ranges.split(QLatin1Char(';'), Qt::SkipEmptyParts);
+    for (const QString &value : values) {
+        bool inOk = false;
+        bool outOk = false;
+        const int in = value.section(QLatin1Char(':'), 0, 0).toInt(&inOk);
+        const int out = value.section(QLatin1Char(':'), 1, 1).toInt(&outOk);
+        if (inOk && outOk && in <= out) {
+            result << QPoint(in, out);
+        }
+    }
+    return result;
+}
+
+// static
+QStringList ProxyTask::rangeProxySegments(const QString &path)
+{
+    QStringList segments;
+    QDomDocument doc;
+    if (!Xml::docContentFromFile(doc, path, false)) {
+        return segments;
+    }
+    // The resources are relative to the playlist folder
+    const QDir dir = QFileInfo(path).absoluteDir();
+    const QDomNodeList producers = doc.documentElement().elementsByTagName(QStringLiteral("producer"));
+    for (int i = 0; i < producers.count(); ++i) {
+        segments << dir.absoluteFilePath(Xml::getXmlProperty(producers.at(i).toElement(), QStringLiteral("resource")));
+    }
+    return segments;
+}
+
+// static
+void ProxyTask::passRangeProxyStreams(const QString &path, Mlt::Properties &properties)
+{
+    const QStringList segments = rangeProxySegments(path);
+    if (segments.isEmpty()) {
+        return;
+    }
+    Mlt::Producer segment(pCore->getProjectProfile(), "avformat", segments.constFirst().toUtf8().constData());
+    if (!segment.is_valid()) {
+        return;
+    }
+    segment.probe();
+    for (int i = 0; i < segment.count(); ++i) {
+        const char *name = segment.get_name(i);
+        if (name != nullptr && strncmp(name, "meta.media.", 11) == 0) {
+            properties.set(name, segment.get(i));
+        }
+    }
+    for (const char *index : {"audio_index", "video_index"}) {
+        if (!properties.property_exists(index)) {
+            properties.set(index, segment.get_int(index));
+        }
+    }
+}
+
+// static
+QString ProxyTask::rangeProxyXml(const QString &path, int audioIndex, int astream)
+{
+    QDomDocument doc;
+    if (!Xml::docContentFromFile(doc, path, false)) {
+        return QString();
+    }
+    const QDir dir = QFileInfo(path).absoluteDir();
+    const QDomNodeList producers = doc.documentElement().elementsByTagName(QStringLiteral("producer"));
+    for (int i = 0; i < producers.count(); ++i) {
+        QDomElement producer = producers.at(i).toElement();
+        Xml::setXmlProperty(producer, QStringLiteral("resource"), dir.absoluteFilePath(Xml::getXmlProperty(producer, QStringLiteral("resource"))));
+        if (audioIndex > -1) {
+            Xml::setXmlProperty(producer, QStringLiteral("audio_index"), QString::number(audioIndex));
+        }
+        Xml::setXmlProperty(producer, QStringLiteral("astream"), QString::number(astream));
+    }
+    return doc.toString();
+}
+
 void ProxyTask::run()
 {
     AbstractTaskDone whenFinished(m_owner.itemId, this);
@@ -55,7 +243,9 @@ void ProxyTask::run()
     }
     const QString dest = binClip->getProducerProperty(QStringLiteral("kdenlive:proxy"));
     QFileInfo fInfo(dest);
-    if (binClip->getProducerIntProperty(QStringLiteral("_overwriteproxy")) == 0 && fInfo.exists() && fInfo.size() > 0) {
+    const bool overwrite = binClip->getProducerIntProperty(QStringLiteral("_overwriteproxy")) > 0;
+    if (!overwrite && fInfo.exists() && fInfo.size() > 0 &&
+        (m_ranges.isEmpty() || coversRanges(rangesFromString(binClip->getProducerProperty(QStringLiteral("kdenlive:proxyranges"))), m_ranges))) {
         // Proxy clip already created
         m_progress = 100;
         QMetaObject::invokeMethod(m_object, "updateJobProgress");
@@ -66,9 +256,12 @@ void ProxyTask::run()
     ClipType::ProducerType type = binClip->clipType();
     m_progress = 0;
     bool result = false;
+    QElapsedTimer timer;
+    timer.start();
     QString source = binClip->getProducerProperty(QStringLiteral("kdenlive:originalurl"));
     int exif = binClip->getProducerIntProperty(QStringLiteral("_exif_orientation"));
-    if (type == ClipType::Playlist || type == ClipType::SlideShow) {
+    // Range proxies are always encoded by FFmpeg, even if the clip was wrongly detected as a playlist
+    if ((type == ClipType::Playlist || type == ClipType::SlideShow) && m_ranges.isEmpty()) {
         // change FFmpeg params to MLT format
         m_isFfmpegJob = false;
         QStringList mltParameters;
@@ -161,12 +354,8 @@ void ProxyTask::run()
             }
             mltParameters << t;
         }
-        int threadCount = QThread::idealThreadCount();
-        if (threadCount > 2) {
-            threadCount = qMin(threadCount - 1, 4);
-        } else {
-            threadCount = 1;
-        }
+        const int threadCount = pCore->taskManager.transcodeThreadBudget();
+        m_encodedFrames = int(binClip->frameDuration());
         // real_time parameter seems to cause rendering artifacts with playlist clips
         // mltParameters.append(QStringLiteral("real_time=-%1").arg(threadCount));
         mltParameters.append(QStringLiteral("threads=%1").arg(threadCount));
@@ -377,20 +566,48 @@ void ProxyTask::run()
             parameters << QStringLiteral("-sn") << QStringLiteral("-dn") << QStringLiteral("-map") << QStringLiteral("0");
             // Drop unknown streams instead of aborting
             parameters << QStringLiteral("-ignore_unknown");
+            if (!proxyParams.contains(QLatin1String("-threads"))) {
+                // Share the cores with the other transcoding jobs, for decoding and encoding
+                const QString threads = QString::number(pCore->taskManager.transcodeThreadBudget());
+                int index = inputIndex(parameters, source);
+                if (index >= 0) {
+                    parameters.insert(index, threads);
+                    parameters.insert(index, QStringLiteral("-threads"));
+                }
+                parameters << QStringLiteral("-threads") << threads;
+            }
             parameters << dest;
             qDebug() << "/// FULL PROXY PARAMS:\n" << parameters << "\n------";
         }
-        m_jobProcess.reset(new QProcess);
-        // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
-        QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
-        QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
-        m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
-        AbstractTask::setPreferredPriority(m_jobProcess->processId());
-        m_jobProcess->waitForFinished(-1);
-        result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+        if (!m_ranges.isEmpty()) {
+            result = encodeRanges(parameters, source, dest, int(binClip->frameDuration()), !overwrite);
+            if (result) {
+                binClip->setProducerProperty(QStringLiteral("kdenlive:proxyranges"), rangesToString(m_ranges));
+            }
+        } else {
+            m_jobProcess.reset(new QProcess);
+            // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
+            QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
+            QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
+            m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
+            AbstractTask::setPreferredPriority(m_jobProcess->processId());
+            m_jobProcess->waitForFinished(-1);
+            result = m_jobProcess->exitStatus() == QProcess::NormalExit;
+            if (!binClip->hasProducerProperty(QStringLiteral("kdenlive:camcorderproxy"))) {
+                // Camcorder proxies are only remuxed, their speed says nothing about transcoding
+                m_encodedFrames = int(binClip->frameDuration());
+            }
+        }
     }
     // remove temporary playlist if it exists
     m_progress = 100;
+    const qint64 elapsed = timer.elapsed();
+    if (result && !m_isCanceled && m_encodedFrames > 0 && elapsed > 0) {
+        // Remember the speed to order the next jobs
+        const double fps = m_encodedFrames * 1000. / elapsed;
+        pCore->taskManager.recordTranscodeSpeed(transcodeSpeedKey(binClip), fps);
+        binClip->setProducerProperty(QStringLiteral("kdenlive:proxyfps"), QString::number(fps, 'f', 1));
+    }
     if (result && !m_isCanceled) {
         if (QFileInfo(dest).size() == 0) {
             QFile::remove(dest);
@@ -417,6 +634,113 @@ void ProxyTask::run()
     return;
 }
 
+bool ProxyTask::encodeRanges(const QStringList &parameters, const QString &source, const QString &dest, int length, bool reuseSegments)
+{
+    // The input options must be placed before the source
+    const int sourceIndex = inputIndex(parameters, source);
+    if (sourceIndex < 0) {
+        return false;
+    }
+    // The playlist hash.ext.mlt uses the segments hash-in-out.ext
+    const QFileInfo info(dest);
+    const QDir dir = info.absoluteDir();
+    const QString baseName = info.completeBaseName();
+    const QString hash = baseName.section(QLatin1Char('.'), 0, 0);
+    const QString extension = baseName.section(QLatin1Char('.'), 1);
+    const double fps = pCore->getCurrentFps();
+    QStringList segments;
+    QVector<int> toEncode;
+    m_jobDuration = 0;
+    for (int i = 0; i < m_ranges.size(); ++i) {
+        const QPoint &range = m_ranges.at(i);
+        segments << QStringLiteral("%1-%2-%3.%4").arg(hash).arg(range.x()).arg(range.y()).arg(extension);
+        const QFileInfo segmentInfo(dir.absoluteFilePath(segments.last()));
+        if (!reuseSegments || !segmentInfo.exists() || segmentInfo.size() == 0) {
+            toEncode << i;
+            m_jobDuration += qCeil((range.y() - range.x() + 1) / fps);
+            m_encodedFrames += range.y() - range.x() + 1;
+        }
+    }
+    m_jobDuration = qMax(1, m_jobDuration);
+    m_doneDuration = 0;
+    for (int i : qAsConst(toEncode)) {
+        const QPoint &range = m_ranges.at(i);
+        const QString segmentPath = dir.absoluteFilePath(segments.at(i));
+        QStringList segmentParameters = parameters;
+        segmentParameters.insert(sourceIndex, QString::number(range.x() / fps, 'f', 3));
+        segmentParameters.insert(sourceIndex, QStringLiteral("-ss"));
+        segmentParameters.last() = segmentPath;
+        segmentParameters.insert(segmentParameters.size() - 1, QStringLiteral("-t"));
+        segmentParameters.insert(segmentParameters.size() - 1, QString::number((range.y() - range.x() + 1) / fps, 'f', 3));
+        m_jobProcess.reset(new QProcess);
+        QObject::connect(m_jobProcess.get(), &QProcess::readyReadStandardError, this, &ProxyTask::processLogInfo);
+        QObject::connect(this, &ProxyTask::jobCanceled, m_jobProcess.get(), &QProcess::kill, Qt::DirectConnection);
+        m_jobProcess->start(KdenliveSettings::ffmpegpath(), segmentParameters, QIODevice::ReadOnly);
+        AbstractTask::setPreferredPriority(m_jobProcess->processId());
+        m_jobProcess->waitForFinished(-1);
+        // Segments are reused by the next builds, never keep an incomplete one
+        if (m_isCanceled || m_jobProcess->exitStatus() != QProcess::NormalExit || m_jobProcess->exitCode() != 0 || QFileInfo(segmentPath).size() == 0) {
+            QFile::remove(segmentPath);
+            return false;
+        }
+        m_doneDuration += qCeil((range.y() - range.x() + 1) / fps);
+    }
+
+    // Place the segments at their position in the clip, the resources are relative to the playlist folder
+    QDomDocument doc;
+    QDomElement mlt = doc.createElement(QStringLiteral("mlt"));
+    mlt.setAttribute(QStringLiteral("LC_NUMERIC"), QStringLiteral("C"));
+    doc.appendChild(mlt);
+    QDomElement playlist = doc.createElement(QStringLiteral("playlist"));
+    playlist.setAttribute(QStringLiteral("id"), QStringLiteral("proxy"));
+    int position = 0;
+    for (int i = 0; i < m_ranges.size(); ++i) {
+        const QPoint &range = m_ranges.at(i);
+        const QString segmentId = QStringLiteral("segment%1").arg(i);
+        QDomElement producer = doc.createElement(QStringLiteral("producer"));
+        producer.setAttribute(QStringLiteral("id"), segmentId);
+        Xml::setXmlProperty(producer, QStringLiteral("resource"), segments.at(i));
+        Xml::setXmlProperty(producer, QStringLiteral("mlt_service"), QStringLiteral("avformat"));
+        mlt.appendChild(producer);
+        if (range.x() > position) {
+            QDomElement blank = doc.createElement(QStringLiteral("blank"));
+            blank.setAttribute(QStringLiteral("length"), range.x() - position);
+            playlist.appendChild(blank);
+        }
+        QDomElement entry = doc.createElement(QStringLiteral("entry"));
+        entry.setAttribute(QStringLiteral("producer"), segmentId);
+        entry.setAttribute(QStringLiteral("in"), 0);
+        entry.setAttribute(QStringLiteral("out"), range.y() - range.x());
+        playlist.appendChild(entry);
+        position = range.y() + 1;
+    }
+    if (position < length) {
+        QDomElement blank = doc.createElement(QStringLiteral("blank"));
+        blank.setAttribute(QStringLiteral("length"), length - position);
+        playlist.appendChild(blank);
+    }
+    mlt.appendChild(playlist);
+    QFile file(dest);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QTextStream out(&file);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    out.setCodec("UTF-8");
+#endif
+    out << doc.toString();
+    file.close();
+
+    // Remove the segments of previous ranges
+    const QStringList previousSegments = dir.entryList({QStringLiteral("%1-*.%2").arg(hash, extension)}, QDir::Files);
+    for (const QString &segment : previousSegments) {
+        if (!segments.contains(segment)) {
+            QFile::remove(dir.absoluteFilePath(segment));
+        }
+    }
+    return true;
+}
+
 void ProxyTask::processLogInfo()
 {
     const QString buffer = QString::fromUtf8(m_jobProcess->readAllStandardError());
@@ -448,7 +772,7 @@ void ProxyTask::processLogInfo()
                     progress = numbers.at(0).toInt() * 3600 + numbers.at(1).toInt() * 60 + qRound(numbers.at(2).toDouble());
                 }
             }
-            int val = 100 * progress / m_jobDuration;
+            int val = qMin(100, 100 * (m_doneDuration + progress) / m_jobDuration);
             if (m_progress != val) {
                 m_progress = val;
                 QMetaObject::invokeMethod(m_object, "updateJobProgress");
@@ -8,13 +8,40 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstracttask.h"
 
+#include <QPoint>
+#include <QStringList>
+#include <QVector>
+
 class QProcess;
 
+namespace Mlt {
+class Properties;
+}
+
 class ProxyTask : public AbstractTask
 {
 public:
     ProxyTask(const ObjectId &owner, QObject* object);
     static void start(const ObjectId &owner, QObject* object, bool force = false);
+    /** @brief Returns true if @param path is a proxy that only contains the parts of its clip used in the timelines.
+     *  Such a proxy is a playlist placing one file per used range at its original position, so that it can replace the clip
+     *  without any change to the in and out points. The ranges it contains are stored in the kdenlive:proxyranges property. */
+    static bool isRangeProxy(const QString &path);
+    /** @brief Sort ranges of frames, extend them by @param handles frames inside a clip of @param length frames and merge those that overlap or are
+     *  separated by less than @param handles frames */
+    static QVector<QPoint> mergeRanges(QVector<QPoint> ranges, int handles, int length);
+    /** @brief Returns true if each range of @param used is inside a range of @param covered */
+    static bool coversRanges(const QVector<QPoint> &covered, const QVector<QPoint> &used);
+    static QString rangesToString(const QVector<QPoint> &ranges);
+    static QVector<QPoint> rangesFromString(const QString &ranges);
+    /** @brief Returns the absolute paths of the segment files used by the range proxy @param path */
+    static QStringList rangeProxySegments(const QString &path);
+    /** @brief The xml producer of a range proxy has no stream info. Copy the meta.media properties of its first segment, which keeps all the streams
+     *  of the clip, to @param properties. The audio_index and video_index properties are only set if missing. */
+    static void passRangeProxyStreams(const QString &path, Mlt::Properties &properties);
+    /** @brief Returns the playlist of the range proxy @param path with absolute segment paths, each segment playing the audio stream @param audioIndex.
+     *  The xml producer ignores the stream properties, so they have to be set on the segments. */
+    static QString rangeProxyXml(const QString &path, int audioIndex, int astream);
 
 protected:
     void run() override;
@@ -23,7 +50,16 @@ private Q_SLOTS:
     void processLogInfo();
 
 private:
+    /** @brief Encode each range of m_ranges with the FFmpeg @param parameters and write the playlist @param dest placing them in a clip of @param length
+     *  frames. If @param reuseSegments is true, the ranges already encoded by a previous build are kept. */
+    bool encodeRanges(const QStringList &parameters, const QString &source, const QString &dest, int length, bool reuseSegments);
     int m_jobDuration;
+    /** @brief The seconds already encoded by the previous processes of the task */
+    int m_doneDuration;
+    /** @brief The frames to encode for a range proxy */
+    QVector<QPoint> m_ranges;
+    /** @brief The number of frames transcoded by the task, to measure its speed */
+    int m_encodedFrames;
     bool m_isFfmpegJob;
     std::unique_ptr<QProcess> m_jobProcess;
     QString m_errorMessage;
@@ -267,6 +267,58 @@ void TaskManager::slotCancelJobs(bool leaveBlocked, const QVector<AbstractTask::
     }
 }
 
+int TaskManager::transcodeThreadBudget() const
+{
+    int jobs = 0;
+    {
+        QReadLocker lk(&m_tasksListLock);
+        for (const auto &tasks : m_taskList) {
+            for (AbstractTask *t : tasks.second) {
+                if ((t->m_type == AbstractTask::TRANSCODEJOB || t->m_type == AbstractTask::PROXYJOB) && !t->isCanceled()) {
+                    jobs++;
+                }
+            }
+        }
+    }
+    // Only the jobs that can run at the same time share the cores
+    jobs = qBound(1, jobs, qMax(1, m_transcodePool.maxThreadCount()));
+    return qMax(1, QThread::idealThreadCount() / jobs);
+}
+
+void TaskManager::recordTranscodeSpeed(const QString &key, double fps)
+{
+    if (fps <= 0.) {
+        return;
+    }
+    QMutexLocker lock(&m_transcodeSpeedsMutex);
+    auto speed = m_transcodeSpeeds.find(key);
+    if (speed == m_transcodeSpeeds.end()) {
+        m_transcodeSpeeds.insert(key, fps);
+    } else {
+        // Favor the recent jobs, which ran with the current settings and load
+        speed.value() = (speed.value() + fps) / 2.;
+    }
+}
+
+double TaskManager::estimatedTranscodeTime(const QString &key, int frames) const
+{
+    QMutexLocker lock(&m_transcodeSpeedsMutex);
+    double fps = m_transcodeSpeeds.value(key);
+    if (fps <= 0. && !m_transcodeSpeeds.isEmpty()) {
+        // Unknown kind of source, use the average of the known ones
+        fps = 0.;
+        for (double speed : m_transcodeSpeeds) {
+            fps += speed;
+        }
+        fps /= m_transcodeSpeeds.size();
+    }
+    if (fps <= 0.) {
+        // Nothing transcoded yet, the number of frames still orders the jobs
+        fps = 25.;
+    }
+    return frames / fps;
+}
+
 void TaskManager::unBlock()
 {
     m_blockUpdates = false;
@@ -13,6 +13,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <QAbstractListModel>
 #include <QFutureWatcher>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QReadWriteLock>
 #include <QThreadPool>
@@ -65,6 +67,16 @@ public:
     /** @brief Update the number of concurrent jobs allowed */
     void updateConcurrency();
 
+    /** @brief The number of threads a transcoding process should use, so that the concurrent proxy and transcoding jobs share the cores */
+    int transcodeThreadBudget() const;
+
+    /** @brief Record the speed of a proxy transcoding, in frames per second, for the sources described by @param key */
+    void recordTranscodeSpeed(const QString &key, double fps);
+
+    /** @brief The expected time in seconds to transcode @param frames frames of a source described by @param key.
+     *  It is based on the previous transcodings of similar sources and is used to start the shortest jobs first. */
+    double estimatedTranscodeTime(const QString &key, int frames) const;
+
     /** @brief We are aborting all tasks and don't want them to send any updates */
     bool isBlocked() const;
 
@@ -81,6 +93,9 @@ public Q_SLOTS:
 private:
     QThreadPool m_taskPool;
     QThreadPool m_transcodePool;
+    /** @brief The average transcoding speed by source codec and frame size */
+    QHash<QString, double> m_transcodeSpeeds;
+    mutable QMutex m_transcodeSpeedsMutex;
     std::unordered_map<int, std::vector<AbstractTask*> > m_taskList;
     mutable QReadWriteLock m_tasksListLock;
     bool m_blockUpdates;
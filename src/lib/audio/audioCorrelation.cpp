@@ -8,10 +8,18 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "kdenlive_debug.h"
 #include "klocalizedstring.h"
-#include <QElapsedTimer>
+#include "utils/trace.h"
+#include <QtConcurrent>
 #include <cmath>
 #include <iostream>
 
+// Number of fine envelope values per frame used to refine the alignment
+#define BLOCKS_PER_FRAME 32
+// Maximum number of frames decoded to refine the alignment
+#define REFINE_FRAMES 250
+// Minimum overlap, in frames, to refine the alignment or compute its confidence
+#define MIN_OVERLAP_FRAMES 25
+
 AudioCorrelation::AudioCorrelation(std::unique_ptr<AudioEnvelope> mainTrackEnvelope)
     : m_mainTrackEnvelope(std::move(mainTrackEnvelope))
 {
@@ -22,6 +30,13 @@ AudioCorrelation::AudioCorrelation(std::unique_ptr<AudioEnvelope> mainTrackEnvel
 
 AudioCorrelation::~AudioCorrelation()
 {
+    for (QFutureWatcher<Alignment> *watcher : qAsConst(m_watchers)) {
+        watcher->waitForFinished();
+        delete watcher->result().info;
+    }
+    for (AudioEnvelope *envelope : qAsConst(m_pending)) {
+        delete envelope;
+    }
     for (AudioEnvelope *envelope : qAsConst(m_children)) {
         delete envelope;
     }
@@ -43,6 +58,7 @@ void AudioCorrelation::addChild(AudioEnvelope *envelope)
     // there is no race condition where the signal 'envelopeReady' is
     // lost.
     Q_ASSERT(!envelope->hasComputationStarted());
+    m_pending.append(envelope);
     connect(envelope, &AudioEnvelope::envelopeReady, this, &AudioCorrelation::slotProcessChild);
     envelope->startComputeEnvelope();
 }
@@ -50,32 +66,123 @@ void AudioCorrelation::addChild(AudioEnvelope *envelope)
 void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
 {
     // Note that at this point the computation of the envelope of the
-    // main track might not be finished. envelope() will block until
-    // the computation is done.
-    const size_t sizeMain = m_mainTrackEnvelope->envelope().size();
-    const size_t sizeSub = envelope->envelope().size();
+    // main track might not be finished, the worker will wait for it.
+    auto *watcher = new QFutureWatcher<Alignment>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, envelope]() {
+        const Alignment result = watcher->result();
+        m_watchers.removeAll(watcher);
+        watcher->deleteLater();
+        m_pending.removeAll(envelope);
+        m_children.append(envelope);
+        m_correlations.append(result.info);
+        m_lags.append(result.lag);
 
-    auto *info = new AudioCorrelationInfo(sizeMain, sizeSub);
-    qint64 *correlation = info->correlationVector();
+        Q_ASSERT(m_correlations.size() == m_children.size());
+        int index = m_children.indexOf(envelope);
+        int shift = getShift(index);
+        Q_EMIT gotAudioAlignData(envelope->clipId(), shift, result.confidence);
+    });
+    m_watchers.append(watcher);
+    watcher->setFuture(QtConcurrent::run([this, envelope]() { return computeAlignment(envelope); }));
+}
 
+AudioCorrelation::Alignment AudioCorrelation::computeAlignment(AudioEnvelope *envelope)
+{
+    // Blocks until the envelopes are computed.
     const std::vector<qint64> &envMain = m_mainTrackEnvelope->envelope();
     const std::vector<qint64> &envSub = envelope->envelope();
-    qint64 max = 0;
+    const size_t sizeMain = envMain.size();
+    const size_t sizeSub = envSub.size();
 
+    Alignment result;
+    result.info = new AudioCorrelationInfo(sizeMain, sizeSub);
+    if (sizeMain == 0 || sizeSub == 0) {
+        return result;
+    }
+    qint64 *correlation = result.info->correlationVector();
     if (sizeSub > 200) {
         FFTCorrelation::correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation);
     } else {
+        qint64 max = 0;
         correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation, &max);
-        info->setMax(max);
+        result.info->setMax(max);
+    }
+    const int lag = int(result.info->maxIndex()) - int(sizeSub);
+    result.lag = lag;
+    result.confidence = confidence(&envMain[0], sizeMain, &envSub[0], sizeSub, lag);
+
+    // Refine around the best frame: decode a part of the overlapping zone, with one frame of margin on each side in the main track
+    const int first = qMax(0, 1 - lag);
+    const int last = qMin(int(sizeSub), int(sizeMain) - lag - 1);
+    const int frames = qMin(last - first, REFINE_FRAMES);
+    if (frames >= MIN_OVERLAP_FRAMES) {
+        const int start = first + (last - first - frames) / 2;
+        const std::vector<float> subFine = envelope->fineEnvelope(size_t(start), size_t(frames), BLOCKS_PER_FRAME);
+        const std::vector<float> mainFine = m_mainTrackEnvelope->fineEnvelope(size_t(start + lag - 1), size_t(frames + 2), BLOCKS_PER_FRAME);
+        result.lag = lag - 1 + refineLag(mainFine, subFine, BLOCKS_PER_FRAME);
     }
+    qCDebug(KDENLIVE_LOG) << "Clip" << envelope->clipId() << "aligned at" << result.lag << "frames, confidence" << result.confidence;
+    return result;
+}
 
-    m_children.append(envelope);
-    m_correlations.append(info);
+double AudioCorrelation::confidence(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, int lag)
+{
+    const int first = qMax(0, -lag);
+    const int last = qMin(int(sizeSub), int(sizeMain) - lag);
+    if (last - first < MIN_OVERLAP_FRAMES) {
+        return 0.;
+    }
+    double sumMain = 0.;
+    double sumSub = 0.;
+    double sumMain2 = 0.;
+    double sumSub2 = 0.;
+    double sumProduct = 0.;
+    for (int i = first; i < last; ++i) {
+        const double x = double(envMain[i + lag]);
+        const double y = double(envSub[i]);
+        sumMain += x;
+        sumSub += y;
+        sumMain2 += x * x;
+        sumSub2 += y * y;
+        sumProduct += x * y;
+    }
+    const double n = last - first;
+    const double covariance = sumProduct - sumMain * sumSub / n;
+    const double varianceMain = sumMain2 - sumMain * sumMain / n;
+    const double varianceSub = sumSub2 - sumSub * sumSub / n;
+    if (varianceMain <= 0. || varianceSub <= 0.) {
+        return 0.;
+    }
+    return qBound(0., covariance / std::sqrt(varianceMain * varianceSub), 1.);
+}
 
-    Q_ASSERT(m_correlations.size() == m_children.size());
-    int index = m_children.indexOf(envelope);
-    int shift = getShift(index);
-    Q_EMIT gotAudioAlignData(envelope->clipId(), shift);
+double AudioCorrelation::refineLag(const std::vector<float> &main, const std::vector<float> &sub, int blocksPerFrame)
+{
+    const size_t range = size_t(2 * blocksPerFrame);
+    if (blocksPerFrame < 1 || sub.empty() || main.size() < sub.size() + range) {
+        return 1.;
+    }
+    std::vector<double> products(range + 1, 0.);
+    for (size_t offset = 0; offset <= range; ++offset) {
+        double sum = 0.;
+        const float *mainData = main.data() + offset;
+        for (size_t i = 0; i < sub.size(); ++i) {
+            sum += double(sub[i]) * double(mainData[i]);
+        }
+        products[offset] = sum;
+    }
+    const size_t best = size_t(std::max_element(products.begin(), products.end()) - products.begin());
+    double position = best;
+    if (best > 0 && best < range) {
+        // Parabolic interpolation of the peak
+        const double left = products[best - 1];
+        const double right = products[best + 1];
+        const double curvature = left - 2 * products[best] + right;
+        if (curvature < 0.) {
+            position += 0.5 * (left - right) / curvature;
+        }
+    }
+    return position / blocksPerFrame;
 }
 
 int AudioCorrelation::getShift(int childIndex) const
@@ -83,11 +190,7 @@ int AudioCorrelation::getShift(int childIndex) const
     Q_ASSERT(childIndex >= 0);
     Q_ASSERT(childIndex < m_correlations.size());
 
-    size_t indexOffset = m_correlations.at(childIndex)->maxIndex();
-    indexOffset -= m_children.at(childIndex)->envelope().size();
-    indexOffset += m_children.at(childIndex)->offset();
-
-    return int(indexOffset);
+    return qRound(m_lags.at(childIndex)) + int(m_children.at(childIndex)->offset());
 }
 
 AudioCorrelationInfo const *AudioCorrelation::info(int childIndex) const
@@ -123,8 +226,7 @@ void AudioCorrelation::correlate(const qint64 *envMain, size_t sizeMain, const q
 
     */
 
-    QElapsedTimer t;
-    t.start();
+    KDENLIVE_TRACE("audio", "AudioCorrelation::correlate");
     for (size_t shift = -sizeSub; shift <= sizeMain; ++shift) {
 
         if (shift == 0) {
@@ -149,8 +251,6 @@ void AudioCorrelation::correlate(const qint64 *envMain, size_t sizeMain, const q
             max = sum;
         }
     }
-    qCDebug(KDENLIVE_LOG) << "Correlation calculated. Time taken: " << t.elapsed() << " ms.";
-
     if (out_max != nullptr) {
         *out_max = max;
     }
@@ -10,7 +10,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "audioCorrelationInfo.h"
 #include "audioEnvelope.h"
 #include "definitions.h"
+#include <QFutureWatcher>
 #include <QList>
+#include <vector>
 
 /**
   This class does the correlation between two tracks
@@ -18,6 +20,12 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
   It uses one main track (used in the initializer); further tracks will be
   aligned relative to this main track.
+
+  The alignment of each child runs in a worker thread, so that several
+  children are correlated concurrently. The frame envelopes are correlated
+  first, then the position is refined around the best match with envelopes
+  of about one value per millisecond, so that the result is rounded to the
+  nearest frame instead of being off by one.
   */
 class AudioCorrelation : public QObject
 {
@@ -58,11 +66,38 @@ public:
       */
     static void correlate(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, qint64 *out_max = nullptr);
 
+    /**
+      Returns the correlation coefficient (between 0 and 1) of the overlapping
+      parts of envMain and envSub when envSub starts at index \c lag of envMain.
+      */
+    static double confidence(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, int lag);
+
+    /**
+      Returns the offset, in frames, at which the fine envelope \c sub best
+      matches \c main. \c main must have 2 * \c blocksPerFrame more values than
+      \c sub, the result is between 0 and 2.
+      */
+    static double refineLag(const std::vector<float> &main, const std::vector<float> &sub, int blocksPerFrame);
+
 private:
+    struct Alignment
+    {
+        AudioCorrelationInfo *info = nullptr;
+        /** @brief Position of the child start in the main envelope, in frames */
+        double lag = 0.;
+        double confidence = 0.;
+    };
     std::unique_ptr<AudioEnvelope> m_mainTrackEnvelope;
 
     QList<AudioEnvelope *> m_children;
     QList<AudioCorrelationInfo *> m_correlations;
+    QList<double> m_lags;
+    /** @brief Children added and not aligned yet */
+    QList<AudioEnvelope *> m_pending;
+    QList<QFutureWatcher<Alignment> *> m_watchers;
+
+    /** @brief Coarse to fine alignment of @p envelope on the main envelope, runs in a worker thread */
+    Alignment computeAlignment(AudioEnvelope *envelope);
 
 private Q_SLOTS:
     /**
@@ -76,6 +111,7 @@ private Q_SLOTS:
     void slotAnnounceEnvelope();
 
 Q_SIGNALS:
-    void gotAudioAlignData(int, int);
+    /** @brief The child of @p clipId should be moved by @p shift frames, @p confidence is between 0 and 1 */
+    void gotAudioAlignData(int clipId, int shift, double confidence);
     void displayMessage(const QString &, MessageType, int);
 };
@@ -11,12 +11,97 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "bin/projectclip.h"
 #include "core.h"
 #include "kdenlive_debug.h"
+#include "utils/trace.h"
 #include <KLocalizedString>
-#include <QElapsedTimer>
+#include <QCache>
 #include <QImage>
+#include <QMutex>
+#include <QThread>
 #include <QtConcurrent>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <numeric>
+
+// Minimum number of frames decoded by a thread when the envelope is computed in parallel
+#define MIN_SEGMENT_FRAMES 500
+
+namespace {
+struct CachedEnvelope
+{
+    std::vector<qint64> audioAmplitudes;
+    qint64 amplitudeMax = 0;
+};
+QMutex envelopeCacheMutex;
+// The cost of an entry is its number of frames, the cache holds about 40 hours at 25 fps
+QCache<QString, CachedEnvelope> envelopeCache(3600000);
+
+bool isEnvelopeCached(const QString &key)
+{
+    QMutexLocker lock(&envelopeCacheMutex);
+    return envelopeCache.contains(key);
+}
+
+/** @brief Convert the peak @param peak of a channel (16 bit sample range) to an audio thumbnail level.
+ *  This matches the audiolevel filter (IEC scale) and the quantization of AudioLevelsTask (multiplied by 0.9 and stored on 8 bits),
+ *  so that a decoded envelope is identical to one built from the cached levels.
+ */
+uint8_t amplitudeToLevel(int peak)
+{
+    if (peak <= 0) {
+        return 0;
+    }
+    const double db = 20. * std::log10(peak / 32768.);
+    double scale;
+    if (db < -70.) {
+        scale = 0.;
+    } else if (db < -60.) {
+        scale = (db + 70.) * 0.0025;
+    } else if (db < -50.) {
+        scale = (db + 60.) * 0.005 + 0.025;
+    } else if (db < -40.) {
+        scale = (db + 50.) * 0.0075 + 0.075;
+    } else if (db < -30.) {
+        scale = (db + 40.) * 0.015 + 0.15;
+    } else if (db < -20.) {
+        scale = (db + 30.) * 0.02 + 0.3;
+    } else {
+        scale = (db + 20.) * 0.025 + 0.5;
+    }
+    return uint8_t(qMin(255., 256. * qMin(scale * 0.9, 1.)));
+}
+
+/** @brief Convert an audio thumbnail level to a linear amplitude in the 16 bit sample range.
+ *  The levels are the IEC scaled peak values of the audiolevel filter (multiplied by 0.9 and stored on 8 bits),
+ *  so this reverses the IEC scale to get a linear envelope.
+ */
+qint64 levelToAmplitude(uint8_t level)
+{
+    static const std::vector<qint64> table = []() {
+        std::vector<qint64> values(256, 0);
+        for (int i = 1; i < 256; ++i) {
+            const double scale = qMin(1., i / 256. / 0.9);
+            double db;
+            if (scale < 0.025) {
+                db = scale / 0.0025 - 70;
+            } else if (scale < 0.075) {
+                db = (scale - 0.025) / 0.005 - 60;
+            } else if (scale < 0.15) {
+                db = (scale - 0.075) / 0.0075 - 50;
+            } else if (scale < 0.3) {
+                db = (scale - 0.15) / 0.015 - 40;
+            } else if (scale < 0.5) {
+                db = (scale - 0.3) / 0.02 - 30;
+            } else {
+                db = (scale - 0.5) / 0.025 - 20;
+            }
+            values[size_t(i)] = qRound64(32767. * std::pow(10., db / 20.));
+        }
+        return values;
+    }();
+    return table[level];
+}
+} // namespace
 
 AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, size_t offset, size_t length, size_t startPos)
     : m_offset(offset)
@@ -25,10 +110,12 @@ AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, size_t offset, si
 {
     std::shared_ptr<ProjectClip> clip = pCore->bin()->getBinClip(binId);
     m_producer = clip->cloneProducer();
+    int in = 0;
     if (length > 2000) {
         // Analyze on timeline clip zone only
         m_offset = 0;
-        m_producer->set_in_and_out(int(offset), int(offset + length));
+        in = int(offset);
+        m_producer->set_in_and_out(in, int(offset + length));
     }
     m_envelopeSize = size_t(m_producer->get_playtime());
 
@@ -36,8 +123,35 @@ AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, size_t offset, si
     connect(&m_watcher, &QFutureWatcherBase::finished, this, [this] { Q_EMIT envelopeReady(this); });
     if (!m_producer || !m_producer->is_valid()) {
         qCDebug(KDENLIVE_LOG) << "// Cannot create envelope for producer: " << binId;
-    } else {
-        m_info = std::make_unique<AudioInfo>(m_producer);
+        return;
+    }
+    m_info = std::make_unique<AudioInfo>(m_producer);
+    m_cacheKey = QStringLiteral("%1:%2:%3").arg(clip->hash()).arg(in).arg(m_envelopeSize);
+    if (isEnvelopeCached(m_cacheKey)) {
+        return;
+    }
+    if (clip->audioInfo()) {
+        const int stream = clip->audioInfo()->ffmpeg_audio_index();
+        m_levelsChannels = clip->audioInfo()->channelsForStream(stream);
+        m_levels = clip->audioFrameCache(stream);
+        if (m_levelsChannels < 1 || size_t(m_levels.size()) < (size_t(in) + m_envelopeSize) * size_t(m_levelsChannels)) {
+            // Levels are missing or still being computed
+            m_levels.clear();
+        }
+    }
+    if (m_levels.isEmpty()) {
+        const int segments = qMax(1, qMin(QThread::idealThreadCount(), int(m_envelopeSize / MIN_SEGMENT_FRAMES)));
+        for (int i = 1; i < segments; ++i) {
+            std::shared_ptr<Mlt::Producer> prod = clip->cloneProducer();
+            if (!prod || !prod->is_valid()) {
+                break;
+            }
+            if (in > 0) {
+                prod->set_in_and_out(in, int(offset + length));
+            }
+            prod->set("set.test_image", 1);
+            m_segmentProducers.push_back(prod);
+        }
     }
 }
 
@@ -102,30 +216,25 @@ AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
     if (!m_info || m_info->size() < 1) {
         return summary;
     }
-    int samplingRate = m_info->info(0)->samplingRate();
-    mlt_audio_format format_s16 = mlt_audio_s16;
-    int channels = 1;
-
-    QElapsedTimer t;
-    t.start();
-    m_producer->seek(0);
-    size_t max = summary.audioAmplitudes.size();
-    for (size_t i = 0; i < max; ++i) {
-        std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame(int(i)));
-        qint64 position = mlt_frame_get_position(frame->get_frame());
-        int samples = mlt_audio_calculate_frame_samples(float(m_producer->get_fps()), samplingRate, position);
-        auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
+    if (!m_cacheKey.isEmpty()) {
+        QMutexLocker lock(&envelopeCacheMutex);
+        CachedEnvelope *cached = envelopeCache.object(m_cacheKey);
+        if (cached) {
+            summary.audioAmplitudes = cached->audioAmplitudes;
+            summary.amplitudeMax = cached->amplitudeMax;
+            return summary;
+        }
+    }
 
-        summary.audioAmplitudes[i] = 0;
-        for (int k = 0; k < samples; ++k) {
-            summary.audioAmplitudes[i] += abs(data[k]);
+    {
+        KDENLIVE_TRACE("audio", "AudioEnvelope::loadEnvelope");
+        if (!envelopeFromLevels(summary)) {
+            decodeEnvelope(summary);
         }
-        pCore->displayMessage(i18n("Processing data analysis"), ProcessingJobMessage, int(100 * i / max));
     }
-    qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took " << t.elapsed() << " ms.";
     qCDebug(KDENLIVE_LOG) << "Normalizing envelope …";
-    const qint64 meanBeforeNormalization =
-        std::accumulate(summary.audioAmplitudes.begin(), summary.audioAmplitudes.end(), 0LL) / qint64(summary.audioAmplitudes.size());
+    size_t max = summary.audioAmplitudes.size();
+    const qint64 meanBeforeNormalization = max == 0 ? 0 : std::accumulate(summary.audioAmplitudes.begin(), summary.audioAmplitudes.end(), 0LL) / qint64(max);
 
     // Normalize the envelope.
     summary.amplitudeMax = 0;
@@ -133,10 +242,128 @@ AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
         summary.audioAmplitudes[i] -= meanBeforeNormalization;
         summary.amplitudeMax = std::max(summary.amplitudeMax, qAbs(summary.audioAmplitudes[i]));
     }
+    if (!m_cacheKey.isEmpty() && max > 0) {
+        auto *cached = new CachedEnvelope;
+        cached->audioAmplitudes = summary.audioAmplitudes;
+        cached->amplitudeMax = summary.amplitudeMax;
+        QMutexLocker lock(&envelopeCacheMutex);
+        envelopeCache.insert(m_cacheKey, cached, int(max));
+    }
     pCore->displayMessage(i18n("Audio analysis finished"), OperationCompletedMessage, 300);
     return summary;
 }
 
+bool AudioEnvelope::envelopeFromLevels(AudioSummary &summary) const
+{
+    if (m_levels.isEmpty()) {
+        return false;
+    }
+    const size_t channels = size_t(m_levelsChannels);
+    const size_t in = size_t(m_producer->get_in());
+    const size_t max = summary.audioAmplitudes.size();
+    if (size_t(m_levels.size()) < (in + max) * channels) {
+        return false;
+    }
+    const uint8_t *levels = m_levels.constData() + in * channels;
+    for (size_t i = 0; i < max; ++i) {
+        qint64 amplitude = 0;
+        for (size_t k = 0; k < channels; ++k) {
+            amplitude += levelToAmplitude(levels[i * channels + k]);
+        }
+        summary.audioAmplitudes[i] = amplitude;
+    }
+    return true;
+}
+
+void AudioEnvelope::decodeEnvelope(AudioSummary &summary) const
+{
+    const int samplingRate = m_info->info(0)->samplingRate();
+    const int streamChannels = qMax(1, m_info->info(0)->channels());
+    const size_t max = summary.audioAmplitudes.size();
+    std::vector<std::shared_ptr<Mlt::Producer>> producers{m_producer};
+    producers.insert(producers.end(), m_segmentProducers.begin(), m_segmentProducers.end());
+    const size_t segments = producers.size();
+    std::atomic<size_t> processed(0);
+    std::atomic<int> progress(-1);
+
+    auto decodeSegment = [&](size_t segment) {
+        const std::shared_ptr<Mlt::Producer> &producer = producers[segment];
+        const size_t start = max * segment / segments;
+        const size_t end = max * (segment + 1) / segments;
+        mlt_audio_format format_s16 = mlt_audio_s16;
+        producer->seek(int(start));
+        for (size_t i = start; i < end; ++i) {
+            std::unique_ptr<Mlt::Frame> frame(producer->get_frame());
+            qint64 position = mlt_frame_get_position(frame->get_frame());
+            int channels = streamChannels;
+            int samples = mlt_audio_calculate_frame_samples(float(producer->get_fps()), samplingRate, position);
+            auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
+
+            // Use the same measure as the cached levels: the peak of each channel on the IEC scale
+            qint64 amplitude = 0;
+            for (int c = 0; data != nullptr && c < channels; ++c) {
+                int peak = 0;
+                for (int k = 0; k < samples; ++k) {
+                    peak = qMax(peak, abs(data[k * channels + c]));
+                }
+                amplitude += levelToAmplitude(amplitudeToLevel(peak));
+            }
+            summary.audioAmplitudes[i] = amplitude;
+            // Only report progress when the percentage changes
+            const int percent = int(100 * ++processed / max);
+            if (progress.exchange(percent) != percent) {
+                pCore->displayMessage(i18n("Processing data analysis"), ProcessingJobMessage, percent);
+            }
+        }
+    };
+
+    QList<QFuture<void>> futures;
+    for (size_t segment = 1; segment < segments; ++segment) {
+        futures << QtConcurrent::run(decodeSegment, segment);
+    }
+    decodeSegment(0);
+    for (auto &future : futures) {
+        future.waitForFinished();
+    }
+}
+
+std::vector<float> AudioEnvelope::fineEnvelope(size_t startFrame, size_t frames, int blocksPerFrame)
+{
+    std::vector<float> values(frames * size_t(qMax(0, blocksPerFrame)), 0.f);
+    if (!m_info || m_info->size() < 1 || values.empty()) {
+        return values;
+    }
+    QMutexLocker lock(&m_producerMutex);
+    const int samplingRate = m_info->info(0)->samplingRate();
+    mlt_audio_format format_s16 = mlt_audio_s16;
+    m_producer->seek(int(startFrame));
+    for (size_t i = 0; i < frames; ++i) {
+        std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame());
+        int channels = 1;
+        qint64 position = mlt_frame_get_position(frame->get_frame());
+        int samples = mlt_audio_calculate_frame_samples(float(m_producer->get_fps()), samplingRate, position);
+        auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
+        if (data == nullptr) {
+            continue;
+        }
+        for (int block = 0; block < blocksPerFrame; ++block) {
+            const int first = samples * block / blocksPerFrame;
+            const int last = samples * (block + 1) / blocksPerFrame;
+            float sum = 0.f;
+            for (int k = first; k < last; ++k) {
+                sum += float(abs(data[k]));
+            }
+            // Blocks don't all have the same number of samples, use the mean
+            values[i * size_t(blocksPerFrame) + size_t(block)] = sum / float(qMax(1, last - first));
+        }
+    }
+    const float mean = std::accumulate(values.begin(), values.end(), 0.f) / float(values.size());
+    for (float &value : values) {
+        value -= mean;
+    }
+    return values;
+}
+
 int AudioEnvelope::clipId() const
 {
     return m_clipId;
@@ -9,7 +9,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "audioInfo.h"
 #include <QFutureWatcher>
+#include <QMutex>
 #include <QObject>
+#include <QVector>
 #include <memory>
 #include <mlt++/Mlt.h>
 #include <vector>
@@ -18,8 +20,15 @@ class QImage;
 
 /**
   The audio envelope is a simplified version of an audio track
-  with frame resolution. One entry is calculated by the sum
-  of the absolute values of all samples in the current frame.
+  with frame resolution. One entry is the sum over the channels
+  of the peak amplitude of the current frame, measured like the
+  audio thumbnail levels (IEC scale, 8 bit).
+
+  When the audio levels of the clip were already computed for
+  the audio thumbnails, the envelope is built from them instead
+  of decoding the clip again. Otherwise the clip is decoded in
+  parallel segments. Envelopes are cached by clip hash and zone,
+  so that aligning several times against the same clip is cheap.
 
   See also: http://web.archive.org/web/20180626235917/http://bemasc.net/wordpress/2011/07/26/an-auto-aligner-for-pitivi/
   */
@@ -49,6 +58,16 @@ public:
     */
     const std::vector<qint64> &envelope();
 
+    /**
+       Returns a finer envelope of @p frames frames starting at frame
+       @p startFrame of the analyzed zone, with @p blocksPerFrame
+       values per frame. Each value is the mean absolute sample value
+       of its block, and the mean of the values is removed.
+       Decodes the clip, so it must not be called from the GUI thread.
+       REQUIRES: the envelope computation is finished.
+    */
+    std::vector<float> fineEnvelope(size_t startFrame, size_t frames, int blocksPerFrame);
+
     QImage drawEnvelope();
 
     size_t offset();
@@ -67,8 +86,8 @@ private:
         }
         AudioSummary() = default;
         // This is the envelope data. There is one element for each
-        // frame, which contains the sum of the absolute amplitudes of
-        // the audio signal for that frame.
+        // frame, which contains the sum of the channel peak amplitudes
+        // of the audio signal for that frame.
         std::vector<qint64> audioAmplitudes;
         // Maximum absolute value of the elements in 'audioAmplitudes'.
         qint64 amplitudeMax = 0;
@@ -84,8 +103,21 @@ private:
      Actually computes the envelope data, synchronously.
     */
     AudioSummary loadAndNormalizeEnvelope() const;
+    /** @brief Fill the envelope from the cached audio levels, returns false if they don't cover the analyzed zone */
+    bool envelopeFromLevels(AudioSummary &summary) const;
+    /** @brief Fill the envelope by decoding the clip, one segment per producer */
+    void decodeEnvelope(AudioSummary &summary) const;
 
     std::shared_ptr<Mlt::Producer> m_producer;
+    /** @brief Serializes the fine envelope requests, which all use m_producer */
+    QMutex m_producerMutex;
+    /** @brief Additional producers decoding the following segments of the clip in parallel */
+    std::vector<std::shared_ptr<Mlt::Producer>> m_segmentProducers;
+    /** @brief Audio levels computed for the thumbnails (one value per channel and frame) */
+    QVector<uint8_t> m_levels;
+    int m_levelsChannels = 0;
+    /** @brief Key of the envelope in the cache, empty if it should not be cached */
+    QString m_cacheKey;
     std::unique_ptr<AudioInfo> m_info;
     QFutureWatcher<AudioSummary> m_watcher;
     QFuture<AudioSummary> m_audioSummary;
@@ -4,10 +4,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "fftCorrelation.h"
+#include "fftTools.h"
 #include <QElapsedTimer>
-extern "C" {
-#include "../external/kiss_fft/tools/kiss_fftr.h"
-}
 
 #include "kdenlive_debug.h"
 #include <algorithm>
@@ -87,23 +85,23 @@ void FFTCorrelation::convolve(const float *left, const size_t leftSize, const fl
     }
 
     const size_t fft_size = size / 2 + 1;
-    kiss_fftr_cfg fftConfig = kiss_fftr_alloc(int(size), 0, nullptr, nullptr);
-    kiss_fftr_cfg ifftConfig = kiss_fftr_alloc(int(size), 1, nullptr, nullptr);
-    std::vector<kiss_fft_cpx> leftFFT(fft_size);
-    std::vector<kiss_fft_cpx> rightFFT(fft_size);
-    std::vector<kiss_fft_cpx> correlatedFFT(fft_size);
+    const FFTPlanPtr fftPlan = FFTTools::plan(int(size));
+    const FFTPlanPtr ifftPlan = FFTTools::plan(int(size), true);
+    FFTBuffer<kiss_fft_cpx> leftFFT(fft_size);
+    FFTBuffer<kiss_fft_cpx> rightFFT(fft_size);
+    FFTBuffer<kiss_fft_cpx> correlatedFFT(fft_size);
 
     // Fill in the data into our new vectors with padding
-    std::vector<float> leftData(size, 0);
-    std::vector<float> rightData(size, 0);
-    std::vector<float> convolved(size);
+    FFTBuffer<float> leftData(size, 0);
+    FFTBuffer<float> rightData(size, 0);
+    FFTBuffer<float> convolved(size);
 
     std::copy(left, left + leftSize, leftData.begin());
     std::copy(right, right + rightSize, rightData.begin());
 
     // Fourier transformation of the vectors
-    kiss_fftr(fftConfig, &leftData[0], &leftFFT[0]);
-    kiss_fftr(fftConfig, &rightData[0], &rightFFT[0]);
+    fftPlan->forward(leftData.data(), leftFFT.data());
+    fftPlan->forward(rightData.data(), rightFFT.data());
 
     // Convolution in spacial domain is a multiplication in fourier domain. O(n).
     for (size_t i = 0; i < correlatedFFT.size(); ++i) {
@@ -117,12 +115,8 @@ void FFTCorrelation::convolve(const float *left, const size_t leftSize, const fl
     *out_convolved = 0;
     size_t out_size = leftSize + rightSize + 1;
 
-    kiss_fftri(ifftConfig, &correlatedFFT[0], &convolved[0]);
+    ifftPlan->inverse(correlatedFFT.data(), convolved.data());
     std::copy(convolved.begin(), convolved.begin() + int(out_size) - 1, out_convolved + 1);
 
-    // Finally some cleanup.
-    kiss_fftr_free(fftConfig);
-    kiss_fftr_free(ifftConfig);
-
     qCDebug(KDENLIVE_LOG) << "FFT convolution computed. Time taken: " << time.elapsed() << " ms";
 }
@@ -7,6 +7,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "fftTools.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -21,26 +22,87 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <fstream>
 #endif
 
-FFTTools::FFTTools()
-    : m_fftCfgs()
-    , m_windowFunctions()
+FFTPlan::FFTPlan(int size, bool inverse)
+    : m_size(size)
+    , m_inverse(inverse)
 {
 }
-FFTTools::~FFTTools()
+
+FFTPlan::~FFTPlan()
 {
-    QHash<QString, kiss_fftr_cfg>::iterator i;
-    for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
-        free(*i);
+    for (kiss_fftr_cfg cfg : m_pool) {
+        kiss_fftr_free(cfg);
     }
 }
 
-const QString FFTTools::windowSignature(const WindowType windowType, const int size, const float param)
+int FFTPlan::size() const
+{
+    return m_size;
+}
+
+bool FFTPlan::isInverse() const
+{
+    return m_inverse;
+}
+
+kiss_fftr_cfg FFTPlan::acquire() const
 {
-    return QStringLiteral("s%1_t%2_p%3").arg(size).arg(windowType).arg(param, 0, 'f', 3);
+    {
+        QMutexLocker lock(&m_poolMutex);
+        if (!m_pool.empty()) {
+            kiss_fftr_cfg cfg = m_pool.back();
+            m_pool.pop_back();
+            return cfg;
+        }
+    }
+    // Another thread is using the plan (or this is the first use), create a configuration for us
+    return kiss_fftr_alloc(m_size, m_inverse ? 1 : 0, nullptr, nullptr);
 }
-const QString FFTTools::cfgSignature(const int size)
+
+void FFTPlan::release(kiss_fftr_cfg cfg) const
 {
-    return QStringLiteral("s%1").arg(size);
+    QMutexLocker lock(&m_poolMutex);
+    m_pool.push_back(cfg);
+}
+
+void FFTPlan::forward(const float *timeData, kiss_fft_cpx *freqData) const
+{
+    Q_ASSERT(!m_inverse);
+    kiss_fftr_cfg cfg = acquire();
+    kiss_fftr(cfg, timeData, freqData);
+    release(cfg);
+}
+
+void FFTPlan::inverse(const kiss_fft_cpx *freqData, float *timeData) const
+{
+    Q_ASSERT(m_inverse);
+    kiss_fftr_cfg cfg = acquire();
+    kiss_fftri(cfg, freqData, timeData);
+    release(cfg);
+}
+
+FFTTools::FFTTools()
+    : m_windowFunctions()
+{
+}
+
+FFTTools::~FFTTools() = default;
+
+FFTPlanPtr FFTTools::plan(const int size, const bool inverse)
+{
+    Q_ASSERT(size > 1 && (size & 1) == 0);
+    static QMutex plansMutex;
+    static QHash<int, FFTPlanPtr> plans;
+    // Inverse plans use negative keys
+    const int key = inverse ? -size : size;
+    QMutexLocker lock(&plansMutex);
+    auto it = plans.constFind(key);
+    if (it != plans.constEnd()) {
+        return *it;
+    }
+    FFTPlanPtr newPlan(new FFTPlan(size, inverse));
+    plans.insert(key, newPlan);
+    return newPlan;
 }
 
 // https://cplusplus.syntaxerrors.info/index.php?title=Cannot_declare_member_function_%E2%80%98static_int_Foo::bar%28%29%E2%80%99_to_have_static_linkage
@@ -105,141 +167,132 @@ const QVector<float> FFTTools::window(const WindowType windowType, const int siz
     return QVector<float>();
 }
 
-void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
-                             const uint windowSize, const float param)
+void FFTTools::preparePlan(const WindowType windowType, const uint windowSize, const float param)
 {
-#ifdef DEBUG_FFTTOOLS
-    QTime start = QTime::currentTime();
-#endif
-
-    const uint numSamples = uint(audioFrame.size()) / numChannels;
-
-    if (((windowSize & 1) != 0u) || windowSize < 2) {
+    // Look the caches up only when the parameters differ from the previous call
+    if (m_lastPlan && uint(m_lastPlan->size()) == windowSize && windowType == m_lastWindowType && qFuzzyCompare(param + 1, m_lastParam + 1)) {
         return;
     }
-
-    const QString cfgSig = cfgSignature(int(windowSize));
-    const QString winSig = windowSignature(windowType, int(windowSize), param);
-
-    // Get the kiss_fft configuration from the config cache
-    // or build a new configuration if the requested one is not available.
-    kiss_fftr_cfg myCfg;
-    if (m_fftCfgs.contains(cfgSig)) {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Re-using FFT configuration with size " << windowSize;
-#endif
-        myCfg = m_fftCfgs.value(cfgSig);
-    } else {
 #ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Creating FFT configuration with size " << windowSize;
+    qCDebug(KDENLIVE_LOG) << "Preparing FFT with size " << windowSize;
 #endif
-        myCfg = kiss_fftr_alloc(int(windowSize), 0, nullptr, nullptr);
-        m_fftCfgs.insert(cfgSig, myCfg);
-    }
+    m_lastPlan = plan(int(windowSize));
 
-    // Get the window function from the cache
-    // (except for a rectangular window; nothing to do there).
-    QVector<float> window;
-    float windowScaleFactor = 1;
+    // Nothing to do for a rectangular window
     if (windowType != FFTTools::Window_Rect) {
-
-        if (m_windowFunctions.contains(winSig)) {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Re-using window function with signature " << winSig;
-#endif
-            window = m_windowFunctions.value(winSig);
+        const quint64 key = (quint64(windowType) << 56) | (quint64(qRound(param * 1000.f)) & 0xffffffu) << 32 | quint64(windowSize);
+        auto it = m_windowFunctions.constFind(key);
+        if (it != m_windowFunctions.constEnd()) {
+            m_lastWindow = *it;
         } else {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Building new window function with signature " << winSig;
-#endif
-            window = FFTTools::window(windowType, int(windowSize), 0);
-            m_windowFunctions.insert(winSig, window);
+            m_lastWindow = FFTTools::window(windowType, int(windowSize), param);
+            m_windowFunctions.insert(key, m_lastWindow);
         }
-        windowScaleFactor = 1.0f / window[int(windowSize)];
+    } else {
+        m_lastWindow.clear();
+    }
+    m_lastWindowType = windowType;
+    m_lastParam = param;
+
+    // Prepare the buffers. The resulting FFT vector is only half as long
+    // (plus the Nyquist frequency, written by kiss_fftr).
+    if (m_fftInput.size() < size_t(windowSize)) {
+        m_fftInput.resize(size_t(windowSize));
+        m_fftOutput.resize(size_t(windowSize) / 2 + 1);
     }
+}
 
-    // Prepare frequency space vector. The resulting FFT vector is only half as long.
-    auto *freqData = new kiss_fft_cpx[size_t(windowSize) / 2];
-    auto *data = new float[size_t(windowSize)];
+void FFTTools::transformWindow(const qint16 *samples, const uint numSamples, const uint numChannels, float *freqSpectrum, const uint windowSize)
+{
+    float *data = m_fftInput.data();
+    kiss_fft_cpx *freqData = m_fftOutput.data();
+    const uint count = qMin(numSamples, windowSize);
 
-    // Copy the first channel's audio into a vector for the FFT display;
-    // Fill the data vector indices that cannot be covered with sample data with 0
-    if (numSamples < windowSize) {
-        std::fill(&data[numSamples], &data[windowSize - 1], 0);
-    }
-    // Normalize signals to [0,1] to get correct dB values later on
-    for (uint i = 0; i < numSamples && i < windowSize; ++i) {
-        // Performance note: Benchmarking has shown that using the if/else inside the loop
-        // does not do noticeable worse than keeping it outside (perhaps the branch predictor
-        // is good enough), so it remains in there for better readability.
-        if (windowType != FFTTools::Window_Rect) {
-            data[i] = float(audioFrame.data()[i * numChannels + channel]) / 32767.0f * window[int(i)];
-        } else {
-            data[i] = float(audioFrame.data()[i * numChannels + channel]) / 32767.0f;
+    // Normalize signals to [0,1] to get correct dB values later on, and
+    // fill the data vector indices that cannot be covered with sample data with 0
+    float windowScaleFactor = 1;
+    if (m_lastWindow.isEmpty()) {
+        for (uint i = 0; i < count; ++i) {
+            data[i] = float(samples[i * numChannels]) / 32767.0f;
+        }
+    } else {
+        const float *window = m_lastWindow.constData();
+        for (uint i = 0; i < count; ++i) {
+            data[i] = float(samples[i * numChannels]) / 32767.0f * window[i];
         }
+        windowScaleFactor = 1.0f / window[windowSize];
     }
+    std::fill(data + count, data + windowSize, 0.f);
 
     // Calculate the Fast Fourier Transform for the input data
-    kiss_fftr(myCfg, data, freqData);
+    m_lastPlan->forward(data, freqData);
 
     // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-    // with N = FFT size (after FFT, 1/2 window size)
+    // and N = FFT size (after FFT, 1/2 window size), computed as 10 * log(r² + i²) - 20 * log(N / 2 / scale)
+    const float offset = 20.f * log10f(float(windowSize) / 2.0f / windowScaleFactor);
     for (uint i = 0; i < windowSize / 2; ++i) {
-        // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-        // with N = FFT size (after FFT, 1/2 window size)
-        freqSpectrum[i] =
-            20 *
-            logf(powf(powf(fabs(freqData[i].r * windowScaleFactor), 2) + powf(fabs(freqData[i].i * windowScaleFactor), 2), .5) / (float(windowSize) / 2.0f)) /
-            logf(10);
-        ;
+        const float power = freqData[i].r * freqData[i].r + freqData[i].i * freqData[i].i;
+        freqSpectrum[i] = 10.f * log10f(power) - offset;
     }
+}
 
+void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
+                             const uint windowSize, const float param)
+{
 #ifdef DEBUG_FFTTOOLS
-    std::ofstream mFile;
-    mFile.open("/tmp/freq.m");
-    if (!mFile) {
-        qCDebug(KDENLIVE_LOG) << "Opening file failed.";
-    } else {
-        mFile << "val = [ ";
-
-        for (int sample = 0; sample < 256; ++sample) {
-            mFile << data[sample] << ' ';
-        }
-        mFile << " ];\n";
-
-        mFile << "freq = [ ";
-        for (int sample = 0; sample < 256; ++sample) {
-            mFile << freqData[sample].r << '+' << freqData[sample].i << "*i ";
-        }
-        mFile << " ];\n";
+    QTime start = QTime::currentTime();
+#endif
 
-        mFile.close();
-        qCDebug(KDENLIVE_LOG) << "File written.";
+    if (((windowSize & 1) != 0u) || windowSize < 2) {
+        return;
     }
-#endif
+    preparePlan(windowType, windowSize, param);
+    const uint numSamples = uint(audioFrame.size()) / numChannels;
+    transformWindow(audioFrame.constData() + channel, numSamples, numChannels, freqSpectrum, windowSize);
 
 #ifdef DEBUG_FFTTOOLS
     qCDebug(KDENLIVE_LOG) << "Calculated FFT in " << start.elapsed() << " ms.";
 #endif
-    delete[] freqData;
-    delete[] data;
+}
+
+void FFTTools::fftNormalizedBatch(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectra,
+                                  const WindowType windowType, const uint windowSize, const uint hopSize, const int windowCount, const float param)
+{
+    if (((windowSize & 1) != 0u) || windowSize < 2 || hopSize == 0) {
+        return;
+    }
+    // Plan, window function and buffers are shared by all windows of the batch
+    preparePlan(windowType, windowSize, param);
+    const uint numSamples = uint(audioFrame.size()) / numChannels;
+    for (int w = 0; w < windowCount; ++w) {
+        const uint first = uint(w) * hopSize;
+        const uint available = first < numSamples ? numSamples - first : 0;
+        transformWindow(audioFrame.constData() + size_t(first) * numChannels + channel, available, numChannels, freqSpectra + size_t(w) * (windowSize / 2),
+                        windowSize);
+    }
 }
 
 const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left, uint right, float fill)
+{
+    Q_ASSERT(targetSize > 0);
+    QVector<float> out(static_cast<int>(targetSize));
+    interpolatePeakPreserving(in.constData(), in.size(), out.data(), targetSize, left, right, fill);
+    return out;
+}
+
+void FFTTools::interpolatePeakPreserving(const float *in, const int inSize, float *out, const uint targetSize, uint left, uint right, float fill)
 {
 #ifdef DEBUG_FFTTOOLS
     QTime start = QTime::currentTime();
 #endif
 
     if (right == 0) {
-        Q_ASSERT(in.size() > 0);
-        right = uint(in.size()) - 1;
+        Q_ASSERT(inSize > 0);
+        right = uint(inSize) - 1;
     }
     Q_ASSERT(targetSize > 0);
     Q_ASSERT(left < right);
 
-    QVector<float> out(static_cast<int>(targetSize));
-
     float x;
     int xi;
     int i;
@@ -255,14 +308,14 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
             x = float(i) / (targetSize - 1) * (right - left) + left;
             xi = int(floor(x));
 
-            if (x > float(in.size() - 1)) {
-                // This may happen if right > in.size()-1; Fill the rest of the vector
+            if (x > float(inSize - 1)) {
+                // This may happen if right > inSize-1; Fill the rest of the vector
                 // with the default value now.
                 break;
             }
 
             // Use linear interpolation in order to get smoother display
-            if (xi == 0 || xi == in.size() - 1) {
+            if (xi == 0 || xi == inSize - 1) {
                 // ... except if we are at the left or right border of the input signal.
                 // Special case here since we consider previous and future values as well for
                 // the actual interpolation (not possible here).
@@ -294,7 +347,7 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
             xi = int(floor(x));
             out[i] = fill;
 
-            for (; src < xi && src < in.size(); ++src) {
+            for (; src < xi && src < inSize; ++src) {
                 if (out[i] < in[src]) {
                     out[i] = in[src];
                 }
@@ -309,10 +362,8 @@ const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &i
     }
 
 #ifdef DEBUG_FFTTOOLS
-    qCDebug(KDENLIVE_LOG) << "Interpolated " << targetSize << " nodes from " << in.size() << " input points in " << start.elapsed() << " ms";
+    qCDebug(KDENLIVE_LOG) << "Interpolated " << targetSize << " nodes from " << inSize << " input points in " << start.elapsed() << " ms";
 #endif
-
-    return out;
 }
 
 #ifdef DEBUG_FFTTOOLS
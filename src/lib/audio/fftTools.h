@@ -10,7 +10,63 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "../../definitions.h"
 #include "../external/kiss_fft/tools/kiss_fftr.h"
 #include <QHash>
+#include <QMutex>
 #include <QVector>
+#include <memory>
+#include <new>
+#include <vector>
+
+/** @brief Allocator returning memory aligned for SIMD loads (32 bytes, enough for AVX) */
+template <typename T> struct FFTAlignedAllocator
+{
+    using value_type = T;
+    static constexpr size_t Alignment = 32;
+    FFTAlignedAllocator() = default;
+    template <typename U> FFTAlignedAllocator(const FFTAlignedAllocator<U> &) {}
+    T *allocate(size_t n)
+    {
+        void *ptr = qMallocAligned(n * sizeof(T), Alignment);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(ptr);
+    }
+    void deallocate(T *ptr, size_t) { qFreeAligned(ptr); }
+    template <typename U> bool operator==(const FFTAlignedAllocator<U> &) const { return true; }
+    template <typename U> bool operator!=(const FFTAlignedAllocator<U> &) const { return false; }
+};
+template <typename T> using FFTBuffer = std::vector<T, FFTAlignedAllocator<T>>;
+
+/** @class FFTPlan
+    @brief A real FFT configuration of a given size and direction, obtained with FFTTools::plan().
+    Plans are shared by all users of the same size and direction. A plan can be used by several
+    threads at the same time: kiss_fftr needs a scratch buffer per transform, so each concurrent
+    transform borrows its own configuration from a small pool kept by the plan.
+ */
+class FFTPlan
+{
+public:
+    ~FFTPlan();
+    /** @brief Number of real samples of the transform */
+    int size() const;
+    bool isInverse() const;
+    /** @brief Forward transform of size() real values into size() / 2 + 1 complex values */
+    void forward(const float *timeData, kiss_fft_cpx *freqData) const;
+    /** @brief Inverse transform of size() / 2 + 1 complex values into size() real values (not normalized) */
+    void inverse(const kiss_fft_cpx *freqData, float *timeData) const;
+
+private:
+    friend class FFTTools;
+    FFTPlan(int size, bool inverse);
+    Q_DISABLE_COPY(FFTPlan)
+    kiss_fftr_cfg acquire() const;
+    void release(kiss_fftr_cfg cfg) const;
+    const int m_size;
+    const bool m_inverse;
+    mutable QMutex m_poolMutex;
+    mutable std::vector<kiss_fftr_cfg> m_pool;
+};
+using FFTPlanPtr = std::shared_ptr<const FFTPlan>;
 
 class FFTTools
 {
@@ -35,11 +91,9 @@ public:
     */
     static const QVector<float> window(const WindowType windowType, const int size, const float param = 0);
 
-    static const QString windowSignature(const WindowType windowType, const int size, const float param = 0);
-
-    /** Returns a signature for a kiss_fft configuration
-        used as a hash in the cache */
-    static const QString cfgSignature(const int size);
+    /** Returns the shared FFT plan for real transforms of the given size, creating it if needed.
+        Thread safe. Plans stay cached for the lifetime of the application. */
+    static FFTPlanPtr plan(const int size, const bool inverse = false);
 
     /** Calculates the Fourier Transformation of the input audio frame.
         The resulting values will be given in relative decibel: The maximum power is 0 dB, lower powers have
@@ -53,6 +107,14 @@ public:
     void fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
                        const uint windowSize, const float param = 0);
 
+    /** Same as fftNormalized(), for @param windowCount windows starting every @param hopSize samples
+        (overlapping if hopSize < windowSize). The spectra are written one after the other into
+        @param freqSpectra, which has to be of size windowCount * windowSize/2.
+        Window contents beyond the end of the frame are zero.
+    */
+    void fftNormalizedBatch(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectra, const WindowType windowType,
+                            const uint windowSize, const uint hopSize, const int windowCount, const float param = 0);
+
     /** This is linear interpolation with the special property that it preserves peaks, which is required
         for e.g. showing correct Decibel values (where the peak values are of interest because of clipping which
         may occur for too strong frequencies; The lower values are smeared by the window function anyway).
@@ -68,8 +130,25 @@ public:
                             will be used for filling the missing information.
         */
     static const QVector<float> interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
+    /** Same as above, writing the @param targetSize interpolated values into @param out
+        instead of allocating a new vector. */
+    static void interpolatePeakPreserving(const float *in, const int inSize, float *out, const uint targetSize, uint left = 0, uint right = 0,
+                                          float fill = 0.0);
 
 private:
-    QHash<QString, kiss_fftr_cfg> m_fftCfgs;          // FFT cfg cache
-    QHash<QString, QVector<float>> m_windowFunctions; // Window function cache
+    /** Window function cache, the key combines type, size and parameter */
+    QHash<quint64, QVector<float>> m_windowFunctions;
+    /** Input and output buffers of the last FFT, reused as long as the window size does not grow */
+    FFTBuffer<float> m_fftInput;
+    FFTBuffer<kiss_fft_cpx> m_fftOutput;
+    /** Plan and window function used by the last FFT, to skip the cache lookups
+        while the parameters do not change */
+    FFTPlanPtr m_lastPlan;
+    QVector<float> m_lastWindow;
+    WindowType m_lastWindowType{Window_Rect};
+    float m_lastParam{0};
+    void preparePlan(const WindowType windowType, const uint windowSize, const float param);
+    /** Windows and normalizes one channel of @param numSamples interleaved samples into m_fftInput,
+        transforms it and writes the dB spectrum into @param freqSpectrum */
+    void transformWindow(const qint16 *samples, const uint numSamples, const uint numChannels, float *freqSpectrum, const uint windowSize);
 };
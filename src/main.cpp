@@ -16,6 +16,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include "render/renderrequest.h"
+#include "render/renderservice.h"
+#include "utils/cachebudget.h"
+#include "utils/trace.h"
 #include <config-kdenlive.h>
 #include <project/projectmanager.h>
 
@@ -52,12 +55,16 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QCommandLineParser>
 #include <QDir>
 #include <QIcon>
+#include <QLocale>
 #include <QProcess>
 #include <QQmlEngine>
 #include <QQuickStyle>
 #include <QQuickWindow>
 #include <QResource>
 #include <QSplashScreen>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QThread>
 #include <QUndoGroup>
 #include <QUrl> //new
 
@@ -221,6 +228,73 @@ static void initIconRCC(LinuxPackageType packageType)
 }
 #endif
 
+/** @brief The command line options managing the cache, they don't need a display */
+static QList<QCommandLineOption> cacheOptions()
+{
+    return {QCommandLineOption(QStringLiteral("cache-report"), i18n("Print the timeline preview and thumbnail cache usage of each project and exit.")),
+            QCommandLineOption(QStringLiteral("cache-budget"),
+                               i18n("Remove the least recently used timeline previews and thumbnails until the cache fits in the given size (in Mb) "
+                                    "and exit."),
+                               QStringLiteral("size"))};
+}
+
+/** @brief Returns true if the command line asks for a cache operation */
+static bool isCacheCommand(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        if (arg == "--") {
+            break;
+        }
+        if (arg.startsWith("--cache-") || arg.startsWith("-cache-")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Report or clean the cache from the command line, without creating the GUI application so that no display is needed */
+static int runCacheCommand(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    // Same names as set by KAboutData, so that the cache location matches the one of the GUI
+    QCoreApplication::setApplicationName(QStringLiteral("kdenlive"));
+    QCoreApplication::setOrganizationDomain(QStringLiteral("kde.org"));
+    QCoreApplication::setApplicationVersion(QString(KDENLIVE_VERSION));
+    KLocalizedString::setApplicationDomain("kdenlive");
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QList<QCommandLineOption> options = cacheOptions();
+    parser.addOptions(options);
+    parser.process(app);
+    const QCommandLineOption &cacheBudgetOption = options.at(1);
+
+    // No need to initialize MLT to manage the cache
+    const QDir cacheRoot(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    const QLocale locale;
+    QTextStream out(stdout);
+    if (parser.isSet(cacheBudgetOption)) {
+        bool ok = false;
+        const qint64 budget = parser.value(cacheBudgetOption).toLongLong(&ok);
+        if (!ok || budget < 0) {
+            qCritical() << "The cache budget must be a size in Mb.";
+            return EXIT_FAILURE;
+        }
+        const qint64 freed = CacheBudget::evict(cacheRoot, budget * 1048576);
+        out << i18n("Removed %1 of cached data.", locale.formattedDataSize(freed)) << Qt::endl;
+    }
+    const CacheBudget::Report report = CacheBudget::usage(cacheRoot);
+    out << i18n("Cache folder: %1", cacheRoot.absolutePath()) << Qt::endl;
+    out << i18n("Project\tPreviews\tShared previews\tThumbnails\tLast used\tProject file") << Qt::endl;
+    for (const auto &project : report.projects) {
+        out << project.documentId << '\t' << locale.formattedDataSize(project.previews) << '\t' << locale.formattedDataSize(project.sharedPreviews) << '\t'
+            << locale.formattedDataSize(project.thumbnails) << '\t' << project.lastUsed.toString(Qt::ISODate) << '\t' << project.projectFile << Qt::endl;
+    }
+    out << i18n("Shared timeline previews: %1", locale.formattedDataSize(report.sharedPreviews)) << Qt::endl;
+    out << i18n("Total: %1", locale.formattedDataSize(report.total)) << Qt::endl;
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char *argv[])
 {
     int result = EXIT_SUCCESS;
@@ -230,6 +304,10 @@ int main(int argc, char *argv[])
     // Force QDomDocument to use a deterministic XML attribute order
     qSetGlobalQHashSeed(0);
 
+    if (isCacheCommand(argc, argv)) {
+        return runCacheCommand(argc, argv);
+    }
+
 #ifdef CRASH_AUTO_TEST
     Logger::init();
 #endif
@@ -387,12 +465,33 @@ int main(int argc, char *argv[])
                                   i18n("Exit after (detached) render process started, without this flag it exists only after it finished."));
     parser.addOption(exitOption);
 
+    QCommandLineOption serviceOption(QStringLiteral("render-service"),
+                                     i18n("Run as a headless render service, processing the job descriptors (JSON files) dropped in the given spool folder."),
+                                     QStringLiteral("spool folder"));
+    parser.addOption(serviceOption);
+
+    QCommandLineOption serviceProcessesOption(QStringLiteral("render-processes"),
+                                              i18n("Maximum number of render processes the render service runs at the same time."), QStringLiteral("count"),
+                                              QString::number(qMax(1, QThread::idealThreadCount() / 4)));
+    parser.addOption(serviceProcessesOption);
+
+    QCommandLineOption traceOption(QStringLiteral("trace"),
+                                   i18n("Record the time spent in performance critical operations and write it to the given file as Chrome trace events."),
+                                   QStringLiteral("trace file"));
+    parser.addOption(traceOption);
+
+    // The cache options are handled in runCacheCommand, they are only listed here for the help
+    parser.addOptions(cacheOptions());
+
     parser.addPositionalArgument(QStringLiteral("file"), i18n("Kdenlive document to open."));
     parser.addPositionalArgument(QStringLiteral("rendering"), i18n("Output file for rendered video."));
 
     // Parse command line
     parser.process(app);
     aboutData.processCommandLine(&parser);
+    if (parser.isSet(traceOption)) {
+        Trace::start(parser.value(traceOption));
+    }
 
     QUrl url;
     QUrl renderUrl;
@@ -416,6 +515,31 @@ int main(int argc, char *argv[])
 
     qApp->processEvents(QEventLoop::AllEvents);
 
+    if (parser.isSet(serviceOption)) {
+        if (!Core::build(packageType, true)) {
+            return EXIT_FAILURE;
+        }
+        // Initialize MLT and the repositories once for all jobs
+        pCore->initHeadless(QUrl());
+        app.processEvents();
+        Wizard::fixKdenliveRenderPath();
+        int exitCode = EXIT_SUCCESS;
+        {
+            RenderService service(parser.value(serviceOption), parser.value(serviceProcessesOption).toInt());
+            QObject::connect(&service, &RenderService::finished, &app, &QCoreApplication::quit);
+            if (service.start()) {
+                app.exec();
+            } else {
+                exitCode = EXIT_FAILURE;
+            }
+        }
+        pCore->projectManager()->closeCurrentDocument(false, false);
+        app.processEvents();
+        Core::clean();
+        app.processEvents();
+        return exitCode;
+    }
+
     if (parser.isSet(renderOption)) {
         if (url.isEmpty()) {
             qCritical() << "You need to give a valid file if you want to render from the command line.";
@@ -14,6 +14,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "doc/kdenlivedoc.h"
 #include "doc/kthumb.h"
 #include "effects/effectstack/model/effectstackmodel.hpp"
+#include "jobs/proxytask.h"
 #include "kdenlivesettings.h"
 #include "lib/audio/audioStreamInfo.h"
 #include "profiles/profilemodel.hpp"
@@ -267,8 +268,16 @@ void ClipController::getInfoForProducer()
     date = QFileInfo(m_path).lastModified();
     m_videoIndex = -1;
     int audioIndex = -1;
-    // special case: playlist with a proxy clip have to be detected separately
-    if (m_usesProxy && m_path.endsWith(QStringLiteral(".mlt"))) {
+    if (m_usesProxy && ProxyTask::isRangeProxy(proxy)) {
+        // The proxy of the used ranges is a playlist, but its segments keep the streams of the original clip
+        if (!m_properties->property_exists("meta.media.nb_streams")) {
+            ProxyTask::passRangeProxyStreams(proxy, *m_properties);
+        }
+        audioIndex = getProducerIntProperty(QStringLiteral("audio_index"));
+        m_videoIndex = getProducerIntProperty(QStringLiteral("video_index"));
+        m_clipType = audioIndex == -1 ? ClipType::Video : ClipType::AV;
+    } else if (m_usesProxy && m_path.endsWith(QStringLiteral(".mlt"))) {
+        // special case: playlist with a proxy clip have to be detected separately
         if (m_clipType != ClipType::Timeline) {
             m_clipType = ClipType::Playlist;
         }
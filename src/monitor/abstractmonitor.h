@@ -7,6 +7,7 @@
 #pragma once
 
 #include "definitions.h"
+#include "monitor/scopes/sharedframe.h"
 
 #include <cstdint>
 
@@ -87,6 +88,8 @@ protected:
 Q_SIGNALS:
     /** @brief Send a frame for analysis or title background display. */
     void frameUpdated(const QImage &);
+    /** @brief Send the displayed frame for analysis, as produced by MLT. */
+    void sharedFrameUpdated(const SharedFrame &);
     /** @brief This signal contains the audio of the current frame. */
     void audioSamplesSignal(const audioShortVector &, int, int, int);
     /** @brief Scopes are ready to receive a new frame. */
@@ -0,0 +1,266 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "framecache.h"
+#include "bin/projectclip.h"
+
+#include <QtConcurrent>
+#include <cstring>
+#include <mlt++/MltFrame.h>
+
+// Number of frames decoded ahead of the seek direction when the monitor is paused
+#define PREFETCH_FRAMES 12
+// Seeks further away than this from the previous one are not considered as jogging
+#define MAX_JOG_STEP 4
+
+FrameCache::FrameCache()
+{
+    mlt_filter filter = mlt_filter_new();
+    filter->child = this;
+    filter->process = filterProcess;
+    mlt_properties_set(MLT_FILTER_PROPERTIES(filter), "mlt_service", "kdenlive_framecache");
+    m_filter.reset(new Mlt::Filter(filter));
+    mlt_filter_close(filter);
+    m_frames.setMaxCost(0);
+}
+
+FrameCache::~FrameCache()
+{
+    stopPrefetch();
+    // Frames still travelling in the consumer pass through
+    m_filter->get_filter()->child = nullptr;
+}
+
+Mlt::Filter &FrameCache::filter()
+{
+    return *m_filter.get();
+}
+
+quint64 FrameCache::cacheKey(int position, mlt_image_format format, int width, int height)
+{
+    return (quint64(quint32(position)) << 32) | (quint64(format & 0xf) << 28) | (quint64(width & 0x3fff) << 14) | quint64(height & 0x3fff);
+}
+
+void FrameCache::setBudget(int megaBytes)
+{
+    QMutexLocker lock(&m_mutex);
+    m_enabled = megaBytes > 0;
+    // Cost is counted in kB
+    m_frames.setMaxCost(qMax(0, megaBytes) * 1024);
+}
+
+bool FrameCache::isEnabled() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_enabled;
+}
+
+void FrameCache::setProducer(const std::shared_ptr<Mlt::Producer> &producer)
+{
+    clear();
+    m_source = producer;
+    m_lastSeek = -1;
+}
+
+void FrameCache::clear()
+{
+    stopPrefetch();
+    m_prefetchProducer.reset();
+    QMutexLocker lock(&m_mutex);
+    m_generation++;
+    m_frames.clear();
+}
+
+void FrameCache::stopPrefetch()
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        m_prefetchQueue.clear();
+    }
+    m_prefetchJob.waitForFinished();
+}
+
+FrameCache::Statistics FrameCache::statistics() const
+{
+    QMutexLocker lock(&m_mutex);
+    Statistics stats = m_stats;
+    stats.frames = int(m_frames.count());
+    stats.bytes = qint64(m_frames.totalCost()) * 1024;
+    return stats;
+}
+
+mlt_frame FrameCache::filterProcess(mlt_filter filter, mlt_frame frame)
+{
+    auto *cache = static_cast<FrameCache *>(filter->child);
+    if (cache) {
+        QMutexLocker lock(&cache->m_mutex);
+        if (cache->m_enabled) {
+            mlt_frame_push_service(frame, cache);
+            mlt_frame_push_service_int(frame, cache->m_generation);
+            mlt_frame_push_get_image(frame, filterGetImage);
+        }
+    }
+    return frame;
+}
+
+int FrameCache::filterGetImage(mlt_frame frame, uint8_t **image, mlt_image_format *format, int *width, int *height, int writable)
+{
+    int generation = mlt_frame_pop_service_int(frame);
+    auto *cache = static_cast<FrameCache *>(mlt_frame_pop_service(frame));
+    return cache->getImage(frame, generation, image, format, width, height, writable);
+}
+
+int FrameCache::getImage(mlt_frame frame, int generation, uint8_t **image, mlt_image_format *format, int *width, int *height, int writable)
+{
+    const bool cacheable = *format != mlt_image_movit && *format != mlt_image_opengl_texture;
+    const quint64 key = cacheKey(mlt_frame_get_position(frame), *format, *width, *height);
+    mlt_properties properties = MLT_FRAME_PROPERTIES(frame);
+    if (cacheable) {
+        QMutexLocker lock(&m_mutex);
+        Entry *entry = generation == m_generation ? m_frames.object(key) : nullptr;
+        if (entry) {
+            m_stats.hits++;
+            const int size = int(entry->data.size());
+            auto *copy = static_cast<uint8_t *>(mlt_pool_alloc(size));
+            memcpy(copy, entry->data.constData(), size_t(size));
+            mlt_frame_set_image(frame, copy, size, mlt_pool_release);
+            mlt_properties_set_int(properties, "progressive", entry->progressive);
+            *image = copy;
+            *format = entry->format;
+            *width = entry->width;
+            *height = entry->height;
+            return 0;
+        }
+        m_stats.misses++;
+        // Remember how the consumer requests its images so that prefetched frames match
+        m_requestFormat = *format;
+        m_requestWidth = *width;
+        m_requestHeight = *height;
+        m_consumerProperties.clear();
+        for (int i = 0; i < mlt_properties_count(properties); ++i) {
+            const char *name = mlt_properties_get_name(properties, i);
+            if (name && strncmp(name, "consumer.", 9) == 0) {
+                const char *value = mlt_properties_get_value(properties, i);
+                if (value) {
+                    m_consumerProperties.append({QByteArray(name), QByteArray(value)});
+                }
+            }
+        }
+    }
+    int error = mlt_frame_get_image(frame, image, format, width, height, writable);
+    if (error == 0 && cacheable && *image) {
+        store(key, generation, *image, *format, *width, *height, mlt_properties_get_int(properties, "progressive"));
+    }
+    return error;
+}
+
+void FrameCache::store(quint64 key, int generation, const uint8_t *image, mlt_image_format format, int width, int height, int progressive)
+{
+    const int size = mlt_image_format_size(format, width, height, nullptr);
+    if (size <= 0) {
+        return;
+    }
+    QMutexLocker lock(&m_mutex);
+    if (generation != m_generation || m_frames.contains(key)) {
+        return;
+    }
+    auto *entry = new Entry{QByteArray(reinterpret_cast<const char *>(image), size), format, width, height, progressive};
+    m_frames.insert(key, entry, qMax(1, size / 1024));
+}
+
+void FrameCache::seeked(int position, bool paused)
+{
+    const int step = m_lastSeek < 0 ? 0 : position - m_lastSeek;
+    m_lastSeek = position;
+    if (!paused || step == 0 || qAbs(step) > MAX_JOG_STEP || !m_source || !isEnabled()) {
+        return;
+    }
+    if (m_source->type() == mlt_service_tractor_type) {
+        // Sequence clips are too expensive to clone for prefetching
+        return;
+    }
+    const int direction = step > 0 ? 1 : -1;
+    const int length = m_source->get_length();
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_requestFormat == mlt_image_none || m_requestWidth <= 0 || m_requestHeight <= 0) {
+            return;
+        }
+        // Only the frames around the last seek are interesting
+        m_prefetchQueue.clear();
+        for (int i = 1; i <= PREFETCH_FRAMES; ++i) {
+            const int frame = position + i * direction;
+            if (frame < 0 || frame >= length) {
+                break;
+            }
+            if (!m_frames.contains(cacheKey(frame, m_requestFormat, m_requestWidth, m_requestHeight))) {
+                m_prefetchQueue.push_back(frame);
+            }
+        }
+        if (m_prefetchQueue.empty() || m_prefetching) {
+            // A running job picks the new queue
+            return;
+        }
+        m_prefetching = true;
+    }
+    if (!m_prefetchProducer) {
+        // The displayed producer belongs to the consumer thread, decode on a clone
+        m_prefetchProducer = ProjectClip::cloneProducer(m_source);
+        if (!m_prefetchProducer || !m_prefetchProducer->is_valid()) {
+            m_prefetchProducer.reset();
+            m_source.reset();
+            QMutexLocker lock(&m_mutex);
+            m_prefetching = false;
+            return;
+        }
+    }
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    m_prefetchJob = QtConcurrent::run(this, &FrameCache::prefetch);
+#else
+    m_prefetchJob = QtConcurrent::run(&FrameCache::prefetch, this);
+#endif
+}
+
+void FrameCache::prefetch()
+{
+    for (;;) {
+        QMutexLocker lock(&m_mutex);
+        if (m_prefetchQueue.empty()) {
+            m_prefetching = false;
+            return;
+        }
+        const int position = m_prefetchQueue.front();
+        m_prefetchQueue.pop_front();
+        const mlt_image_format requestFormat = m_requestFormat;
+        const int requestWidth = m_requestWidth;
+        const int requestHeight = m_requestHeight;
+        mlt_image_format format = requestFormat;
+        int width = requestWidth;
+        int height = requestHeight;
+        const quint64 key = cacheKey(position, format, width, height);
+        if (m_frames.contains(key)) {
+            continue;
+        }
+        const int generation = m_generation;
+        const QList<QPair<QByteArray, QByteArray>> consumerProperties = m_consumerProperties;
+        lock.unlock();
+
+        m_prefetchProducer->seek(position);
+        std::unique_ptr<Mlt::Frame> frame(m_prefetchProducer->get_frame());
+        if (!frame || !frame->is_valid()) {
+            continue;
+        }
+        for (const auto &property : consumerProperties) {
+            frame->set(property.first.constData(), property.second.constData());
+        }
+        uint8_t *image = frame->get_image(format, width, height);
+        // Only keep images identical to what the consumer would get
+        if (image && format == requestFormat && width == requestWidth && height == requestHeight) {
+            store(key, generation, image, format, width, height, frame->get_int("progressive"));
+            QMutexLocker statsLock(&m_mutex);
+            m_stats.prefetched++;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <deque>
+#include <memory>
+#include <mlt++/MltFilter.h>
+#include <mlt++/MltProducer.h>
+
+/** @class FrameCache
+    @brief In memory cache of the images decoded for the clip monitor.
+    The cache is an MLT filter attached to the monitor consumer, it stores the images requested by the consumer
+    by frame position and keeps the most recently used ones within a memory budget. When the monitor is paused
+    and seeked frame by frame, the next frames in the seek direction are decoded ahead on a clone of the producer.
+    The cache must be cleared each time the displayed content changes.
+ */
+class FrameCache
+{
+public:
+    struct Statistics
+    {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 prefetched = 0;
+        int frames = 0;
+        qint64 bytes = 0;
+    };
+
+    FrameCache();
+    ~FrameCache();
+    /** @brief Set the memory available to the cache in MB, 0 disables the cache */
+    void setBudget(int megaBytes);
+    bool isEnabled() const;
+    /** @brief The filter to attach to the monitor consumer */
+    Mlt::Filter &filter();
+    /** @brief Set the producer displayed in the monitor, used to prefetch frames. This also clears the cache */
+    void setProducer(const std::shared_ptr<Mlt::Producer> &producer);
+    /** @brief Drop all images, for example because the displayed clip was modified */
+    void clear();
+    /** @brief The monitor was seeked to @param position, prefetch the following frames if @param paused */
+    void seeked(int position, bool paused);
+    Statistics statistics() const;
+
+private:
+    struct Entry
+    {
+        QByteArray data;
+        mlt_image_format format;
+        int width;
+        int height;
+        int progressive;
+    };
+    std::unique_ptr<Mlt::Filter> m_filter;
+    mutable QMutex m_mutex;
+    QCache<quint64, Entry> m_frames;
+    bool m_enabled{false};
+    /** @brief Incremented when the cache is cleared, images decoded for an older generation are not stored */
+    int m_generation{0};
+    Statistics m_stats;
+    /** @brief The image request and consumer properties of the last displayed frame, reused for prefetching */
+    mlt_image_format m_requestFormat{mlt_image_none};
+    int m_requestWidth{0};
+    int m_requestHeight{0};
+    QList<QPair<QByteArray, QByteArray>> m_consumerProperties;
+    std::shared_ptr<Mlt::Producer> m_source;
+    std::shared_ptr<Mlt::Producer> m_prefetchProducer;
+    std::deque<int> m_prefetchQueue;
+    QFuture<void> m_prefetchJob;
+    bool m_prefetching{false};
+    int m_lastSeek{-1};
+
+    static quint64 cacheKey(int position, mlt_image_format format, int width, int height);
+    static mlt_frame filterProcess(mlt_filter filter, mlt_frame frame);
+    static int filterGetImage(mlt_frame frame, uint8_t **image, mlt_image_format *format, int *width, int *height, int writable);
+    int getImage(mlt_frame frame, int generation, uint8_t **image, mlt_image_format *format, int *width, int *height, int writable);
+    /** @brief Store a decoded image, does nothing if the cache was cleared since @param generation */
+    void store(quint64 key, int generation, const uint8_t *image, mlt_image_format format, int width, int height, int progressive);
+    void stopPrefetch();
+    void prefetch();
+};
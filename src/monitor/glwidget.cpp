@@ -29,11 +29,13 @@
 
 #include "bin/model/markersortmodel.h"
 #include "core.h"
+#include "framecache.h"
 #include "glwidget.h"
 #include "monitorproxy.h"
 #include "profiles/profilemodel.hpp"
 #include "timeline2/view/qml/timelineitems.h"
 #include "timeline2/view/qmltypes/thumbnailprovider.h"
+#include "utils/trace.h"
 #include <lib/localeHandling.h>
 #include <mlt++/Mlt.h>
 
@@ -137,6 +139,9 @@ VideoWidget::VideoWidget(int id, QWidget *parent)
     m_offscreenSurface.setFormat(fmt);
     m_offscreenSurface.create();
 
+    if (m_id == Kdenlive::ClipMonitor) {
+        m_frameCache = std::make_unique<FrameCache>();
+    }
     m_refreshTimer.setSingleShot(true);
     m_refreshTimer.setInterval(10);
     m_blackClip.reset(new Mlt::Producer(pCore->getProjectProfile(), "color:0"));
@@ -726,6 +731,9 @@ bool VideoWidget::isReady() const
 void VideoWidget::requestSeek(int position, bool noAudioScrub)
 {
     m_producer->seek(position);
+    if (m_frameCache) {
+        m_frameCache->seeked(position, qFuzzyIsNull(m_producer->get_speed()));
+    }
     if (!qFuzzyIsNull(m_producer->get_speed())) {
         m_consumer->purge();
     }
@@ -756,6 +764,10 @@ QString VideoWidget::frameToTime(int frames) const
 void VideoWidget::refresh()
 {
     m_refreshTimer.stop();
+    if (m_frameCache) {
+        // The displayed content changed
+        m_frameCache->clear();
+    }
     if (m_mltMutex.tryLock()) {
         if (m_consumer) {
             restartConsumer();
@@ -1026,6 +1038,9 @@ int VideoWidget::setProducer(const std::shared_ptr<Mlt::Producer> &producer, boo
     }
     m_producer->set_speed(0);
     m_proxy->setSpeed(0);
+    if (m_frameCache) {
+        m_frameCache->setProducer(m_producer);
+    }
     error = reconfigure();
     if (error == 0) {
         // The profile display aspect ratio may have changed.
@@ -1052,6 +1067,11 @@ int VideoWidget::setProducer(const std::shared_ptr<Mlt::Producer> &producer, boo
     return error;
 }
 
+FrameCache *VideoWidget::frameCache() const
+{
+    return m_frameCache.get();
+}
+
 int VideoWidget::droppedFrames() const
 {
     return (m_consumer ? m_consumer->get_int("drop_count") : 0);
@@ -1144,6 +1164,14 @@ int VideoWidget::reconfigure()
             m_consumer->connect(*m_producer.get());
             // m_producer->set_speed(0.0);
         }
+        if (m_frameCache) {
+            m_frameCache->setBudget(m_glslManager ? 0 : KdenliveSettings::clipMonitorFrameCache());
+            if (!m_glslManager && m_consumer->get_int("kdenlive:frame_cache") == 0) {
+                // Serve the images of recently displayed frames from memory
+                static_cast<Mlt::FilteredConsumer *>(m_consumer.get())->attach(m_frameCache->filter());
+                m_consumer->set("kdenlive:frame_cache", 1);
+            }
+        }
 
         int dropFrames = 1;
         if (!KdenliveSettings::monitor_dropframes()) {
@@ -1379,6 +1407,7 @@ void VideoWidget::updateTexture(GLuint yName, GLuint uName, GLuint vName)
 
 void VideoWidget::on_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data data)
 {
+    KDENLIVE_TRACE("monitor", "frameShow");
     auto frame = Mlt::EventData(data).to_frame();
     if (frame.is_valid() && frame.get_int("rendered")) {
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
@@ -1480,6 +1509,7 @@ FrameRenderer::~FrameRenderer()
 
 void FrameRenderer::showFrame(Mlt::Frame frame)
 {
+    KDENLIVE_TRACE("monitor", "FrameRenderer::showFrame");
     // Save this frame for future use and to keep a reference to the GL Texture.
     m_displayFrame = SharedFrame(frame);
 
@@ -37,6 +37,7 @@ class Consumer;
 
 class RenderThread;
 class FrameRenderer;
+class FrameCache;
 class MonitorProxy;
 class MarkerSortModel;
 
@@ -95,6 +96,8 @@ public:
     void lockMonitor();
     void releaseMonitor();
     int droppedFrames() const;
+    /** @brief The decoded frame cache, only available in the clip monitor */
+    FrameCache *frameCache() const;
     void resetDrops();
     bool checkFrameNumber(int pos, bool isPlaying);
     /** @brief Return current timeline position */
@@ -233,6 +236,7 @@ private:
     QPoint m_offset;
     MonitorProxy *m_proxy;
     std::shared_ptr<Mlt::Producer> m_blackClip;
+    std::unique_ptr<FrameCache> m_frameCache;
     static void on_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data);
     static void on_frame_render(mlt_consumer, VideoWidget *widget, mlt_frame frame);
     static void on_gl_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data data);
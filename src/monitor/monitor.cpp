@@ -35,6 +35,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #endif
 
 #include "bin/model/markersortmodel.h"
+#include "framecache.h"
 #include "monitormanager.h"
 #include "monitorproxy.h"
 #include "profiles/profilemodel.hpp"
@@ -47,6 +48,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/view/timelinewidget.h"
 #include "transitions/transitionsrepository.hpp"
 #include "utils/thumbnailcache.hpp"
+#include "utils/trace.h"
 
 #include "KLocalizedString"
 #include <KActionMenu>
@@ -1636,6 +1638,10 @@ void Monitor::forceMonitorRefresh()
 
 void Monitor::refreshMonitor(bool directUpdate, bool slowRefresh)
 {
+    if (m_glMonitor->frameCache()) {
+        // Cached images are outdated even if the refresh is skipped
+        m_glMonitor->frameCache()->clear();
+    }
     if (!m_glMonitor->isReady() || isPlaying()) {
         return;
     }
@@ -2289,6 +2295,11 @@ void Monitor::sendFrameForAnalysis(bool analyse)
     m_glMonitor->sendFrameForAnalysis = analyse;
 }
 
+void Monitor::sendSharedFrameForAnalysis(bool analyse)
+{
+    m_sendSharedFrame = analyse;
+}
+
 void Monitor::updateAudioForAnalysis()
 {
     m_glMonitor->updateAudioForAnalysis();
@@ -2296,7 +2307,11 @@ void Monitor::updateAudioForAnalysis()
 
 void Monitor::onFrameDisplayed(const SharedFrame &frame)
 {
+    KDENLIVE_TRACE("monitor", "frameDisplayed");
     Q_EMIT m_monitorManager->frameDisplayed(frame);
+    if (m_sendSharedFrame) {
+        Q_EMIT sharedFrameUpdated(frame);
+    }
     if (m_id == Kdenlive::ProjectMonitor) {
         Q_EMIT pCore->updateMixerLevels(frame.get_position());
     }
@@ -2318,6 +2333,22 @@ void Monitor::checkDrops()
         m_qmlManager->setProperty(QStringLiteral("dropped"), true);
         m_qmlManager->setProperty(QStringLiteral("fps"), QString::number(dropped, 'f', 2));
     }
+    updateFrameCacheStats();
+}
+
+void Monitor::updateFrameCacheStats()
+{
+    FrameCache *cache = m_glMonitor->frameCache();
+    if (cache == nullptr || !(KdenliveSettings::displayClipMonitorInfo() & 0x20)) {
+        return;
+    }
+    QString text;
+    if (cache->isEnabled()) {
+        const FrameCache::Statistics stats = cache->statistics();
+        const qint64 requests = stats.hits + stats.misses;
+        text = i18n("cache %1%, %2 frames, %3MB", requests > 0 ? 100 * stats.hits / requests : 0, stats.frames, stats.bytes / 1048576);
+    }
+    m_qmlManager->setProperty(QStringLiteral("cacheStats"), text);
 }
 
 void Monitor::reloadProducer(const QString &id)
@@ -2818,6 +2849,9 @@ void Monitor::slotSeekPosition(int pos)
     Q_EMIT seekPosition(pos);
     m_timePos->setValue(pos);
     checkOverlay();
+    if (!m_playAction->isActive()) {
+        updateFrameCacheStats();
+    }
 }
 
 void Monitor::slotStart()
@@ -100,6 +100,8 @@ public:
     QVariantList effectRoto() const;
     void setEffectKeyframe(bool enable, bool outside);
     void sendFrameForAnalysis(bool analyse);
+    /** @brief Share displayed frames with the scopes as they are produced, without converting them to QImage */
+    void sendSharedFrameForAnalysis(bool analyse);
     void updateAudioForAnalysis();
     void switchMonitorInfo(int code);
     void restart();
@@ -235,6 +237,7 @@ private:
     int m_speedIndex;
     QMetaObject::Connection m_switchConnection;
     QMetaObject::Connection m_captureConnection;
+    bool m_sendSharedFrame{false};
 
     void adjustScrollBars(float horizontal, float vertical);
     void loadQmlScene(MonitorSceneType type, const QVariant &sceneData = QVariant());
@@ -281,6 +284,8 @@ private Q_SLOTS:
     void processSeek(int pos, bool noAudioScrub = false);
     /** @brief Check and display dropped frames */
     void checkDrops();
+    /** @brief Display the hit rate of the decoded frame cache in the clip monitor overlay */
+    void updateFrameCacheStats();
     /** @brief En/Disable the show record timecode feature in clip monitor */
     void slotSwitchRecTimecode(bool enable);
 
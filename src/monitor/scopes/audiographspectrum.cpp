@@ -334,8 +334,7 @@ void AudioGraphSpectrum::refreshPixmap()
 void AudioGraphSpectrum::refreshScope(const QSize & /*size*/, bool /*full*/)
 {
     SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
+    while (m_queue.tryPop(sFrame)) {
         if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
             mlt_audio_format format = mlt_audio_s16;
             int channels = sFrame.get_audio_channels();
@@ -7,11 +7,15 @@
 
 #pragma once
 
-#include <QList>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QThread>
 #include <QWaitCondition>
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
 /*!
   \class DataQueue
   \brief The DataQueue provides a thread safe container for passing data between
@@ -20,15 +24,18 @@
   threadsafe
 
   DataQueue provides a limited size container for passing data between objects.
-  One object can add data to the queue by calling push() while another object
+  One object can add data to the queue by calling push() while other objects
   can remove items from the queue by calling pop().
 
   DataQueue provides configurable behavior for handling overflows. It can
   discard the oldest, discard the newest or block the object calling push()
   until room has been freed in the queue by another object calling pop().
 
-  DataQueue is threadsafe and is therefore most appropriate when passing data
-  between objects operating in different thread contexts.
+  DataQueue is a bounded ring buffer supporting a single producer and any
+  number of consumers. Pushing and popping are lock-free; a mutex is only
+  taken when a thread has to sleep, that is when pop() is called on an empty
+  queue or push() on a full queue in OverflowModeWait, and by the thread waking
+  it up.
 */
 
 template <class T> class DataQueue
@@ -57,6 +64,7 @@ public:
 
       If the queue is full and overflow mode is OverflowModeWait then this
       function will block until pop() is called.
+      Only one thread may push into the queue.
     */
     void push(const T &item);
 
@@ -64,78 +72,199 @@ public:
       Pops an item from the queue.
 
       If the queue is empty then this  function will block. If blocking is
-      undesired, then check the return of count() before calling pop().
+      undesired, then use tryPop().
     */
     T pop();
 
+    /*!
+      Pops an item from the queue if one is available, without blocking.
+      Returns false if the queue was empty.
+    */
+    bool tryPop(T &item);
+
     //! Returns the number of items in the queue.
     int count() const;
 
 private:
-    QList<T> m_queue;
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+    bool tryPush(const T &item);
+    bool tryPopInternal(T &item);
+    void wakeWaiters(std::atomic<int> &waiters, QWaitCondition &condition);
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_mask;
     int m_maxSize;
     OverflowMode m_mode;
-    mutable QMutex m_mutex;
+    // Keep producer and consumer positions on separate cache lines
+    char m_padding0[64];
+    std::atomic<size_t> m_pushPos;
+    char m_padding1[64];
+    std::atomic<size_t> m_popPos;
+    char m_padding2[64];
+    std::atomic<int> m_emptyWaiters;
+    std::atomic<int> m_fullWaiters;
+    QMutex m_mutex;
     QWaitCondition m_notEmptyCondition;
     QWaitCondition m_notFullCondition;
 };
 
 template <class T>
 DataQueue<T>::DataQueue(int maxSize, OverflowMode mode)
-    : m_queue()
-    , m_maxSize(maxSize)
+    : m_maxSize(qMax(1, maxSize))
     , m_mode(mode)
+    , m_padding0()
+    , m_pushPos(0)
+    , m_padding1()
+    , m_popPos(0)
+    , m_padding2()
+    , m_emptyWaiters(0)
+    , m_fullWaiters(0)
     , m_mutex()
     , m_notEmptyCondition()
     , m_notFullCondition()
 {
+    size_t capacity = 2;
+    while (capacity < size_t(m_maxSize)) {
+        capacity <<= 1;
+    }
+    m_mask = capacity - 1;
+    m_cells.reset(new Cell[capacity]);
+    for (size_t i = 0; i < capacity; ++i) {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
 }
 
 template <class T> DataQueue<T>::~DataQueue() = default;
 
+template <class T> bool DataQueue<T>::tryPush(const T &item)
+{
+    // Single producer: nobody else moves m_pushPos
+    const size_t pos = m_pushPos.load(std::memory_order_relaxed);
+    Cell &cell = m_cells[pos & m_mask];
+    if (cell.sequence.load(std::memory_order_acquire) != pos) {
+        // A consumer has not finished reading this cell yet
+        return false;
+    }
+    cell.data = item;
+    cell.sequence.store(pos + 1, std::memory_order_release);
+    m_pushPos.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <class T> bool DataQueue<T>::tryPop(T &item)
+{
+    if (!tryPopInternal(item)) {
+        return false;
+    }
+    if (m_mode == OverflowModeWait) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeWaiters(m_fullWaiters, m_notFullCondition);
+    }
+    return true;
+}
+
+template <class T> bool DataQueue<T>::tryPopInternal(T &item)
+{
+    size_t pos = m_popPos.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell &cell = m_cells[pos & m_mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto diff = std::ptrdiff_t(sequence) - std::ptrdiff_t(pos + 1);
+        if (diff == 0) {
+            if (m_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                item = std::move(cell.data);
+                cell.data = T();
+                // Hand the cell back to the producer for its next lap
+                cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // Empty
+            return false;
+        } else {
+            pos = m_popPos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class T> void DataQueue<T>::wakeWaiters(std::atomic<int> &waiters, QWaitCondition &condition)
+{
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+        QMutexLocker locker(&m_mutex);
+        condition.wakeAll();
+    }
+}
+
 template <class T> void DataQueue<T>::push(const T &item)
 {
-    m_mutex.lock();
-    if (m_queue.size() == m_maxSize) {
+    if (count() >= m_maxSize) {
         switch (m_mode) {
-        case OverflowModeDiscardOldest:
-            m_queue.removeFirst();
-            m_queue.append(item);
+        case OverflowModeDiscardOldest: {
+            // Make room ourselves, a consumer may have done it meanwhile
+            T discarded;
+            tryPopInternal(discarded);
             break;
+        }
         case OverflowModeDiscardNewest:
             // This item is the newest so discard it and exit
-            break;
+            return;
         case OverflowModeWait:
-            m_notFullCondition.wait(&m_mutex);
-            m_queue.append(item);
             break;
         }
-    } else {
-        m_queue.append(item);
-        if (m_queue.size() == 1) {
-            m_notEmptyCondition.wakeOne();
+    }
+    int spin = 0;
+    while (count() >= m_maxSize || !tryPush(item)) {
+        if (m_mode != OverflowModeWait) {
+            // A consumer is still copying the oldest cell, it will be released shortly
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        if (++spin < 64) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+        QMutexLocker locker(&m_mutex);
+        m_fullWaiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (count() >= m_maxSize) {
+            m_notFullCondition.wait(&m_mutex);
         }
+        m_fullWaiters.fetch_sub(1, std::memory_order_relaxed);
     }
-    m_mutex.unlock();
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    wakeWaiters(m_emptyWaiters, m_notEmptyCondition);
 }
 
 template <class T> T DataQueue<T>::pop()
 {
     T retVal;
-    m_mutex.lock();
-    if (m_queue.size() == 0) {
+    for (int spin = 0; spin < 64; ++spin) {
+        if (tryPop(retVal)) {
+            return retVal;
+        }
+        QThread::yieldCurrentThread();
+    }
+    QMutexLocker locker(&m_mutex);
+    m_emptyWaiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    while (!tryPopInternal(retVal)) {
         m_notEmptyCondition.wait(&m_mutex);
     }
-    retVal = m_queue.takeFirst();
-    if (m_mode == OverflowModeWait && m_queue.size() == m_maxSize - 1) {
-        m_notFullCondition.wakeOne();
+    m_emptyWaiters.fetch_sub(1, std::memory_order_relaxed);
+    locker.unlock();
+    if (m_mode == OverflowModeWait) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wakeWaiters(m_fullWaiters, m_notFullCondition);
     }
-    m_mutex.unlock();
     return retVal;
 }
 
 template <class T> int DataQueue<T>::count() const
 {
-    QMutexLocker locker(&m_mutex);
-    return m_queue.size();
+    const size_t popPos = m_popPos.load(std::memory_order_acquire);
+    const size_t pushPos = m_pushPos.load(std::memory_order_acquire);
+    return pushPos > popPos ? int(pushPos - popPos) : 0;
 }
@@ -33,10 +33,12 @@
 
 #include "bin/model/markersortmodel.h"
 #include "core.h"
+#include "framecache.h"
 #include "monitorproxy.h"
 #include "profiles/profilemodel.hpp"
 #include "timeline2/view/qml/timelineitems.h"
 #include "timeline2/view/qmltypes/thumbnailprovider.h"
+#include "utils/trace.h"
 #include "videowidget.h"
 #include <lib/localeHandling.h>
 #include <mlt++/Mlt.h>
@@ -112,6 +114,9 @@ VideoWidget::VideoWidget(int id, QObject *parent)
     quickWindow()->setPersistentSceneGraph(true);
     setResizeMode(QQuickWidget::SizeRootObjectToView);
 
+    if (m_id == Kdenlive::ClipMonitor) {
+        m_frameCache = std::make_unique<FrameCache>();
+    }
     m_refreshTimer.setSingleShot(true);
     m_refreshTimer.setInterval(10);
     m_blackClip.reset(new Mlt::Producer(pCore->getProjectProfile(), "color:0"));
@@ -298,6 +303,9 @@ bool VideoWidget::isReady() const
 void VideoWidget::requestSeek(int position, bool noAudioScrub)
 {
     m_producer->seek(position);
+    if (m_frameCache) {
+        m_frameCache->seeked(position, qFuzzyIsNull(m_producer->get_speed()));
+    }
     if (!m_consumer) {
         return;
     }
@@ -331,6 +339,10 @@ QString VideoWidget::frameToTime(int frames) const
 void VideoWidget::refresh()
 {
     m_refreshTimer.stop();
+    if (m_frameCache) {
+        // The displayed content changed
+        m_frameCache->clear();
+    }
     QMutexLocker locker(&m_mltMutex);
     if (m_consumer) {
         restartConsumer();
@@ -620,6 +632,9 @@ int VideoWidget::setProducer(const std::shared_ptr<Mlt::Producer> &producer, boo
     }
     m_producer->set_speed(0);
     m_proxy->setSpeed(0);
+    if (m_frameCache) {
+        m_frameCache->setProducer(m_producer);
+    }
     error = reconfigure();
     if (error == 0) {
         // The profile display aspect ratio may have changed.
@@ -646,6 +661,11 @@ int VideoWidget::setProducer(const std::shared_ptr<Mlt::Producer> &producer, boo
     return error;
 }
 
+FrameCache *VideoWidget::frameCache() const
+{
+    return m_frameCache.get();
+}
+
 int VideoWidget::droppedFrames() const
 {
     return (m_consumer ? m_consumer->get_int("drop_count") : 0);
@@ -736,6 +756,14 @@ int VideoWidget::reconfigure()
             m_consumer->connect(*m_producer.get());
             // m_producer->set_speed(0.0);
         }
+        if (m_frameCache) {
+            m_frameCache->setBudget(m_glslManager ? 0 : KdenliveSettings::clipMonitorFrameCache());
+            if (!m_glslManager && m_consumer->get_int("kdenlive:frame_cache") == 0) {
+                // Serve the images of recently displayed frames from memory
+                static_cast<Mlt::FilteredConsumer *>(m_consumer.get())->attach(m_frameCache->filter());
+                m_consumer->set("kdenlive:frame_cache", 1);
+            }
+        }
 
         int dropFrames = 1;
         if (!KdenliveSettings::monitor_dropframes()) {
@@ -939,6 +967,7 @@ void VideoWidget::resetConsumer(bool fullReset)
 
 void VideoWidget::on_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data data)
 {
+    KDENLIVE_TRACE("monitor", "frameShow");
     auto frame = Mlt::EventData(data).to_frame();
     if (frame.is_valid() && frame.get_int("rendered")) {
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
@@ -1001,6 +1030,7 @@ void FrameRenderer::requestImage()
 
 void FrameRenderer::showFrame(Mlt::Frame frame)
 {
+    KDENLIVE_TRACE("monitor", "FrameRenderer::showFrame");
     // Save this frame for future use and to keep a reference to the GL Texture.
     m_displayFrame = SharedFrame(frame);
     Q_EMIT frameDisplayed(m_displayFrame);
@@ -35,6 +35,7 @@ class Consumer;
 
 class RenderThread;
 class FrameRenderer;
+class FrameCache;
 class MonitorProxy;
 class MarkerSortModel;
 
@@ -91,6 +92,8 @@ public:
     void lockMonitor();
     void releaseMonitor();
     int droppedFrames() const;
+    /** @brief The decoded frame cache, only available in the clip monitor */
+    FrameCache *frameCache() const;
     void resetDrops();
     bool checkFrameNumber(int pos, bool isPlaying);
     /** @brief Return current timeline position */
@@ -234,6 +237,7 @@ private:
     MonitorProxy *m_proxy;
     std::unique_ptr<RenderThread> m_renderThread;
     std::shared_ptr<Mlt::Producer> m_blackClip;
+    std::unique_ptr<FrameCache> m_frameCache;
     static void on_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data);
     static void on_frame_render(mlt_consumer, VideoWidget *widget, mlt_frame frame);
     /*static void on_gl_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data data);
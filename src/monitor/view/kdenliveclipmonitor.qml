@@ -38,6 +38,7 @@ Item {
     property double offsety : 0
     property bool dropped: false
     property string fps: '-'
+    property string cacheStats
     property bool showMarkers: false
     property bool showTimecode: false
     property bool showFps: false
@@ -530,6 +531,23 @@ Item {
                     bottomMargin: overlayMargin
                 }
             }
+            Label {
+                id: frameCacheStats
+                font: fixedFont
+                objectName: "frameCacheStats"
+                color: "#ffffff"
+                padding: 2
+                background: Rectangle {
+                    color: "#66000000"
+                }
+                text: root.cacheStats
+                visible: root.showFps && root.cacheStats.length > 0
+                anchors {
+                    right: fpsdropped.visible ? fpsdropped.left : timecode.visible ? timecode.left : parent.right
+                    bottom: parent.bottom
+                    bottomMargin: overlayMargin
+                }
+            }
             Label {
                 id: labelSpeed
                 font: fixedFont
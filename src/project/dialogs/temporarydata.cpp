@@ -10,6 +10,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "core.h"
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
+#include "utils/cachebudget.h"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -173,6 +174,14 @@ TemporaryData::TemporaryData(KdenliveDoc *doc, bool currentProjectOnly, QWidget
         gCleanupSpin->setSuffix(i18np(" month", " months", KdenliveSettings::cleanCacheMonths()));
     });
 
+    // Previews and thumbnails budget
+    gBudgetSpin->setValue(KdenliveSettings::previewcachebudget());
+    connect(gBudgetSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this,
+            [](int value) { KdenliveSettings::setPreviewcachebudget(value); });
+    gBudgetApply->setEnabled(KdenliveSettings::previewcachebudget() > 0);
+    connect(gBudgetSpin, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), gBudgetApply, [this](int value) { gBudgetApply->setEnabled(value > 0); });
+    connect(gBudgetApply, &QToolButton::clicked, this, &TemporaryData::applyCacheBudget);
+
     // Setup help text
     help_cached->setToolTip(i18n("<b>Cached data</b> is composed of clip thumbnails and timeline preview videos. Deleting is safe, all data can be recreated "
                                  "on project opening.<br/><b>Backup data</b> is an archive of previous versions of your project files. Useful if you need to "
@@ -539,6 +548,31 @@ void TemporaryData::deleteCurrentCacheData(bool warn)
     }
 }
 
+void TemporaryData::applyCacheBudget()
+{
+    bool ok = false;
+    QDir global = m_doc->getCacheDir(SystemCacheRoot, &ok);
+    if (!ok) {
+        return;
+    }
+    // Never remove the previews used by the current project
+    QStringList used;
+    QDir preview = m_doc->getCacheDir(CachePreview, &ok);
+    if (ok) {
+        QDir chunks = m_doc->getCacheDir(CachePreviewChunks, &ok);
+        const QStringList indexed = CacheBudget::readChunkIndex(preview);
+        for (const QString &chunk : indexed) {
+            used << chunks.absoluteFilePath(chunk);
+        }
+    }
+    const qint64 freed = CacheBudget::evict(global, qint64(KdenliveSettings::previewcachebudget()) * 1048576, used);
+    if (freed == 0) {
+        KMessageBox::information(this, i18n("Previews and thumbnails already fit in the budget."));
+        return;
+    }
+    updateGlobalInfo();
+}
+
 void TemporaryData::openCacheFolder()
 {
     bool ok = false;
@@ -647,6 +681,9 @@ void TemporaryData::gotFolderSize(KJob *job)
         } else {
             item->setIcon(0, QIcon::fromTheme(QStringLiteral("dialog-close")));
         }
+    } else if (m_processingDirectory == QLatin1String("previewchunks")) {
+        item->setText(0, i18n("Shared timeline previews"));
+        item->setIcon(0, QIcon::fromTheme(QStringLiteral("preview-render-on")));
     } else {
         item->setText(0, m_processingDirectory);
         if (m_processingDirectory == QLatin1String("proxy")) {
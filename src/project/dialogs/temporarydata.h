@@ -129,6 +129,8 @@ private Q_SLOTS:
     void deleteSelected();
     void cleanCache();
     void cleanProxy();
+    /** @brief Remove the least recently used previews and thumbnails beyond the configured budget */
+    void applyCacheBudget();
     /** @brief
      * Cleanup cached data and backup
      **/
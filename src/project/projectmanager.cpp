@@ -35,8 +35,10 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "profiles/profilerepository.hpp"
 #include "project/notesplugin.h"
 #include "timeline2/model/builders/meltBuilder.hpp"
+#include "timeline2/view/qmltypes/thumbnailprovider.h"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/trace.h"
 
 #include <KActionCollection>
 #include <KConfigGroup>
@@ -412,7 +414,13 @@ bool ProjectManager::testSaveFileAs(const QString &outputFileName)
     pCore->projectItemModel()->saveDocumentProperties(docProperties, QMap<QString, QString>());
     // QString scene = m_activeTimelineModel->sceneList(saveFolder);
     int duration = m_activeTimelineModel->duration();
+    if (pCore->bin()) {
+        pCore->bin()->suspendSequenceRenders(true);
+    }
     QString scene = pCore->projectItemModel()->sceneList(saveFolder, QString(), m_activeTimelineModel->tractor(), duration).first;
+    if (pCore->bin()) {
+        pCore->bin()->suspendSequenceRenders(false);
+    }
     if (scene.isEmpty()) {
         qDebug() << "//////  ERROR writing EMPTY scene list to file: " << outputFileName;
         return false;
@@ -506,6 +514,8 @@ bool ProjectManager::closeCurrentDocument(bool saveChanges, bool quit)
         }
     }
     m_activeTimelineModel.reset();
+    // Release the thumbnail producers kept alive for the timeline
+    ThumbnailRenderer::get()->clear();
     // Release model shared pointers
     if (guiConstructed) {
         pCore->window()->cleanBins();
@@ -824,6 +834,7 @@ void ProjectManager::abortLoading()
 
 void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale, bool isBackup)
 {
+    KDENLIVE_TRACE("project", "doOpenFile");
     Q_ASSERT(m_project == nullptr);
     m_fileRevert->setEnabled(true);
     ThumbnailCache::get()->clearCache();
@@ -1056,6 +1067,7 @@ void ProjectManager::abortProjectLoad(const QUrl &url)
 
 void ProjectManager::doOpenFileHeadless(const QUrl &url)
 {
+    KDENLIVE_TRACE("project", "doOpenFileHeadless");
     Q_ASSERT(m_project == nullptr);
     QUndoGroup *undoGroup = new QUndoGroup();
     std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
@@ -1180,6 +1192,7 @@ void ProjectManager::slotAutoSave()
         // Dont start autosave if the project is still loading
         return;
     }
+    KDENLIVE_TRACE("project", "autoSave");
     prepareSave();
     QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
     QString scene = projectSceneList(saveFolder).first;
@@ -1217,11 +1230,18 @@ std::pair<QString, QString> ProjectManager::projectSceneList(const QString &outp
     if (pCore->mixer()) {
         pCore->mixer()->pauseMonitoring(true);
     }
+    // Rendered previews of nested sequences are cache files for monitor playback, save the sequences themselves
+    if (pCore->bin()) {
+        pCore->bin()->suspendSequenceRenders(true);
+    }
 
     // We must save from the primary timeline model
     int duration = pCore->window() ? pCore->window()->getCurrentTimeline()->controller()->duration() : m_activeTimelineModel->duration();
     std::pair<QString, QString> scene =
         pCore->projectItemModel()->sceneList(outputFolder, overlayData, m_activeTimelineModel->tractor(), duration, aspectRatio);
+    if (pCore->bin()) {
+        pCore->bin()->suspendSequenceRenders(false);
+    }
     if (pCore->mixer()) {
         pCore->mixer()->pauseMonitoring(false);
     }
@@ -1468,6 +1488,7 @@ void ProjectManager::requestBackup(const QString &errorMessage)
 
 bool ProjectManager::updateTimeline(bool createNewTab, const QString &chunks, const QString &dirty, const QDateTime &documentDate, bool enablePreview)
 {
+    KDENLIVE_TRACE("project", "updateTimeline");
     pCore->taskManager.slotCancelJobs();
     const QUuid uuid = m_project->uuid();
     QReadLocker lock(&pCore->xmlMutex);
@@ -0,0 +1,82 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderqueuescheduler.h"
+
+#include <QSet>
+
+namespace {
+const RenderQueueScheduler::Job *findJob(const std::vector<RenderQueueScheduler::Job> &queue, const QString &id)
+{
+    for (const auto &job : queue) {
+        if (job.id == id) {
+            return &job;
+        }
+    }
+    return nullptr;
+}
+} // namespace
+
+std::vector<size_t> RenderQueueScheduler::admit(const std::vector<Job> &queue, const Budget &budget)
+{
+    int usedThreads = 0;
+    int usedMemory = 0;
+    int running = 0;
+    QSet<QString> busyOutputs;
+    for (const auto &job : queue) {
+        if (job.state == State::Running) {
+            usedThreads += job.threads;
+            usedMemory += job.memory;
+            busyOutputs.insert(job.output);
+            running++;
+        }
+    }
+
+    std::vector<size_t> admitted;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const Job &job = queue.at(i);
+        if (job.state != State::Waiting) {
+            continue;
+        }
+        if (!job.dependsOn.isEmpty()) {
+            // A removed dependency is considered done
+            const Job *dependency = findJob(queue, job.dependsOn);
+            if (dependency && dependency->state != State::Done) {
+                continue;
+            }
+        }
+        if (busyOutputs.contains(job.output)) {
+            continue;
+        }
+        const bool fits = (budget.threads <= 0 || usedThreads + job.threads <= budget.threads) &&
+                          (budget.memory <= 0 || usedMemory + job.memory <= budget.memory);
+        if (!fits && running > 0) {
+            // Keep the queue order, this job will be the next one
+            break;
+        }
+        admitted.push_back(i);
+        usedThreads += job.threads;
+        usedMemory += job.memory;
+        busyOutputs.insert(job.output);
+        running++;
+    }
+    return admitted;
+}
+
+std::vector<size_t> RenderQueueScheduler::blocked(const std::vector<Job> &queue)
+{
+    std::vector<size_t> result;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const Job &job = queue.at(i);
+        if (job.state != State::Waiting || job.dependsOn.isEmpty()) {
+            continue;
+        }
+        const Job *dependency = findJob(queue, job.dependsOn);
+        if (dependency && dependency->state == State::Failed) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
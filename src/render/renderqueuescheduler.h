@@ -0,0 +1,49 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QString>
+#include <vector>
+
+/** @class RenderQueueScheduler
+    @brief Decides which jobs of the render queue can run at the same time.
+    Each job declares the CPU threads and memory it is expected to use. Waiting jobs are started in
+    queue order as long as the running jobs stay within the configured budgets; the first waiting job
+    that does not fit stops the admission, so a large job is never starved by smaller ones queued after it.
+    A job larger than the budget is started alone.
+ */
+class RenderQueueScheduler
+{
+public:
+    enum class State { Waiting, Running, Done, Failed };
+
+    struct Job
+    {
+        /** @brief Unique identifier of the job, usually its playlist */
+        QString id;
+        /** @brief Jobs writing the same file never run together */
+        QString output;
+        /** @brief Identifier of a job that has to be finished first (eg. the first pass of a two pass encoding) */
+        QString dependsOn;
+        State state = State::Waiting;
+        int threads = 1;
+        /** @brief Expected memory use in MB */
+        int memory = 0;
+    };
+
+    struct Budget
+    {
+        /** @brief Number of CPU threads for all running jobs, 0 for no limit */
+        int threads = 0;
+        /** @brief Memory in MB for all running jobs, 0 for no limit */
+        int memory = 0;
+    };
+
+    /** @brief Returns the indexes of the waiting jobs of @param queue which can be started now */
+    static std::vector<size_t> admit(const std::vector<Job> &queue, const Budget &budget);
+    /** @brief Returns the indexes of the waiting jobs which can never start because a job they depend on failed */
+    static std::vector<size_t> blocked(const std::vector<Job> &queue);
+};
@@ -14,6 +14,7 @@
 #include "xml/xml.hpp"
 
 #include <QTemporaryFile>
+#include <QThread>
 
 // TODO: remove, see generatePlaylistFile()
 #include <KMessageBox>
@@ -30,6 +31,14 @@ QStringList RenderRequest::argsByJob(const RenderJob &job)
     if (!job.subtitlePath.isEmpty()) {
         args << QStringLiteral("--subtitle") << job.subtitlePath;
     }
+    if (job.segments > 1) {
+        args << QStringLiteral("--segments") << QString::number(job.segments);
+    }
+    if (job.in >= 0) {
+        // Shared playlist, select our part of it
+        args << QStringLiteral("--in") << QString::number(job.in) << QStringLiteral("--out") << QString::number(job.out) << QStringLiteral("--output")
+             << job.outputPath;
+    }
     return args;
 }
 
@@ -99,6 +108,16 @@ void RenderRequest::setTwoPass(bool enabled)
     m_twoPass = enabled;
 }
 
+void RenderRequest::setSegmentCount(int count)
+{
+    m_segmentCount = qMax(1, count);
+}
+
+void RenderRequest::setParallelJobs(int count)
+{
+    m_parallelJobs = qMax(1, count);
+}
+
 void RenderRequest::setAudioFilePerTrack(bool enabled)
 {
     m_audioFilePerTrack = enabled;
@@ -216,6 +235,21 @@ std::vector<RenderRequest::RenderJob> RenderRequest::process()
 
     const QUuid currentUuid = pCore->currentTimelineId();
 
+    // Sections rendered concurrently share one playlist covering the whole range, each job then only
+    // selects its range and output. Two pass logs are named after the playlist target and scripts
+    // must stay self contained, so these keep one playlist per section.
+    const bool sharePlaylist = m_parallelJobs > 1 && sections.size() > 1 && !m_twoPass && !m_delayedRendering;
+    if (sharePlaylist) {
+        setDocGeneralParams(doc, m_boundingIn, m_boundingOut);
+        // Share the encoder threads between the concurrent jobs
+        QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
+        int threads = consumer.attribute(QStringLiteral("threads")).toInt();
+        if (threads <= 0) {
+            threads = QThread::idealThreadCount();
+        }
+        consumer.setAttribute(QStringLiteral("threads"), qMax(1, threads / m_parallelJobs));
+    }
+
     int i = 0;
 
     std::vector<RenderJob> jobs;
@@ -237,6 +271,17 @@ std::vector<RenderRequest::RenderJob> RenderRequest::process()
             project->generateRenderSubtitleFile(currentUuid, section.in, section.out, subtitleFile);
         }
 
+        if (sharePlaylist) {
+            const size_t first = jobs.size();
+            createRenderJobs(jobs, sectionDoc, playlistPath, outputPath, subtitleFile, currentUuid, i == 1);
+            for (size_t j = first; j < jobs.size(); ++j) {
+                jobs[j].in = section.in;
+                jobs[j].out = section.out;
+                jobs[j].parallel = m_parallelJobs;
+            }
+            continue;
+        }
+
         QString newPlaylistPath = playlistPath;
         newPlaylistPath = newPlaylistPath.replace(QStringLiteral(".mlt"), QString("-%1.mlt").arg(i));
         // QString newPlaylistPath = createEmptyTempFile(QStringLiteral("mlt")); // !!! This does not take the delayed rendering logic of generatePlaylistFile()
@@ -254,14 +299,14 @@ std::vector<RenderRequest::RenderJob> RenderRequest::process()
 }
 
 void RenderRequest::createRenderJobs(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistPath, QString outputPath,
-                                     const QString &subtitlePath, const QUuid &uuid)
+                                     const QString &subtitlePath, const QUuid &uuid, bool writePlaylists)
 {
     if (m_audioFilePerTrack) {
         if (m_delayedRendering) {
             addErrorMessage(i18n("Script rendering and multi track audio export can not be used together. Script will be saved without multi track export."));
             m_audioFilePerTrack = false;
         } else {
-            prepareMultiAudioFiles(jobs, doc, playlistPath, outputPath, uuid);
+            prepareMultiAudioFiles(jobs, doc, playlistPath, outputPath, uuid, writePlaylists);
             QDomElement consumer = doc.documentElement().firstChildElement(QStringLiteral("consumer"));
             // If we are exporting an audio format, stop here
             if (consumer.hasAttribute(QLatin1String("vn")) || consumer.hasAttribute(QLatin1String("video_off"))) {
@@ -282,6 +327,9 @@ void RenderRequest::createRenderJobs(std::vector<RenderJob> &jobs, const QDomDoc
     }
 
     int passes = m_twoPass ? 2 : 1;
+    // Segments are joined by stream copy, which is not possible for image sequences. Two pass
+    // statistics cover the whole file and scripts are run by the user, keep a single process there.
+    const int segments = (m_twoPass || m_delayedRendering || m_presetParams.isImageSequence()) ? 1 : m_segmentCount;
 
     for (int i = 0; i < passes; i++) {
         // clone the dom if this is not the first iteration (happens with two pass)
@@ -292,10 +340,15 @@ void RenderRequest::createRenderJobs(std::vector<RenderJob> &jobs, const QDomDoc
         job.playlistPath = playlistPath;
         job.outputPath = outputPath;
         job.subtitlePath = subtitlePath;
+        job.segments = segments;
         if (pass == 2) {
             job.playlistPath = QStringUtils::appendToFilename(job.playlistPath, QStringLiteral("-pass%1").arg(2));
+            job.dependsOn = playlistPath;
         }
         jobs.push_back(job);
+        if (!writePlaylists) {
+            continue;
+        }
 
         // get the consumer element
         QDomNodeList consumers = final.elementsByTagName(QStringLiteral("consumer"));
@@ -507,7 +560,7 @@ QStringList RenderRequest::getSectionsNames()
 }
 
 void RenderRequest::prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
-                                           const QUuid &uuid)
+                                           const QUuid &uuid, bool writePlaylists)
 {
     int audioCount = 0;
     QDomNodeList orginalTractors = doc.elementsByTagName(QStringLiteral("tractor"));
@@ -553,13 +606,7 @@ void RenderRequest::prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const Q
             continue;
         }
 
-        // init doc copy
-        bool switchToWav = false;
-        QDomDocument docCopy = doc.cloneNode(true).toDocument();
-        QDomElement consumer = docCopy.elementsByTagName(QStringLiteral("consumer")).at(0).toElement();
-        if (!consumer.hasAttribute(QLatin1String("video_off"))) {
-            switchToWav = true;
-        }
+        bool switchToWav = !doc.elementsByTagName(QStringLiteral("consumer")).at(0).toElement().hasAttribute(QLatin1String("video_off"));
 
         // setup filenames
         QString appendix = QString("_Audio_%1%2%3")
@@ -576,7 +623,14 @@ void RenderRequest::prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const Q
             job.outputPath = render.absoluteDir().absoluteFilePath(fileName);
         }
         jobs.push_back(job);
+        if (!writePlaylists) {
+            audioCount++;
+            continue;
+        }
 
+        // init doc copy
+        QDomDocument docCopy = doc.cloneNode(true).toDocument();
+        QDomElement consumer = docCopy.elementsByTagName(QStringLiteral("consumer")).at(0).toElement();
         consumer.setAttribute(QStringLiteral("target"), job.outputPath);
         if (switchToWav) {
             consumer.setAttribute(QStringLiteral("video_off"), QStringLiteral("1"));
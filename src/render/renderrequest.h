@@ -20,6 +20,15 @@ public:
         QString playlistPath;
         QString outputPath;
         QString subtitlePath;
+        /** @brief Number of time segments rendered in parallel and joined afterwards, 1 for a single process */
+        int segments = 1;
+        /** @brief Playlist of a job that has to be finished before this one can start, like the first pass of a two pass encoding */
+        QString dependsOn;
+        /** @brief Frame range to render when the playlist is shared by several jobs, -1 to use the range of the playlist */
+        int in = -1;
+        int out = -1;
+        /** @brief Number of jobs of the same export meant to render concurrently */
+        int parallel = 1;
     };
 
     /** @brief Set frame range that should be rendered
@@ -35,6 +44,14 @@ public:
     void setProxyRendering(bool enabled);
     void setEmbedSubtitles(bool enabled);
     void setTwoPass(bool enabled);
+    /** @brief Split the rendering of each output in @param count time segments rendered in parallel.
+     *  Ignored when it cannot be joined without re-encoding (two pass, image sequences, delayed rendering)
+     */
+    void setSegmentCount(int count);
+    /** @brief Render up to @param count guide sections at the same time.
+     *  The sections then share a single playlist and only differ by their range and output file.
+     */
+    void setParallelJobs(int count);
     void setAspectRatio(const QString &aspectRatio);
     void setAudioFilePerTrack(bool enabled);
     void setGuideParams(std::weak_ptr<MarkerListModel> model, bool enableMultiExport, int filterCategory);
@@ -75,6 +92,8 @@ private:
     bool m_guideMultiExport = false;
     int m_guideCategory = -1; /// category used as filter if @variable guideMultiExport is @value true
     bool m_twoPass = false;
+    int m_segmentCount = 1;
+    int m_parallelJobs = 1;
 
     QStringList m_errors;
 
@@ -82,8 +101,9 @@ private:
     void setDocTwoPassParams(int pass, QDomDocument &doc, const QString &outputFile);
     std::vector<RenderSection> getGuideSections();
 
+    /** @param writePlaylists if false, only create the jobs for playlists that were already written */
     static void prepareMultiAudioFiles(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistFile, const QString &targetFile,
-                                       const QUuid &uuid);
+                                       const QUuid &uuid, bool writePlaylists = true);
 
     static QString createEmptyTempFile(const QString &extension);
 
@@ -96,9 +116,10 @@ private:
     /** @brief Create Render jobs for a render section.
      *  There might be multiple jobs for one section for each pass in case of 2pass or each audio track in case of multi audio track export
      * @param jobs the vector to which the jobs will be added
+     * @param writePlaylists if false, the playlists were already written for a previous section and are shared
      */
     void createRenderJobs(std::vector<RenderJob> &jobs, const QDomDocument &doc, const QString &playlistPath, QString outputPath, const QString &subtitlePath,
-                          const QUuid &uuid);
+                          const QUuid &uuid, bool writePlaylists = true);
 
     void addErrorMessage(const QString &error);
 };
@@ -0,0 +1,401 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "renderservice.h"
+#include "core.h"
+#include "kdenlivesettings.h"
+#include "project/projectmanager.h"
+#include "render/renderrequest.h"
+#include "renderpresets/renderpresetrepository.hpp"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSysInfo>
+#include <QUrl>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <csignal>
+#endif
+#ifdef Q_OS_WIN
+#include <windows.h>
+#endif
+
+static const QString activeFolder = QStringLiteral("active");
+static const QString doneFolder = QStringLiteral("done");
+static const QString failedFolder = QStringLiteral("failed");
+static const QString statusFolder = QStringLiteral("status");
+
+namespace {
+bool processRunning(qint64 pid)
+{
+#ifdef Q_OS_UNIX
+    return ::kill(pid_t(pid), 0) == 0 || errno == EPERM;
+#elif defined(Q_OS_WIN)
+    HANDLE processHandle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, DWORD(pid));
+    if (!processHandle) {
+        return false;
+    }
+    DWORD exitCode = 0;
+    bool running = GetExitCodeProcess(processHandle, &exitCode) && exitCode == STILL_ACTIVE;
+    CloseHandle(processHandle);
+    return running;
+#else
+    Q_UNUSED(pid)
+    return true;
+#endif
+}
+} // namespace
+
+RenderService::RenderService(const QString &spoolPath, int maxProcesses, QObject *parent)
+    : QObject(parent)
+    , m_spool(spoolPath)
+    , m_maxProcesses(qMax(1, maxProcesses))
+{
+    m_scanTimer.setSingleShot(true);
+    m_scanTimer.setInterval(500);
+    connect(&m_scanTimer, &QTimer::timeout, this, &RenderService::scanSpool);
+    m_pollTimer.setInterval(5000);
+    connect(&m_pollTimer, &QTimer::timeout, this, &RenderService::scanSpool);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, &m_scanTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+}
+
+RenderService::~RenderService()
+{
+    for (auto &p : m_processes) {
+        p.process->kill();
+        p.process->waitForFinished();
+    }
+}
+
+bool RenderService::start()
+{
+    for (const QString &folder : {activeFolder, doneFolder, failedFolder, statusFolder}) {
+        if (!m_spool.mkpath(folder)) {
+            qCritical() << "Cannot create render spool folder" << m_spool.absoluteFilePath(folder);
+            return false;
+        }
+    }
+    // Jobs left over by a previous instance on this host are restarted, jobs claimed by other nodes sharing the spool are left alone
+    QDir active(m_spool.absoluteFilePath(activeFolder));
+    const QString host = QSysInfo::machineHostName();
+    for (const QString &file : active.entryList({QStringLiteral("*.json")}, QDir::Files)) {
+        const QString name = QFileInfo(file).completeBaseName();
+        const QStringList markers = active.entryList({QStringLiteral("%1@*.owner").arg(name)}, QDir::Files);
+        bool stale = markers.isEmpty();
+        for (const QString &marker : markers) {
+            // <name>@<host>@<pid>.owner
+            const QStringList owner = marker.mid(name.length() + 1).chopped(6).split(QLatin1Char('@'));
+            if (owner.size() == 2 && owner.at(0) == host && !processRunning(owner.at(1).toLongLong())) {
+                active.remove(marker);
+                stale = true;
+            }
+        }
+        if (stale) {
+            active.rename(file, m_spool.absoluteFilePath(file));
+        }
+    }
+    m_watcher.addPath(m_spool.absolutePath());
+    m_pollTimer.start();
+    qInfo() << "Render service watching" << m_spool.absolutePath() << "with" << m_maxProcesses << "concurrent render processes";
+    scanSpool();
+    return true;
+}
+
+void RenderService::scanSpool()
+{
+    if (m_stopping) {
+        return;
+    }
+    if (m_spool.exists(QStringLiteral("stop"))) {
+        m_spool.remove(QStringLiteral("stop"));
+        qInfo() << "Render service stop requested";
+        m_stopping = true;
+        m_pollTimer.stop();
+        checkStop();
+        return;
+    }
+    // Oldest descriptors first
+    const QStringList files = m_spool.entryList({QStringLiteral("*.json")}, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QString &file : files) {
+        // Renaming is atomic, so several services can share the same spool directory.
+        // The owner is recorded first so that a node starting meanwhile does not take the job back.
+        const QString name = QFileInfo(file).completeBaseName();
+        QFile marker(ownerMarker(name));
+        marker.open(QIODevice::WriteOnly);
+        marker.close();
+        if (!m_spool.rename(file, QStringLiteral("%1/%2").arg(activeFolder, file))) {
+            marker.remove();
+            continue;
+        }
+        QString error;
+        std::shared_ptr<Job> job = readJob(name, error);
+        if (!job) {
+            Job failed;
+            failed.name = name;
+            failed.queued = QDateTime::currentDateTime();
+            failed.error = error;
+            failed.state = QStringLiteral("failed");
+            writeStatus(failed);
+            m_spool.rename(QStringLiteral("%1/%2").arg(activeFolder, file), QStringLiteral("%1/%2").arg(failedFolder, file));
+            marker.remove();
+            qWarning() << "Invalid render job" << file << error;
+            continue;
+        }
+        writeStatus(*job);
+        m_waiting.push_back(job);
+    }
+    prepareNextJob();
+}
+
+std::shared_ptr<RenderService::Job> RenderService::readJob(const QString &name, QString &error) const
+{
+    QFile file(m_spool.absoluteFilePath(QStringLiteral("%1/%2.json").arg(activeFolder, name)));
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QStringLiteral("Cannot read job descriptor");
+        return nullptr;
+    }
+    QJsonParseError parseError;
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll(), &parseError).object();
+    if (parseError.error != QJsonParseError::NoError) {
+        error = parseError.errorString();
+        return nullptr;
+    }
+    auto job = std::make_shared<Job>();
+    job->name = name;
+    job->project = json.value(QStringLiteral("project")).toString();
+    job->output = json.value(QStringLiteral("output")).toString();
+    job->preset = json.value(QStringLiteral("preset")).toString(QStringLiteral("MP4-H264/AAC"));
+    job->in = json.value(QStringLiteral("in")).toInt(-1);
+    job->out = json.value(QStringLiteral("out")).toInt(-1);
+    job->queued = QDateTime::currentDateTime();
+    job->state = QStringLiteral("queued");
+    if (job->project.isEmpty() || !QFileInfo::exists(job->project)) {
+        error = QStringLiteral("Project file not found: %1").arg(job->project);
+        return nullptr;
+    }
+    if (job->output.isEmpty()) {
+        error = QStringLiteral("No output file");
+        return nullptr;
+    }
+    if (!RenderPresetRepository::get()->presetExists(job->preset)) {
+        error = QStringLiteral("Unknown render preset: %1").arg(job->preset);
+        return nullptr;
+    }
+    return job;
+}
+
+void RenderService::prepareNextJob()
+{
+    if (m_preparing) {
+        return;
+    }
+    // Keep just enough prepared jobs to feed the render processes
+    size_t pending = 0;
+    for (const auto &job : m_rendering) {
+        pending += job->pending.size();
+    }
+    while (!m_waiting.empty() && pending < size_t(m_maxProcesses)) {
+        std::shared_ptr<Job> job = m_waiting.front();
+        m_waiting.pop_front();
+        m_preparing = true;
+        bool success = prepareJob(job);
+        m_preparing = false;
+        if (!success) {
+            finishJob(job, false);
+            continue;
+        }
+        m_rendering.push_back(job);
+        pending += job->pending.size();
+        startProcesses();
+    }
+    checkStop();
+}
+
+bool RenderService::prepareJob(const std::shared_ptr<Job> &job)
+{
+    QElapsedTimer timer;
+    timer.start();
+    job->started = QDateTime::currentDateTime();
+    job->state = QStringLiteral("preparing");
+    writeStatus(*job);
+
+    ProjectManager *manager = pCore->projectManager();
+    if (pCore->currentDoc()) {
+        manager->closeCurrentDocument(false, false);
+    }
+    manager->doOpenFileHeadless(QUrl::fromLocalFile(QFileInfo(job->project).absoluteFilePath()));
+    qApp->processEvents();
+    if (!pCore->currentDoc()) {
+        job->error = QStringLiteral("Cannot open project");
+        return false;
+    }
+
+    std::vector<RenderRequest::RenderJob> renderJobs;
+    {
+        RenderRequest request;
+        request.setOutputFile(QFileInfo(job->output).absoluteFilePath());
+        request.loadPresetParams(job->preset);
+        request.setDelayedRendering(false);
+        request.setProxyRendering(false);
+        request.setEmbedSubtitles(false);
+        request.setTwoPass(false);
+        request.setAudioFilePerTrack(false);
+        request.setOverlayData(QString());
+        request.setBounds(job->in, job->out);
+        renderJobs = request.process();
+        if (!request.errorMessages().isEmpty()) {
+            job->error = request.errorMessages().join(QLatin1Char('\n'));
+        }
+    }
+    // The playlists are written, release the project while rendering
+    manager->closeCurrentDocument(false, false);
+    job->prepareMs = timer.elapsed();
+    if (renderJobs.empty()) {
+        if (job->error.isEmpty()) {
+            job->error = QStringLiteral("Nothing to render");
+        }
+        return false;
+    }
+    for (const auto &renderJob : renderJobs) {
+        job->pending.emplace_back(renderJob.outputPath, RenderRequest::argsByJob(renderJob));
+    }
+    job->state = QStringLiteral("rendering");
+    writeStatus(*job);
+    return true;
+}
+
+void RenderService::startProcesses()
+{
+    for (const auto &job : m_rendering) {
+        while (!job->pending.empty() && m_processes.size() < size_t(m_maxProcesses)) {
+            Process p;
+            p.job = job;
+            p.output = job->pending.front().first;
+            const QStringList args = job->pending.front().second;
+            job->pending.pop_front();
+            p.process = new QProcess(this);
+            p.process->setProcessChannelMode(QProcess::ForwardedChannels);
+            QProcess *process = p.process;
+            connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                    [this, process](int exitCode, QProcess::ExitStatus exitStatus) { processFinished(process, exitCode, exitStatus); });
+            // Queued, this can be emitted from start() while we iterate the jobs
+            connect(
+                process, &QProcess::errorOccurred, this,
+                [this, process](QProcess::ProcessError error) {
+                    if (error == QProcess::FailedToStart) {
+                        processFinished(process, -1, QProcess::CrashExit);
+                    }
+                },
+                Qt::QueuedConnection);
+            if (job->running == 0 && !job->renderTimer.isValid()) {
+                job->renderTimer.start();
+            }
+            job->running++;
+            p.timer.start();
+            m_processes.push_back(p);
+            process->start(KdenliveSettings::kdenliverendererpath(), args);
+        }
+    }
+}
+
+void RenderService::processFinished(QProcess *process, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    auto it = std::find_if(m_processes.begin(), m_processes.end(), [process](const Process &p) { return p.process == process; });
+    if (it == m_processes.end()) {
+        return;
+    }
+    Process p = *it;
+    m_processes.erase(it);
+    process->deleteLater();
+
+    // kdenlive_render does not always report failures in its exit code, also check the output
+    const bool success = exitStatus == QProcess::NormalExit && exitCode == 0 && QFileInfo(p.output).size() > 0;
+    QJsonObject output;
+    output.insert(QStringLiteral("file"), p.output);
+    output.insert(QStringLiteral("exitCode"), exitCode);
+    output.insert(QStringLiteral("success"), success);
+    output.insert(QStringLiteral("renderMs"), p.timer.elapsed());
+    p.job->outputs.append(output);
+    p.job->running--;
+    if (!success) {
+        p.job->error = QStringLiteral("Rendering of %1 failed").arg(p.output);
+    }
+    if (p.job->running == 0 && p.job->pending.empty()) {
+        m_rendering.erase(std::find(m_rendering.begin(), m_rendering.end(), p.job));
+        finishJob(p.job, p.job->error.isEmpty());
+    } else {
+        writeStatus(*p.job);
+    }
+    startProcesses();
+    prepareNextJob();
+}
+
+void RenderService::finishJob(const std::shared_ptr<Job> &job, bool success)
+{
+    job->ended = QDateTime::currentDateTime();
+    job->state = success ? QStringLiteral("finished") : QStringLiteral("failed");
+    writeStatus(*job);
+    const QString file = job->name + QStringLiteral(".json");
+    m_spool.rename(QStringLiteral("%1/%2").arg(activeFolder, file), QStringLiteral("%1/%2").arg(success ? doneFolder : failedFolder, file));
+    QFile::remove(ownerMarker(job->name));
+    qInfo() << "Render job" << job->name << job->state;
+}
+
+QString RenderService::ownerMarker(const QString &name) const
+{
+    return m_spool.absoluteFilePath(
+        QStringLiteral("%1/%2@%3@%4.owner").arg(activeFolder, name, QSysInfo::machineHostName()).arg(QCoreApplication::applicationPid()));
+}
+
+void RenderService::writeStatus(const Job &job) const
+{
+    QJsonObject json;
+    json.insert(QStringLiteral("job"), job.name);
+    json.insert(QStringLiteral("state"), job.state);
+    json.insert(QStringLiteral("project"), job.project);
+    json.insert(QStringLiteral("output"), job.output);
+    json.insert(QStringLiteral("preset"), job.preset);
+    json.insert(QStringLiteral("pid"), QCoreApplication::applicationPid());
+    json.insert(QStringLiteral("queued"), job.queued.toString(Qt::ISODateWithMs));
+    if (job.started.isValid()) {
+        json.insert(QStringLiteral("started"), job.started.toString(Qt::ISODateWithMs));
+        json.insert(QStringLiteral("waitMs"), job.queued.msecsTo(job.started));
+        json.insert(QStringLiteral("prepareMs"), job.prepareMs);
+    }
+    if (job.renderTimer.isValid()) {
+        json.insert(QStringLiteral("renderMs"), job.renderTimer.elapsed());
+    }
+    if (job.ended.isValid()) {
+        json.insert(QStringLiteral("finished"), job.ended.toString(Qt::ISODateWithMs));
+        json.insert(QStringLiteral("totalMs"), job.queued.msecsTo(job.ended));
+    }
+    if (!job.outputs.isEmpty()) {
+        json.insert(QStringLiteral("outputs"), job.outputs);
+    }
+    if (!job.error.isEmpty()) {
+        json.insert(QStringLiteral("error"), job.error);
+    }
+    // Write to a temporary file and rename it, so that readers never see a partial status
+    QSaveFile file(m_spool.absoluteFilePath(QStringLiteral("%1/%2.json").arg(statusFolder, job.name)));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write render status file" << file.fileName();
+        return;
+    }
+    file.write(QJsonDocument(json).toJson());
+    file.commit();
+}
+
+void RenderService::checkStop()
+{
+    if (m_stopping && !m_preparing && m_waiting.empty() && m_rendering.empty() && m_processes.empty()) {
+        Q_EMIT finished();
+    }
+}
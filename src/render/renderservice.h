@@ -0,0 +1,106 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QJsonArray>
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+/** @class RenderService
+    @brief Long running headless renderer processing job descriptors dropped in a spool directory.
+    A job descriptor is a JSON file placed in the spool directory:
+    @code
+    {"project": "/path/to/project.kdenlive", "output": "/path/to/output.mp4", "preset": "MP4-H264/AAC", "in": 0, "out": 250}
+    @endcode
+    Only "project" and "output" are mandatory. The descriptor is moved to the "active" sub folder when it is picked up,
+    along with a marker naming the host and process rendering it, then to "done" or "failed". On startup, only the
+    active jobs of processes of the same host that are no longer running are queued again. A status file with the same name is kept up to date in the "status" sub folder, it
+    contains the state of the job and the time spent preparing and rendering it.
+    MLT and the asset repositories are initialized once for all jobs. Projects are opened one at a time to generate
+    their playlists, then closed while the render processes of several jobs run concurrently.
+    Creating a file named "stop" in the spool directory ends the service once the running jobs are finished.
+ */
+class RenderService : public QObject
+{
+    Q_OBJECT
+
+public:
+    /** @param maxProcesses maximum number of render processes running at the same time */
+    RenderService(const QString &spoolPath, int maxProcesses, QObject *parent = nullptr);
+    ~RenderService() override;
+    /** @brief Create the spool folders and start watching for jobs. Returns false if the spool directory is not usable */
+    bool start();
+
+Q_SIGNALS:
+    /** @brief A stop was requested and all jobs are over */
+    void finished();
+
+private Q_SLOTS:
+    void scanSpool();
+    void prepareNextJob();
+
+private:
+    struct Job
+    {
+        QString name;
+        QString project;
+        QString output;
+        QString preset;
+        int in = -1;
+        int out = -1;
+        QString state;
+        QString error;
+        QDateTime queued;
+        QDateTime started;
+        QDateTime ended;
+        qint64 prepareMs = 0;
+        QElapsedTimer renderTimer;
+        /** @brief Output file and arguments of the render processes of the job not started yet */
+        std::deque<std::pair<QString, QStringList>> pending;
+        int running = 0;
+        QJsonArray outputs;
+    };
+    struct Process
+    {
+        std::shared_ptr<Job> job;
+        QString output;
+        QProcess *process = nullptr;
+        QElapsedTimer timer;
+    };
+    QDir m_spool;
+    int m_maxProcesses;
+    QFileSystemWatcher m_watcher;
+    /** @brief Delay the scan after a change so that descriptors being copied are complete */
+    QTimer m_scanTimer;
+    /** @brief Rescan regularly, change notifications are not available on all (network) file systems */
+    QTimer m_pollTimer;
+    std::deque<std::shared_ptr<Job>> m_waiting;
+    std::vector<std::shared_ptr<Job>> m_rendering;
+    std::vector<Process> m_processes;
+    bool m_preparing = false;
+    bool m_stopping = false;
+
+    /** @brief Read a descriptor moved to the active folder */
+    std::shared_ptr<Job> readJob(const QString &name, QString &error) const;
+    /** @brief Open the project and generate the playlists of @param job, returns false on failure */
+    bool prepareJob(const std::shared_ptr<Job> &job);
+    void startProcesses();
+    void processFinished(QProcess *process, int exitCode, QProcess::ExitStatus exitStatus);
+    void finishJob(const std::shared_ptr<Job> &job, bool success);
+    /** @brief The file marking a job of the active folder as rendered by this process, named <job>@<host>@<pid>.owner */
+    QString ownerMarker(const QString &name) const;
+    void writeStatus(const Job &job) const;
+    void checkStop();
+};
@@ -15,6 +15,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KConfigGroup>
 #include <KSharedConfig>
 
+#include <cstring>
+
 // Defines the number of FFT samples to store.
 // Around 4 kB for a window size of 2000. Should be at least as large as the
 // highest vertical screen resolution available for complete reconstruction.
@@ -35,8 +37,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 Spectrogram::Spectrogram(QWidget *parent)
     : AbstractAudioScopeWidget(true, parent)
     , m_fftTools()
-    , m_fftHistory()
-    , m_fftHistoryImg()
+    , m_fftHistory(SPECTROGRAM_HISTORY_SIZE)
 
 {
     m_ui = new Ui::Spectrogram_UI;
@@ -324,20 +325,15 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
         m_ui->labelFFTSizeNumber->setText(QVariant(fftWindow).toString());
 
         if (newDataAvailable) {
-
-            auto *freqSpectrum = new float[uint(fftWindow / 2)];
-
+            if (m_fftHistory.binCount() != fftWindow / 2) {
+                // Rows of different window sizes cannot be displayed together
+                m_fftHistory.reset(fftWindow / 2);
+                m_parameterChanged = true;
+            }
             // Get the spectral power distribution of the input samples,
-            // using the given window size and function
+            // using the given window size and function, directly into the history
             FFTTools::WindowType windowType = FFTTools::WindowType(m_ui->windowFunction->itemData(m_ui->windowFunction->currentIndex()).toInt());
-            m_fftTools.fftNormalized(audioFrame, 0, uint(num_channels), freqSpectrum, windowType, uint(fftWindow), 0);
-
-            // This method might be called also when a simple refresh is required.
-            // In this case there is no data to append to the history. Only append new data.
-            QVector<float> spectrumVector(fftWindow / 2);
-            memcpy(spectrumVector.data(), &freqSpectrum[0], uint(fftWindow) / 2 * sizeof(float));
-            m_fftHistory.prepend(spectrumVector);
-            delete[] freqSpectrum;
+            m_fftTools.fftNormalized(audioFrame, 0, uint(num_channels), m_fftHistory.append(), windowType, uint(fftWindow), 0);
         }
 #ifdef DEBUG_SPECTROGRAM
         else {
@@ -345,103 +341,90 @@ QImage Spectrogram::renderAudioScope(uint, const audioShortVector &audioFrame, c
         }
 #endif
 
-        // Limit the maximum history size to avoid wasting space
-        while (m_fftHistory.size() > SPECTROGRAM_HISTORY_SIZE) {
-            m_fftHistory.removeLast();
-        }
-
-        // Draw the spectrum
-        QImage spectrum(m_scopeRect.size(), QImage::Format_ARGB32);
-        spectrum.fill(qRgba(0, 0, 0, 0));
-
-        QPainter davinci;
-        bool ok = davinci.begin(&spectrum);
-        if (!ok) {
-            qDebug() << "Warning: Could not initialise QPainter for rendering spectrogram.";
-            return spectrum;
-        }
-
         const int h = m_innerScopeRect.height();
-        const int leftDist = m_innerScopeRect.left() - m_scopeRect.left();
         const int topDist = m_innerScopeRect.top() - m_scopeRect.top();
-        int y;
-        bool completeRedraw = true;
+        const QImage &previous = m_fftHistoryImg[m_currentImg];
+        if (!newDataAvailable && !m_parameterChanged && previous.size() == m_scopeRect.size()) {
+            // Simple refresh, nothing changed
+            Q_EMIT signalScopeRenderingFinished(uint(timer.elapsed()), 1);
+            return previous;
+        }
 
-        if (m_fftHistoryImg.size() == m_scopeRect.size() && !m_parameterChanged) {
+        // Render into the image which is not displayed. If it is still referenced elsewhere,
+        // writing into it detaches it, so the displayed image is never modified.
+        m_currentImg = 1 - m_currentImg;
+        QImage &spectrum = m_fftHistoryImg[m_currentImg];
+        bool completeRedraw = m_parameterChanged || previous.size() != m_scopeRect.size();
+        if (spectrum.size() != m_scopeRect.size()) {
+            spectrum = QImage(m_scopeRect.size(), QImage::Format_ARGB32);
+            completeRedraw = true;
+        }
+        m_parameterChanged = false;
+        m_dbMap.resize(m_innerScopeRect.width());
+
+        int y = 0;
+        if (completeRedraw) {
+            spectrum.fill(qRgba(0, 0, 0, 0));
+            const int rows = qMin(h, m_fftHistory.size());
+            for (; y < rows; ++y) {
+                drawHistoryRow(spectrum, y, y);
+            }
+        } else {
             // The size of the widget and the parameters (like min/max dB) have not changed since last time,
-            // so we can re-use it, shift it by one pixel, and render the single remaining line. Usually about
-            // 10 times faster for a widget height of around 400 px.
-            if (newDataAvailable) {
-                davinci.drawImage(0, -1, m_fftHistoryImg);
-            } else {
-                // spectrum = m_fftHistoryImg does NOT work, leads to segfaults (anyone knows why, please tell me)
-                davinci.drawImage(0, 0, m_fftHistoryImg);
+            // so we can re-use the previous image shifted by one line, and render the single remaining line.
+            // Only the lines of the inner scope rect are moved; they are contiguous in memory.
+            if (h > 1) {
+                memcpy(spectrum.scanLine(topDist), previous.constScanLine(topDist + 1), size_t(spectrum.bytesPerLine()) * size_t(h - 1));
             }
-            completeRedraw = false;
-        }
-
-        y = 0;
-        if ((newData != 0) || m_parameterChanged) {
-            m_parameterChanged = false;
-
-            QVector<float> dbMap;
-            uint right;
-            ////////////////FIXME
-            for (auto &it : m_fftHistory) {
-
-                int windowSize = it.size();
-
-                // Interpolate the frequency data to match the pixel coordinates
-                right = uint(m_freqMax / (m_freq / 2.f) * (windowSize - 1));
-                dbMap = FFTTools::interpolatePeakPreserving(it, uint(m_innerScopeRect.width()), 0, right, -180);
-
-                for (int i = 0; i < dbMap.size(); ++i) {
-                    float val;
-                    val = dbMap[i];
-                    bool peak = val > m_dBmax;
-
-                    // Normalize dB value to [0 1], 1 corresponding to dbMax dB and 0 to dbMin dB
-                    val = (val - m_dBmax) / (m_dBmax - m_dBmin) + 1.f;
-                    if (val < 0) {
-                        val = 0;
-                    } else if (val > 1) {
-                        val = 1;
-                    }
-                    if (!peak || !m_aHighlightPeaks->isChecked()) {
-                        spectrum.setPixel(leftDist + i, topDist + h - 1 - y, m_colorMap[int(val * 255)]);
-                    } else {
-                        spectrum.setPixel(leftDist + i, topDist + h - 1 - y, AbstractScopeWidget::colHighlightDark.rgba());
-                    }
-                }
-
-                y++;
-                if (y >= topDist + m_innerScopeRect.height()) {
-                    break;
-                }
-                if (!completeRedraw) {
-                    break;
-                }
+            if (m_fftHistory.size() > 0) {
+                drawHistoryRow(spectrum, 0, 0);
+                y = 1;
             }
         }
 
 #ifdef DEBUG_SPECTROGRAM
-        qCDebug(KDENLIVE_LOG) << "Rendered " << y - topDist << "lines from " << m_fftHistory.size() << " available samples in " << start.elapsed() << " ms"
+        qCDebug(KDENLIVE_LOG) << "Rendered " << y << "lines from " << m_fftHistory.size() << " available samples in " << timer.elapsed() << " ms"
                               << (completeRedraw ? "" : " (re-used old image)");
-        uint storedBytes = 0;
-        for (QList<QVector<float>>::iterator it = m_fftHistory.begin(); it != m_fftHistory.end(); ++it) {
-            storedBytes += (*it).size() * sizeof((*it)[0]);
-        }
-        qCDebug(KDENLIVE_LOG) << QString("Total storage used: %1 kB").arg((double)storedBytes / 1000, 0, 'f', 2);
+        qCDebug(KDENLIVE_LOG) << QString("Total storage used: %1 kB").arg(double(m_fftHistory.capacity()) * m_fftHistory.binCount() * sizeof(float) / 1000, 0, 'f', 2);
 #endif
 
-        m_fftHistoryImg = spectrum;
-
         Q_EMIT signalScopeRenderingFinished(uint(timer.elapsed()), 1);
         return spectrum;
     }
     Q_EMIT signalScopeRenderingFinished(0, 1);
     return QImage();
 }
+
+void Spectrogram::drawHistoryRow(QImage &image, int age, int y)
+{
+    const int leftDist = m_innerScopeRect.left() - m_scopeRect.left();
+    const int topDist = m_innerScopeRect.top() - m_scopeRect.top();
+    const int binCount = m_fftHistory.binCount();
+    const bool highlightPeaks = m_aHighlightPeaks->isChecked();
+    const QRgb highlightColor = AbstractScopeWidget::colHighlightDark.rgba();
+
+    // Interpolate the frequency data to match the pixel coordinates
+    const uint right = uint(m_freqMax / (m_freq / 2.f) * (binCount - 1));
+    FFTTools::interpolatePeakPreserving(m_fftHistory.row(age), binCount, m_dbMap.data(), uint(m_dbMap.size()), 0, right, -180);
+
+    auto *line = reinterpret_cast<QRgb *>(image.scanLine(topDist + m_innerScopeRect.height() - 1 - y)) + leftDist;
+    for (int i = 0; i < m_dbMap.size(); ++i) {
+        float val = m_dbMap.at(i);
+        if (highlightPeaks && val > m_dBmax) {
+            line[i] = highlightColor;
+            continue;
+        }
+        // Normalize dB value to [0 1], 1 corresponding to dbMax dB and 0 to dbMin dB
+        val = (val - m_dBmax) / (m_dBmax - m_dBmin) + 1.f;
+        if (val < 0) {
+            val = 0;
+        } else if (val > 1) {
+            val = 1;
+        }
+        line[i] = m_colorMap[int(val * 255)];
+    }
+}
+
 QImage Spectrogram::renderBackground(uint)
 {
     return QImage();
@@ -9,6 +9,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstractaudioscopewidget.h"
 #include "lib/audio/fftTools.h"
+#include "spectrogramhistory.h"
 #include "ui_spectrogram_ui.h"
 
 class Spectrogram_UI;
@@ -19,9 +20,10 @@ class Spectrogram_UI;
 
     The Spectrogram makes use of two caches:
     * A cached image where only the most recent line needs to be appended instead of
-      having to recalculate the whole image. A typical speedup factor is 10x.
-    * A FFT cache storing a history of previous spectral power distributions (i.e.
-      the Fourier-transformed audio signals). This is used if the user adjusts parameters
+      having to recalculate the whole image. Two images are used alternately, the new
+      one is the previous one moved up by one line with a single memory copy.
+    * A FFT cache storing a fixed-size history of previous spectral power distributions (i.e.
+      the Fourier-transformed audio signals, see SpectrogramHistory). This is used if the user adjusts parameters
       like the maximum frequency to display or minimum/maximum signal strength in dB.
       All required information is preserved in the FFT history, which would not be the
       case for an image (consider re-sizing the widget to 100x100 px and then back to
@@ -60,8 +62,12 @@ private:
     QAction *m_aTrackMouse;
     QAction *m_aHighlightPeaks;
 
-    QList<QVector<float>> m_fftHistory;
-    QImage m_fftHistoryImg;
+    SpectrogramHistory m_fftHistory;
+    QImage m_fftHistoryImg[2];
+    /** @brief Index of the image in m_fftHistoryImg which was rendered last */
+    int m_currentImg{0};
+    /** @brief Interpolated dB values of the line being drawn */
+    QVector<float> m_dbMap;
 
     int m_dBmin{-70};
     int m_dBmax{0};
@@ -74,6 +80,9 @@ private:
     QRect m_innerScopeRect;
     QRgb m_colorMap[256];
 
+    /** @brief Draw the history row of the given @param age at line @param y (0 being the bottom line) of the inner scope rect */
+    void drawHistoryRow(QImage &image, int age, int y);
+
 private Q_SLOTS:
     void slotResetMaxFreq();
 };
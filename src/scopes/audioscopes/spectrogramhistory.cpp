@@ -0,0 +1,53 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "spectrogramhistory.h"
+
+#include <QtGlobal>
+
+SpectrogramHistory::SpectrogramHistory(int capacity)
+    : m_capacity(qMax(1, capacity))
+{
+}
+
+void SpectrogramHistory::reset(int binCount)
+{
+    m_binCount = qMax(0, binCount);
+    // Keeps the allocation if the buffer is already large enough
+    m_data.resize(size_t(m_capacity) * size_t(m_binCount));
+    m_head = -1;
+    m_size = 0;
+}
+
+float *SpectrogramHistory::append()
+{
+    m_head = (m_head + 1) % m_capacity;
+    if (m_size < m_capacity) {
+        m_size++;
+    }
+    return m_data.data() + size_t(m_head) * size_t(m_binCount);
+}
+
+const float *SpectrogramHistory::row(int age) const
+{
+    Q_ASSERT(age >= 0 && age < m_size);
+    const int index = (m_head - age + m_capacity) % m_capacity;
+    return m_data.data() + size_t(index) * size_t(m_binCount);
+}
+
+int SpectrogramHistory::size() const
+{
+    return m_size;
+}
+
+int SpectrogramHistory::capacity() const
+{
+    return m_capacity;
+}
+
+int SpectrogramHistory::binCount() const
+{
+    return m_binCount;
+}
@@ -0,0 +1,39 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <vector>
+
+/** @class SpectrogramHistory
+    @brief Fixed-capacity history of spectral power distributions used by the Spectrogram.
+    All rows are stored in one contiguous buffer used as a ring, so appending a new FFT result
+    neither allocates memory nor moves older rows. All rows have the same number of bins;
+    changing it discards the history.
+ */
+class SpectrogramHistory
+{
+public:
+    explicit SpectrogramHistory(int capacity);
+    /** @brief Discard all rows and use @param binCount bins per row from now on */
+    void reset(int binCount);
+    /** @brief Make room for a new row, discarding the oldest one if the history is full.
+        @returns the row to fill with binCount() values */
+    float *append();
+    /** @brief Returns a stored row, @param age being 0 for the most recent one and size() - 1 for the oldest */
+    const float *row(int age) const;
+    /** @brief Number of rows currently stored */
+    int size() const;
+    int capacity() const;
+    int binCount() const;
+
+private:
+    std::vector<float> m_data;
+    int m_capacity;
+    int m_binCount{0};
+    /** @brief Index of the most recent row */
+    int m_head{-1};
+    int m_size{0};
+};
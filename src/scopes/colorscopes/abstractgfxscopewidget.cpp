@@ -9,6 +9,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "monitor/monitormanager.h"
 
 #include <QMouseEvent>
+#include <cstring>
 
 // Uncomment for debugging.
 //#define DEBUG_AGSW
@@ -23,10 +24,64 @@ AbstractGfxScopeWidget::AbstractGfxScopeWidget(bool trackMouse, QWidget *parent)
 
 AbstractGfxScopeWidget::~AbstractGfxScopeWidget() = default;
 
+mlt_image_format AbstractGfxScopeWidget::requestedImageFormat(const SharedFrame &) const
+{
+    return mlt_image_rgba;
+}
+
+int AbstractGfxScopeWidget::requestedDecimation() const
+{
+    return 1;
+}
+
 QImage AbstractGfxScopeWidget::renderScope(uint accelerationFactor)
 {
+    // Copies are cheap (implicitly shared), don't block the GUI thread while rendering
     QMutexLocker lock(&m_mutex);
-    return renderGfxScope(accelerationFactor, m_scopeImage);
+    const SharedFrame frame = m_scopeFrame;
+    const QImage image = m_scopeImage;
+    lock.unlock();
+    if (frame.is_valid()) {
+        return renderGfxScopeFromFrame(accelerationFactor, frame);
+    }
+    return renderGfxScope(accelerationFactor, image);
+}
+
+QImage AbstractGfxScopeWidget::renderGfxScopeFromFrame(uint accelerationFactor, const SharedFrame &frame)
+{
+    return renderGfxScope(accelerationFactor, frameToImage(frame, requestedDecimation(), requestedImageFormat(frame)));
+}
+
+QImage AbstractGfxScopeWidget::frameToImage(const SharedFrame &frame, int decimation, mlt_image_format format)
+{
+    // Only packed RGB formats can be wrapped in a QImage
+    if (format != mlt_image_rgb) {
+        format = mlt_image_rgba;
+    }
+    const uint8_t *image = frame.get_image(format);
+    if (image == nullptr) {
+        return QImage();
+    }
+    const int width = frame.get_image_width();
+    const int height = frame.get_image_height();
+    const int bytesPerPixel = format == mlt_image_rgb ? 3 : 4;
+    const QImage::Format imageFormat = format == mlt_image_rgb ? QImage::Format_RGB888 : QImage::Format_RGBA8888;
+    if (decimation <= 1) {
+        // The frame is kept alive by the caller, no need for a deep copy
+        return QImage(image, width, height, width * bytesPerPixel, imageFormat);
+    }
+    QImage decimated(width / decimation, height / decimation, imageFormat);
+    if (decimated.isNull()) {
+        return decimated;
+    }
+    for (int y = 0; y < decimated.height(); ++y) {
+        const uint8_t *srcLine = image + size_t(y * decimation) * size_t(width) * size_t(bytesPerPixel);
+        uint8_t *destLine = decimated.scanLine(y);
+        for (int x = 0; x < decimated.width(); ++x) {
+            memcpy(destLine + x * bytesPerPixel, srcLine + size_t(x * decimation) * size_t(bytesPerPixel), size_t(bytesPerPixel));
+        }
+    }
+    return decimated;
 }
 
 void AbstractGfxScopeWidget::mouseReleaseEvent(QMouseEvent *event)
@@ -41,6 +96,16 @@ void AbstractGfxScopeWidget::slotRenderZoneUpdated(const QImage &frame)
 {
     QMutexLocker lock(&m_mutex);
     m_scopeImage = frame;
+    m_scopeFrame = SharedFrame();
+    AbstractScopeWidget::slotRenderZoneUpdated();
+}
+
+void AbstractGfxScopeWidget::slotFrameUpdated(const SharedFrame &frame)
+{
+    QMutexLocker lock(&m_mutex);
+    m_scopeFrame = frame;
+    m_scopeImage = QImage();
+    lock.unlock();
     AbstractScopeWidget::slotRenderZoneUpdated();
 }
 
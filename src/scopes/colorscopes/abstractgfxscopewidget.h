@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QWidget>
 
 #include "../abstractscopewidget.h"
+#include "monitor/scopes/sharedframe.h"
 
 /**
 * @brief Abstract class for scopes analyzing image frames.
@@ -23,6 +24,15 @@ public:
     explicit AbstractGfxScopeWidget(bool trackMouse = false, QWidget *parent = nullptr);
     ~AbstractGfxScopeWidget() override; // Must be virtual because of inheritance, to avoid memory leaks
 
+    /** @brief Image format in which this scope wants to analyse a monitor frame.
+     *  Defaults to mlt_image_rgba. The conversion is cached in the SharedFrame, so it is only
+     *  done once for all scopes requesting the same format, and never if no scope needs it.
+     *  The default frame renderer supports mlt_image_rgba and mlt_image_rgb, scopes requesting
+     *  another format must reimplement renderGfxScopeFromFrame(). */
+    virtual mlt_image_format requestedImageFormat(const SharedFrame &frame) const;
+    /** @brief Only one pixel out of requestedDecimation() in each direction is analysed. Defaults to 1. */
+    virtual int requestedDecimation() const;
+
 protected:
     ///// Variables /////
 
@@ -30,6 +40,14 @@ protected:
      *  when calculation has finished, to allow multi-threading.
      *  accelerationFactor hints how much faster than usual the calculation should be accomplished, if possible. */
     virtual QImage renderGfxScope(uint accelerationFactor, const QImage &) = 0;
+    /** @brief Scope renderer for frames received from the monitor.
+     *  The default implementation wraps the frame in the requested format into a QImage
+     *  and calls renderGfxScope(). */
+    virtual QImage renderGfxScopeFromFrame(uint accelerationFactor, const SharedFrame &frame);
+    /** @brief Returns an image of the frame in @param format (RGBA or RGB, other formats fall back to RGBA),
+     *  keeping one pixel out of @param decimation.
+     *  The image does not own its data when @param decimation is 1, so it must not outlive @param frame. */
+    static QImage frameToImage(const SharedFrame &frame, int decimation = 1, mlt_image_format format = mlt_image_rgba);
 
     QImage renderScope(uint accelerationFactor) override;
 
@@ -37,6 +55,7 @@ protected:
 
 private:
     QImage m_scopeImage;
+    SharedFrame m_scopeFrame;
     QMutex m_mutex;
 
 public Q_SLOTS:
@@ -44,6 +63,9 @@ public Q_SLOTS:
      * This slot must be connected in the implementing class, it is *not*
      * done in this abstract class. */
     void slotRenderZoneUpdated(const QImage &);
+    /** @brief Same as slotRenderZoneUpdated(const QImage &), for frames shared by the monitor
+     *  without any conversion. */
+    void slotFrameUpdated(const SharedFrame &frame);
 
 protected Q_SLOTS:
     virtual void slotAutoRefreshToggled(bool autoRefresh);
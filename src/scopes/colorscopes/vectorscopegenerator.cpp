@@ -61,6 +61,7 @@ mRgb2YPbPr =                        r =
  */
 
 #include "vectorscopegenerator.h"
+#include "utils/trace.h"
 #include <cmath>
 
 // The maximum distance from the center for any RGB color is 0.63, so
@@ -129,8 +130,7 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     // https://doc.qt.io/qt-5/qimage.html#bytesPerLine
     double avgPxPerPx = double(image.depth()) / 8 * (image.bytesPerLine() * image.height()) / scope.size().width() / scope.size().height() / accelFactor;
 
-    // benchmarking code
-    // const auto start = std::chrono::high_resolution_clock::now();
+    KDENLIVE_TRACE("scopes", "calculateVectorscope");
 
     const auto totalPixels = image.width() * image.height();
     for (int i = 0; i < totalPixels; i += accelFactor) {
@@ -258,8 +258,5 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
             }
         }
     }
-    // const auto elapsed = std::chrono::high_resolution_clock::now() - start;
-    // uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
-    // qDebug() << "Vectorscope calculated in" << us << " microseconds";
     return scope;
 }
@@ -192,6 +192,40 @@ QImage Waveform::renderGfxScope(uint accelFactor, const QImage &qimage)
     return wave;
 }
 
+mlt_image_format Waveform::requestedImageFormat(const SharedFrame &frame) const
+{
+    const mlt_image_format format = frame.get_image_format();
+    if (format != mlt_image_yuv422 && format != mlt_image_yuv420p) {
+        return mlt_image_rgba;
+    }
+    // The luma plane can only be used directly if it was computed with the coefficients selected by the user
+    const int colorspace = frame.get_int("colorspace");
+    if (colorspace != (m_aRec601->isChecked() ? 601 : 709)) {
+        return mlt_image_rgba;
+    }
+    return format;
+}
+
+QImage Waveform::renderGfxScopeFromFrame(uint accelFactor, const SharedFrame &frame)
+{
+    const mlt_image_format format = requestedImageFormat(frame);
+    if (format == mlt_image_rgba) {
+        return AbstractGfxScopeWidget::renderGfxScopeFromFrame(accelFactor, frame);
+    }
+    QElapsedTimer timer;
+    timer.start();
+
+    const int paintmode = m_ui->paintMode->itemData(m_ui->paintMode->currentIndex()).toInt();
+    // yuv422 is packed (Y0 U Y1 V), yuv420p starts with the full luma plane
+    const int pixelStep = format == mlt_image_yuv422 ? 2 : 1;
+    QImage wave = m_waveformGenerator->calculateLumaWaveform(scopeRect().size() - m_textWidth - QSize(0, m_paddingBottom), frame.get_image(format),
+                                                             frame.get_image_width(), frame.get_image_height(), pixelStep, frame.get_int("full_range") == 1,
+                                                             WaveformGenerator::PaintMode(paintmode), true, accelFactor);
+
+    Q_EMIT signalScopeRenderingFinished(uint(timer.elapsed()), 1);
+    return wave;
+}
+
 QImage Waveform::renderBackground(uint)
 {
     Q_EMIT signalBackgroundRenderingFinished(0, 1);
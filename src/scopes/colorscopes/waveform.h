@@ -28,6 +28,8 @@ public:
     ~Waveform() override;
 
     QString widgetName() const override;
+    /** @brief Frames in a native YUV format whose colorspace matches the selected luma mode are analysed without RGB conversion */
+    mlt_image_format requestedImageFormat(const SharedFrame &frame) const override;
 
 protected:
     void readConfig() override;
@@ -50,6 +52,7 @@ private:
     QRect scopeRect() override;
     QImage renderHUD(uint) override;
     QImage renderGfxScope(uint, const QImage &) override;
+    QImage renderGfxScopeFromFrame(uint, const SharedFrame &frame) override;
     QImage renderBackground(uint) override;
     bool isHUDDependingOnInput() const override;
     bool isScopeDependingOnInput() const override;
@@ -30,15 +30,10 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
     // QTime time;
     // time.start();
 
-    QImage wave(waveformSize, QImage::Format_ARGB32);
-
     if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || image.width() <= 0 || image.height() <= 0) {
         return QImage();
     }
 
-    // Fill with transparent color
-    wave.fill(qRgba(0, 0, 0, 0));
-
     const uint ww = uint(waveformSize.width());
     const uint wh = uint(waveformSize.height());
     const uint iw = uint(image.width());
@@ -77,6 +72,57 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
         waveValues[size_t(dx)][size_t(dy)]++;
     }
 
+    QImage wave = paintWaveform(waveformSize, waveValues, gain, paintMode, drawAxis);
+
+    // uint diff = time.elapsed();
+    // Q_EMIT signalCalculationFinished(wave, diff);
+
+    return wave;
+}
+QImage WaveformGenerator::calculateLumaWaveform(const QSize &waveformSize, const uint8_t *luma, int width, int height, int pixelStep, bool fullRange,
+                                                WaveformGenerator::PaintMode paintMode, bool drawAxis, uint accelFactor)
+{
+    Q_ASSERT(accelFactor >= 1);
+
+    if (waveformSize.width() <= 0 || waveformSize.height() <= 0 || luma == nullptr || width <= 1 || height <= 0) {
+        return QImage();
+    }
+
+    const uint ww = uint(waveformSize.width());
+    const uint wh = uint(waveformSize.height());
+    const auto totalPixels = width * height;
+
+    std::vector<std::vector<uint>> waveValues(size_t(waveformSize.width()), std::vector<uint>(size_t(waveformSize.height()), 0));
+
+    const float pixelDepth = float(totalPixels / accelFactor) / (ww * wh);
+    const float gain = 255.f / (8 * pixelDepth);
+
+    // Map luma to [0, wh - 1], expanding the limited 16-235 range like the RGB conversion would
+    const float lumaOffset = fullRange ? 0.f : 16.f;
+    const float hPrediv = (wh - 1) / (fullRange ? 255.f : 219.f);
+    const float wPrediv = (ww - 1) / float(width - 1);
+    const float maxY = float(wh - 1);
+
+    for (int i = 0; i < totalPixels; i += accelFactor) {
+        const int x = i % width;
+        const int y = i / width;
+        const float dy = qBound(0.f, (luma[size_t(y * width + x) * size_t(pixelStep)] - lumaOffset) * hPrediv, maxY);
+        const float dx = x * wPrediv;
+        waveValues[size_t(dx)][size_t(dy)]++;
+    }
+
+    return paintWaveform(waveformSize, waveValues, gain, paintMode, drawAxis);
+}
+
+QImage WaveformGenerator::paintWaveform(const QSize &waveformSize, const std::vector<std::vector<uint>> &waveValues, float gain,
+                                        WaveformGenerator::PaintMode paintMode, bool drawAxis)
+{
+    QImage wave(waveformSize, QImage::Format_ARGB32);
+    // Fill with transparent color
+    wave.fill(qRgba(0, 0, 0, 0));
+    const uint ww = uint(waveformSize.width());
+    const uint wh = uint(waveformSize.height());
+
     switch (paintMode) {
     case PaintMode_Green:
         for (int i = 0; i < waveformSize.width(); ++i) {
@@ -126,9 +172,6 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const QIm
         }
     }
 
-    // uint diff = time.elapsed();
-    // Q_EMIT signalCalculationFinished(wave, diff);
-
     return wave;
 }
 #undef CHOP255
@@ -10,6 +10,9 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QObject>
 #include "colorconstants.h"
 
+#include <cstdint>
+#include <vector>
+
 class QImage;
 class QSize;
 
@@ -25,4 +28,14 @@ public:
 
     QImage calculateWaveform(const QSize &waveformSize, const QImage &image, WaveformGenerator::PaintMode paintMode, bool drawAxis,
                              const ITURec rec, uint accelFactor = 1);
+    /** @brief Same as calculateWaveform, reading the luma values of a YUV image directly.
+     *  @param pixelStep distance in bytes between two luma samples of a line
+     *  @param fullRange true if luma uses the full 0-255 range, false for 16-235 */
+    QImage calculateLumaWaveform(const QSize &waveformSize, const uint8_t *luma, int width, int height, int pixelStep, bool fullRange,
+                                 WaveformGenerator::PaintMode paintMode, bool drawAxis, uint accelFactor = 1);
+
+private:
+    /** @brief Paint the accumulated luma counts of each scope pixel */
+    static QImage paintWaveform(const QSize &waveformSize, const std::vector<std::vector<uint>> &waveValues, float gain,
+                                WaveformGenerator::PaintMode paintMode, bool drawAxis);
 };
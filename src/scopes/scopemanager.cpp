@@ -148,6 +148,22 @@ void ScopeManager::slotDistributeFrame(const QImage &image)
     // checkActiveColourScopes();
 }
 
+void ScopeManager::slotDistributeSharedFrame(const SharedFrame &frame)
+{
+    // Same as slotDistributeFrame, but each scope converts the frame itself, only if needed
+    for (auto &m_colorScope : m_colorScopes) {
+        if (!m_colorScope.scope->visibleRegion().isEmpty()) {
+            if (m_colorScope.scope->autoRefreshEnabled()) {
+                m_colorScope.scope->slotFrameUpdated(frame);
+            } else if (m_colorScope.singleFrameRequested) {
+                m_colorScope.singleFrameRequested = false;
+                m_colorScope.scope->slotFrameUpdated(frame);
+                m_colorScope.scope->forceUpdateScope();
+            }
+        }
+    }
+}
+
 void ScopeManager::slotScopeReady()
 {
     if (m_lastConnectedRenderer) {
@@ -202,6 +218,7 @@ void ScopeManager::slotUpdateActiveRenderer()
     // Connect new renderer
     if (m_lastConnectedRenderer != nullptr) {
         connect(m_lastConnectedRenderer, &Monitor::frameUpdated, this, &ScopeManager::slotDistributeFrame, Qt::UniqueConnection);
+        connect(m_lastConnectedRenderer, &Monitor::sharedFrameUpdated, this, &ScopeManager::slotDistributeSharedFrame, Qt::UniqueConnection);
         connect(m_lastConnectedRenderer, &Monitor::audioSamplesSignal, this, &ScopeManager::slotDistributeAudio, Qt::UniqueConnection);
 
 #ifdef DEBUG_SM
@@ -275,16 +292,15 @@ void ScopeManager::checkActiveColourScopes()
     qCDebug(KDENLIVE_LOG) << "ScopeManager: New frames still requested? " << imageStillRequested;
 #endif
 
-    // Notify monitors whether frames are still required
-    Monitor *monitor;
-    monitor = static_cast<Monitor *>(pCore->monitorManager()->monitor(Kdenlive::ProjectMonitor));
-    if (monitor != nullptr) {
-        monitor->sendFrameForAnalysis(imageStillRequested);
-    }
-
-    monitor = static_cast<Monitor *>(pCore->monitorManager()->monitor(Kdenlive::ClipMonitor));
-    if (monitor != nullptr) {
-        monitor->sendFrameForAnalysis(imageStillRequested);
+    // Notify monitors whether frames are still required.
+    // With GPU processing, the MLT frame only contains a texture, so the monitor has to render a QImage for us
+    const bool gpuFrames = KdenliveSettings::gpu_accel();
+    for (auto id : {Kdenlive::ProjectMonitor, Kdenlive::ClipMonitor}) {
+        auto *monitor = static_cast<Monitor *>(pCore->monitorManager()->monitor(id));
+        if (monitor != nullptr) {
+            monitor->sendFrameForAnalysis(imageStillRequested && gpuFrames);
+            monitor->sendSharedFrameForAnalysis(imageStillRequested && !gpuFrames);
+        }
     }
 }
 
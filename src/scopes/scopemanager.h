@@ -129,6 +129,7 @@ private Q_SLOTS:
     void checkActiveColourScopes();
 
     void slotDistributeFrame(const QImage &image);
+    void slotDistributeSharedFrame(const SharedFrame &frame);
     void slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
     /**
       Allows a scope to explicitly request a new frame, even if the scope's autoRefresh is disabled.
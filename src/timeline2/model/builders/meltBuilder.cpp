@@ -16,6 +16,7 @@
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/trace.h"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -352,6 +353,7 @@ bool constructTimelineFromTractor(const std::shared_ptr<TimelineItemModel> &time
 bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timeline, Mlt::Tractor tractor, const QString &originalDecimalPoint,
                                const QString &chunks, const QString &dirty, bool enablePreview, bool *projectErrors)
 {
+    KDENLIVE_TRACE("project", "constructTimelineFromMelt");
     if (tractor.count() == 0) {
         // Trying to load invalid tractor, abort
         return false;
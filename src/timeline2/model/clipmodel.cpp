@@ -743,7 +743,7 @@ bool ClipModel::addEffect(const QString &effectId)
     return true;
 }
 
-bool ClipModel::addEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo)
+bool ClipModel::addEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo, const QDomElement &xml)
 {
     QWriteLocker locker(&m_lock);
     if (EffectsRepository::get()->isAudioEffect(effectId)) {
@@ -756,7 +756,7 @@ bool ClipModel::addEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo)
     if (EffectsRepository::get()->isTextEffect(effectId) && m_clipType != ClipType::Text) {
         return false;
     }
-    return m_effectStack->appendEffectWithUndo(effectId, undo, redo);
+    return m_effectStack->appendEffectWithUndo(effectId, undo, redo, xml);
 }
 
 bool ClipModel::copyEffect(const std::shared_ptr<EffectStackModel> &stackModel, int rowId)
@@ -767,12 +767,10 @@ bool ClipModel::copyEffect(const std::shared_ptr<EffectStackModel> &stackModel,
     return true;
 }
 
-bool ClipModel::copyEffectWithUndo(const std::shared_ptr<EffectStackModel> &stackModel, int rowId, Fun &undo, Fun &redo)
+bool ClipModel::copyEffectWithUndo(const QDomElement &effectXml, Fun &undo, Fun &redo)
 {
     QWriteLocker locker(&m_lock);
-    QDomDocument doc;
-    m_effectStack->copyXmlEffectWithUndo(stackModel->rowToXml(rowId, doc), undo, redo);
-    return true;
+    return m_effectStack->copyXmlEffectWithUndo(effectXml, undo, redo);
 }
 
 bool ClipModel::importEffects(std::shared_ptr<EffectStackModel> stackModel)
@@ -134,9 +134,11 @@ public:
     void deregisterClipToBin(const QUuid &uuid);
 
     bool addEffect(const QString &effectId);
-    bool addEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo);
+    /** @brief Add an effect to the clip, @param xml is an optional shared description of the effect (see EffectStackModel::appendEffectWithUndo) */
+    bool addEffectWithUndo(const QString &effectId, Fun &undo, Fun &redo, const QDomElement &xml = QDomElement());
     bool copyEffect(const std::shared_ptr<EffectStackModel> &stackModel, int rowId);
-    bool copyEffectWithUndo(const std::shared_ptr<EffectStackModel> &stackModel, int rowId, Fun &undo, Fun &redo);
+    /** @brief Append the effects described in @param effectXml, as produced by EffectStackModel::rowToXml */
+    bool copyEffectWithUndo(const QDomElement &effectXml, Fun &undo, Fun &redo);
     /** @brief Import effects from a different stackModel */
     bool importEffects(std::shared_ptr<EffectStackModel> stackModel);
     /** @brief Import effects from a service that contains some (another clip?) */
@@ -732,9 +732,12 @@ bool TimelineItemModel::copyClipEffect(int clipId, const QString sourceId)
         // only operate on the selected item
         Fun undo = []() { return true; };
         Fun redo = []() { return true; };
+        // Serialize the source effect once for all the target clips
+        QDomDocument doc;
+        const QDomElement effectXml = effectStack->rowToXml(itemRow, doc);
         for (auto &s : m_currentSelection) {
             if (isClip(s)) {
-                m_allClips.at(s)->copyEffectWithUndo(effectStack, itemRow, undo, redo);
+                m_allClips.at(s)->copyEffectWithUndo(effectXml, undo, redo);
             }
         }
         pCore->pushUndo(undo, redo, i18n("Copy effect"));
@@ -745,9 +748,11 @@ bool TimelineItemModel::copyClipEffect(int clipId, const QString sourceId)
             Fun undo = []() { return true; };
             Fun redo = []() { return true; };
             std::unordered_set<int> sub = m_groups->getLeaves(parentGroup);
+            QDomDocument doc;
+            const QDomElement effectXml = effectStack->rowToXml(itemRow, doc);
             for (auto &s : sub) {
                 if (isClip(s)) {
-                    m_allClips.at(s)->copyEffectWithUndo(effectStack, itemRow, undo, redo);
+                    m_allClips.at(s)->copyEffectWithUndo(effectXml, undo, redo);
                 }
             }
             pCore->pushUndo(undo, redo, i18n("Copy effect"));
@@ -21,16 +21,21 @@
 #include "kdenlivesettings.h"
 #include "profiles/profilemodel.hpp"
 #include "snapmodel.hpp"
+#include "timelineitemmodel.hpp"
 #include "timeline2/view/previewmanager.h"
 #include "timelinefunctions.hpp"
+#include "transitions/transitionsrepository.hpp"
+#include "utils/trace.h"
 
 #include "monitor/monitormanager.h"
 
 #include <KLocalizedString>
 #include <QCryptographicHash>
 #include <QDebug>
+#include <QDomDocument>
 #include <QModelIndex>
 #include <QThread>
+#include <QtMath>
 #include <mlt++/MltConsumer.h>
 #include <mlt++/MltField.h>
 #include <mlt++/MltProfile.h>
@@ -384,6 +389,18 @@ QPoint TimelineModel::getClipInDuration(int clipId) const
     return {clip->getIn(), clip->getPlaytime()};
 }
 
+QPoint TimelineModel::getClipSourceRange(int clipId) const
+{
+    READ_LOCK();
+    Q_ASSERT(m_allClips.count(clipId) > 0);
+    const auto clip = m_allClips.at(clipId);
+    const double speed = clip->getSpeed();
+    if (clip->hasTimeRemap() || speed < 0.) {
+        return {0, INT_MAX};
+    }
+    return {int(clip->getIn() * speed), qCeil((clip->getOut() + 1) * speed) - 1};
+}
+
 PlaylistState::ClipState TimelineModel::getClipState(int clipId) const
 {
     READ_LOCK();
@@ -1290,6 +1307,7 @@ bool TimelineModel::requestFakeClipMove(int clipId, int trackId, int position, b
 bool TimelineModel::requestClipMove(int clipId, int trackId, int position, bool moveMirrorTracks, bool updateView, bool logUndo, bool invalidateTimeline,
                                     bool revertMove)
 {
+    KDENLIVE_TRACE("timeline", "requestClipMove");
     QWriteLocker locker(&m_lock);
     TRACE(clipId, trackId, position, updateView, logUndo, invalidateTimeline);
     Q_ASSERT(m_allClips.count(clipId) > 0);
@@ -1818,6 +1836,7 @@ bool TimelineModel::requestClipCreation(const QString &binClipId, int &id, Playl
 
 bool TimelineModel::requestClipInsertion(const QString &binClipId, int trackId, int position, int &id, bool logUndo, bool refreshView, bool useTargets)
 {
+    KDENLIVE_TRACE("timeline", "requestClipInsertion");
     QWriteLocker locker(&m_lock);
     TRACE(binClipId, trackId, position, id, logUndo, refreshView, useTargets);
     Fun undo = []() { return true; };
@@ -2148,6 +2167,7 @@ bool TimelineModel::requestItemDeletion(int itemId, Fun &undo, Fun &redo, bool l
 
 bool TimelineModel::requestItemDeletion(int itemId, bool logUndo)
 {
+    KDENLIVE_TRACE("timeline", "requestItemDeletion");
     QWriteLocker locker(&m_lock);
     TRACE(itemId, logUndo);
     Q_ASSERT(isItem(itemId));
@@ -2608,6 +2628,7 @@ bool TimelineModel::requestFakeGroupMove(int clipId, int groupId, int delta_trac
 bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, int delta_pos, bool moveMirrorTracks, bool updateView, bool logUndo,
                                      bool revertMove)
 {
+    KDENLIVE_TRACE("timeline", "requestGroupMove");
     QWriteLocker locker(&m_lock);
     TRACE(itemId, groupId, delta_track, delta_pos, updateView, logUndo);
     std::function<bool(void)> undo = []() { return true; };
@@ -3627,6 +3648,7 @@ bool TimelineModel::removeMix(int cid)
 
 int TimelineModel::requestItemResize(int itemId, int size, bool right, bool logUndo, int snapDistance, bool allowSingleResize)
 {
+    KDENLIVE_TRACE("timeline", "requestItemResize");
     QWriteLocker locker(&m_lock);
     TRACE(itemId, size, right, logUndo, snapDistance, allowSingleResize)
     Q_ASSERT(isItem(itemId));
@@ -4443,6 +4465,7 @@ bool TimelineModel::requestClipSlip(int itemId, int offset, bool logUndo, Fun &u
 
 int TimelineModel::requestClipsGroup(const std::unordered_set<int> &ids, bool logUndo, GroupType type)
 {
+    KDENLIVE_TRACE("timeline", "requestClipsGroup");
     QWriteLocker locker(&m_lock);
     TRACE(ids, logUndo, type);
     if (type == GroupType::Selection || type == GroupType::Leaf) {
@@ -4605,6 +4628,7 @@ bool TimelineModel::requestRemoveFromGroup(int itemId, Fun &undo, Fun &redo)
 
 bool TimelineModel::requestTrackInsertion(int position, int &id, const QString &trackName, bool audioTrack)
 {
+    KDENLIVE_TRACE("timeline", "requestTrackInsertion");
     QWriteLocker locker(&m_lock);
     TRACE(position, id, trackName, audioTrack);
     Fun undo = []() { return true; };
@@ -4708,6 +4732,7 @@ bool TimelineModel::requestTrackInsertion(int position, int &id, const QString &
 bool TimelineModel::requestTrackDeletion(int trackId)
 {
     // TODO: make sure we disable overlayTrack before deleting a track
+    KDENLIVE_TRACE("timeline", "requestTrackDeletion");
     QWriteLocker locker(&m_lock);
     TRACE(trackId);
     Fun undo = []() { return true; };
@@ -5021,9 +5046,11 @@ QVariantList TimelineModel::addClipEffect(int clipId, const QString &effectId, b
     }
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
+    // Fetch the effect description once, it is shared by the effects added to all the clips
+    const QDomElement effectXml = items.size() > 1 ? EffectsRepository::get()->getXml(effectId) : QDomElement();
     for (auto &s : items) {
         if (isClip(s)) {
-            if (m_allClips.at(s)->addEffectWithUndo(effectId, undo, redo)) {
+            if (m_allClips.at(s)->addEffectWithUndo(effectId, undo, redo, effectXml)) {
                 result = true;
                 affectedClips << s;
             }
@@ -5553,6 +5580,7 @@ int TimelineModel::getTrackCompositionsCount(int trackId) const
 
 bool TimelineModel::requestCompositionMove(int compoId, int trackId, int position, bool updateView, bool logUndo, bool fakeMove)
 {
+    KDENLIVE_TRACE("timeline", "requestCompositionMove");
     QWriteLocker locker(&m_lock);
     Q_ASSERT(isComposition(compoId));
     if (m_allCompositions[compoId]->getPosition() == position && getCompositionTrackId(compoId) == trackId) {
@@ -6191,6 +6219,18 @@ void TimelineModel::replugClip(int clipId)
     }
 }
 
+void TimelineModel::swapClipProducer(int clipId)
+{
+    int trackId = getClipTrackId(clipId);
+    if (trackId == -1 || !qFuzzyCompare(m_allClips[clipId]->getSpeed(), 1.) || m_allClips[clipId]->hasTimeRemap()) {
+        // Speed changes use their own producer
+        return;
+    }
+    getTrackById_const(trackId)->temporaryUnplugClip(clipId);
+    m_allClips[clipId]->refreshProducerFromBin(trackId);
+    getTrackById_const(trackId)->temporaryReplugClip(clipId);
+}
+
 void TimelineModel::requestClipUpdate(int clipId, const QVector<int> &roles)
 {
     QModelIndex modelIndex = makeClipIndexFromID(clipId);
@@ -7284,6 +7324,285 @@ QByteArray TimelineModel::timelineHash()
     return fileHash;
 }
 
+namespace {
+/** @brief Describe the media of a bin clip as it is seen by the preview render */
+QByteArray binClipSignature(const QString &binId)
+{
+    std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+    if (!binClip || !binClip->statusReady()) {
+        // Unknown content, never reuse a chunk
+        return QUuid::createUuid().toByteArray();
+    }
+    QByteArray data = binClip->hash(false).toLatin1();
+    if (binClip->clipType() == ClipType::Timeline) {
+        // A sequence is described by its own content
+        std::shared_ptr<TimelineItemModel> sequence = pCore->currentDoc()->getTimeline(binClip->getSequenceUuid(), true);
+        if (!sequence) {
+            return QUuid::createUuid().toByteArray();
+        }
+        data.append(sequence->previewChunkHashes({QVariant(0)}, qMax(1, sequence->duration()), QByteArray()).value(0).toLatin1());
+        return data;
+    }
+    std::shared_ptr<Mlt::Producer> producer = binClip->originalProducer();
+    if (!producer) {
+        return QUuid::createUuid().toByteArray();
+    }
+    QReadLocker lock(&pCore->xmlMutex);
+    for (int i = 0; i < producer->count(); i++) {
+        const QByteArray name(producer->get_name(i));
+        if (name.startsWith('_') || name.startsWith("kdenlive:")) {
+            continue;
+        }
+        data.append(name).append('=').append(producer->get(i)).append('\n');
+    }
+    // Previews may be rendered from the original of a proxied clip
+    data.append(producer->get("kdenlive:originalurl")).append('\n');
+    return data;
+}
+
+void addEffects(QCryptographicHash &hash, const std::shared_ptr<EffectStackModel> &stack)
+{
+    QDomDocument doc;
+    doc.appendChild(stack->toXml(doc));
+    hash.addData(doc.toByteArray());
+}
+} // namespace
+
+QMap<int, QString> TimelineModel::previewChunkHashes(const QVariantList &chunks, int chunkSize, const QByteArray &renderParams)
+{
+    READ_LOCK();
+    QMap<int, QString> hashes;
+    const bool useProxy = KdenliveSettings::proxypreview() && pCore->currentDoc()->useProxy();
+    QCryptographicHash base(QCryptographicHash::Md5);
+    base.addData(pCore->getCurrentProfilePath().toUtf8());
+    base.addData(QByteArray::number(chunkSize));
+    base.addData(useProxy ? QByteArrayLiteral("proxy") : QByteArrayLiteral("original"));
+    base.addData(renderParams);
+    // The automatic track compositing blends the video tracks together
+    const QString compositing = pCore->currentDoc()->getSequenceProperty(m_uuid, QStringLiteral("compositing"), QStringLiteral("1"));
+    base.addData(compositing.toUtf8());
+    if (compositing.toInt() > 0) {
+        base.addData(TransitionsRepository::get()->getCompositingTransition().toUtf8());
+    }
+    // Effects on tracks and on the master apply to the timeline frames, their keyframes depend on the chunk position
+    bool positionDependent = m_masterStack && m_masterStack->rowCount() > 0;
+    if (m_masterStack) {
+        addEffects(base, m_masterStack);
+    }
+    QVector<std::shared_ptr<TrackModel>> videoTracks;
+    // Track effects do not change between chunks, only serialize them once
+    std::unordered_map<int, QByteArray> trackEffects;
+    for (const auto &track : m_allTracks) {
+        if (track->isAudioTrack() || track->isHidden()) {
+            continue;
+        }
+        videoTracks << track;
+        QCryptographicHash effects(QCryptographicHash::Md5);
+        addEffects(effects, track->m_effectStack);
+        trackEffects.emplace(track->getId(), effects.result());
+        positionDependent = positionDependent || track->m_effectStack->rowCount() > 0;
+    }
+    QList<SubtitledTime> subtitles;
+    const double fps = pCore->getCurrentFps();
+    if (m_subtitleModel && !m_subtitleModel->isDisabled()) {
+        subtitles = m_subtitleModel->getAllSubtitles();
+        base.addData(m_subtitleModel->getStyle().toUtf8());
+    }
+
+    // Items do not change between chunks, only describe them once
+    QMap<QString, QByteArray> binClips;
+    std::unordered_map<int, QByteArray> items;
+    auto clipDescription = [&](const std::shared_ptr<TrackModel> &track, int cid) {
+        auto it = items.find(cid);
+        if (it != items.end()) {
+            return it->second;
+        }
+        const std::shared_ptr<ClipModel> &clip = m_allClips.at(cid);
+        const QString binId = clip->binId();
+        if (!binClips.contains(binId)) {
+            binClips.insert(binId, binClipSignature(binId));
+        }
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(binClips.value(binId));
+        hash.addData(QStringLiteral("%1 %2 %3 %4 %5")
+                         .arg(int(clip->clipState()))
+                         .arg(clip->getIn())
+                         .arg(clip->getPlaytime())
+                         .arg(clip->getSubPlaylistIndex())
+                         .arg(clip->getSpeed())
+                         .toUtf8());
+        if (clip->hasTimeRemap()) {
+            const QMap<QString, QString> remap = clip->getRemapValues();
+            for (auto i = remap.cbegin(); i != remap.cend(); ++i) {
+                hash.addData(i.key().toUtf8());
+                hash.addData(i.value().toUtf8());
+            }
+        }
+        addEffects(hash, clip->m_effectStack);
+        if (track->m_sameCompositions.count(cid) > 0) {
+            // Mix with the previous clip
+            const std::shared_ptr<AssetParameterModel> &mix = track->m_sameCompositions.at(cid);
+            hash.addData(QStringLiteral("%1 %2 %3").arg(mix->getAssetId()).arg(clip->getMixDuration()).arg(clip->getMixCutPosition()).toUtf8());
+            const QVector<QPair<QString, QVariant>> params = mix->getAllParameters();
+            for (const auto &param : params) {
+                hash.addData(param.first.toUtf8());
+                hash.addData(param.second.toString().toUtf8());
+            }
+        }
+        return items.emplace(cid, hash.result()).first->second;
+    };
+    auto compositionDescription = [&](int compoId) {
+        auto it = items.find(compoId);
+        if (it != items.end()) {
+            return it->second;
+        }
+        const std::shared_ptr<CompositionModel> &compo = m_allCompositions.at(compoId);
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(QStringLiteral("%1 %2 %3 %4")
+                         .arg(compo->getAssetId())
+                         .arg(compo->getATrack())
+                         .arg(compo->getForcedTrack())
+                         .arg(compo->getPlaytime())
+                         .toUtf8());
+        const QVector<QPair<QString, QVariant>> params = compo->getAllParameters();
+        for (const auto &param : params) {
+            hash.addData(param.first.toUtf8());
+            hash.addData(param.second.toString().toUtf8());
+        }
+        return items.emplace(compoId, hash.result()).first->second;
+    };
+    auto overlaps = [](int position, int duration, int start, int end) { return position < end && position + duration > start; };
+
+    const QByteArray baseHash = base.result();
+    for (const QVariant &chunk : chunks) {
+        const int start = chunk.toInt();
+        const int end = start + chunkSize;
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(baseHash);
+        if (positionDependent) {
+            hash.addData(QByteArray::number(start));
+        }
+        for (const auto &track : qAsConst(videoTracks)) {
+            hash.addData(QByteArrayLiteral("track"));
+            hash.addData(trackEffects.at(track->getId()));
+            // Clips and compositions are hashed in position order so that the hash does not depend on their ids
+            std::map<std::pair<int, int>, QByteArray> trackItems;
+            for (const auto &clip : track->m_allClips) {
+                const int position = clip.second->getPosition();
+                if (overlaps(position, clip.second->getPlaytime(), start, end)) {
+                    trackItems[{position, clip.second->getSubPlaylistIndex()}] = clipDescription(track, clip.first);
+                }
+            }
+            for (const auto &compo : track->m_allCompositions) {
+                const int position = compo.second->getPosition();
+                if (overlaps(position, compo.second->getPlaytime(), start, end)) {
+                    trackItems[{position, 2}] = compositionDescription(compo.first);
+                }
+            }
+            for (const auto &item : trackItems) {
+                hash.addData(QByteArray::number(item.first.first - start));
+                hash.addData(item.second);
+            }
+        }
+        for (const SubtitledTime &subtitle : qAsConst(subtitles)) {
+            const int position = subtitle.start().frames(fps);
+            if (overlaps(position, subtitle.end().frames(fps) - position, start, end)) {
+                hash.addData(QStringLiteral("%1 %2 ").arg(position - start).arg(subtitle.end().frames(fps) - start).toUtf8());
+                hash.addData(subtitle.subtitle().toUtf8());
+            }
+        }
+        hashes.insert(start, QString::fromLatin1(hash.result().toHex()));
+    }
+    return hashes;
+}
+
+QString TimelineModel::sequenceHash()
+{
+    READ_LOCK();
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    const int length = qMax(1, duration());
+    hash.addData(QByteArray::number(length));
+    // The video, including track states and nested sequences
+    hash.addData(previewChunkHashes({QVariant(0)}, length, QByteArray()).value(0).toLatin1());
+    // Audio clips and mixes
+    hash.addData(timelineHash());
+    for (const auto &track : m_allTracks) {
+        if (!track->isAudioTrack()) {
+            continue;
+        }
+        hash.addData(track->getProperty(QStringLiteral("hide")).toString().toUtf8());
+        addEffects(hash, track->m_effectStack);
+        for (const auto &clip : track->m_allClips) {
+            const QString binId = clip.second->binId();
+            std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+            std::shared_ptr<TimelineItemModel> sequence;
+            if (binClip && binClip->clipType() == ClipType::Timeline) {
+                sequence = pCore->currentDoc()->getTimeline(binClip->getSequenceUuid(), true);
+            }
+            hash.addData(sequence ? sequence->sequenceHash().toLatin1() : binClipSignature(binId));
+        }
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool TimelineModel::isOpaque()
+{
+    READ_LOCK();
+    const int length = duration();
+    if (length <= 0 || (m_masterStack && m_masterStack->hasEffects())) {
+        return false;
+    }
+    const QSize frameSize = pCore->getCurrentFrameSize();
+    // A video file filling the frame, without alpha channel and without effects that could make it transparent
+    auto isOpaqueClip = [frameSize](const std::shared_ptr<ClipModel> &clip) {
+        if (clip->clipState() == PlaylistState::Disabled || clip->m_effectStack->hasEffects()) {
+            return false;
+        }
+        std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(clip->binId());
+        if (!binClip || (binClip->clipType() != ClipType::AV && binClip->clipType() != ClipType::Video)) {
+            return false;
+        }
+        const int videoIndex = binClip->getProducerIntProperty(QStringLiteral("video_index"));
+        const QString prefix = QStringLiteral("meta.media.%1.codec.").arg(videoIndex);
+        const QString pixFormat = binClip->getProducerProperty(prefix + QStringLiteral("pix_fmt"));
+        static const QStringList alphaFormats = {QStringLiteral("yuva"), QStringLiteral("rgba"), QStringLiteral("bgra"), QStringLiteral("argb"),
+                                                 QStringLiteral("abgr"), QStringLiteral("gbrap"), QStringLiteral("ya8"), QStringLiteral("ya16")};
+        for (const QString &format : alphaFormats) {
+            if (pixFormat.startsWith(format)) {
+                return false;
+            }
+        }
+        // Smaller or letterboxed frames are padded with transparency
+        return binClip->getProducerIntProperty(prefix + QStringLiteral("width")) == frameSize.width() &&
+               binClip->getProducerIntProperty(prefix + QStringLiteral("height")) == frameSize.height();
+    };
+    // Tracks are ordered from the bottom, upper tracks may use blend modes so only the lowest visible video track can hide the background
+    for (const auto &track : m_allTracks) {
+        if (track->isAudioTrack() || track->isHidden()) {
+            continue;
+        }
+        if (track->m_effectStack->hasEffects()) {
+            return false;
+        }
+        std::map<int, int> ranges;
+        for (const auto &clip : track->m_allClips) {
+            if (isOpaqueClip(clip.second)) {
+                const int position = clip.second->getPosition();
+                ranges[position] = qMax(ranges[position], position + clip.second->getPlaytime());
+            }
+        }
+        int covered = 0;
+        for (const auto &range : ranges) {
+            if (range.first > covered) {
+                break;
+            }
+            covered = qMax(covered, range.second);
+        }
+        return covered >= length;
+    }
+    return false;
+}
+
 std::shared_ptr<MarkerSortModel> TimelineModel::getFilteredGuideModel()
 {
     return m_guidesFilterModel;
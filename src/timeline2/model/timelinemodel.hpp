@@ -317,6 +317,11 @@ public:
        @param clipId Id of the clip to test
     */
     QPoint getClipInDuration(int clipId) const;
+    /** @brief Returns the first and last frames of the bin clip played by a clip, taking its speed into account.
+       If the clip uses time remapping or plays backwards, the range ends at INT_MAX as any frame of the source can be played
+       @param clipId Id of the clip to test
+    */
+    QPoint getClipSourceRange(int clipId) const;
 
     /** @brief Returns the clip state (audio/video only)
      */
@@ -700,6 +705,22 @@ public:
     /** @brief Calculate timeline hash based on clips, mixes and compositions
      */
     QByteArray timelineHash();
+    /** @brief Calculate a hash of everything that contributes to the video of each timeline preview chunk
+       @param chunks the first frame of the chunks
+       @param chunkSize the number of frames in a chunk
+       @param renderParams the preview render settings, so that chunks rendered with other settings are not reused
+       @returns a map of the chunk first frame and its hash. Chunks with the same hash render the same frames,
+       whatever their position in the timeline, the undo history or the sequence
+    */
+    QMap<int, QString> previewChunkHashes(const QVariantList &chunks, int chunkSize, const QByteArray &renderParams);
+    /** @brief Calculate a hash of everything rendered by this timeline when used as a sequence clip, audio included.
+       Nested sequence instances are only reloaded when it changes
+    */
+    QString sequenceHash();
+    /** @brief Returns true if the lowest video track fully hides the background with opaque clips, so the sequence looks the same
+       with a transparent or black background. A rendered preview of a nested sequence is only valid in that case
+    */
+    bool isOpaque();
     /** @brief Make the background track transparent (or opaque black) - this affects compositing.
      */
     void makeTransparentBg(bool transparent);
@@ -844,6 +865,10 @@ public:
     std::shared_ptr<Mlt::Producer> getClipProducer(int clipId);
 
     void replugClip(int clipId);
+    /** @brief Get a new producer from the bin for a clip and swap it in its track, without the model changes and preview invalidation of a reload.
+       Only valid if the clip content does not change, for example when a nested sequence switches between its tracks and its rendered preview.
+       Clips with a speed change or time remapping are left untouched */
+    void swapClipProducer(int clipId);
 
     /** @brief Refresh the tractor profile in case a change was requested. */
     // void updateProfile(Mlt::Profile profile);
@@ -901,11 +901,10 @@ int TrackModel::getCompositionByPosition(int position)
 int TrackModel::getClipByRow(int row) const
 {
     READ_LOCK();
-    if (row >= static_cast<int>(m_allClips.size())) {
+    auto it = m_allClips.nth(row);
+    if (it == m_allClips.cend()) {
         return -1;
     }
-    auto it = m_allClips.cbegin();
-    std::advance(it, row);
     return (*it).first;
 }
 
@@ -930,7 +929,7 @@ int TrackModel::getRowfromClip(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(m_allClips.count(clipId) > 0);
-    return int(std::distance(m_allClips.begin(), m_allClips.find(clipId)));
+    return m_allClips.rank(clipId);
 }
 
 std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end)
@@ -956,7 +955,7 @@ int TrackModel::getRowfromComposition(int tid) const
 {
     READ_LOCK();
     Q_ASSERT(m_allCompositions.count(tid) > 0);
-    return int(m_allClips.size()) + int(std::distance(m_allCompositions.begin(), m_allCompositions.find(tid)));
+    return int(m_allClips.size()) + m_allCompositions.rank(tid);
 }
 
 QVariant TrackModel::getProperty(const QString &name) const
@@ -1493,8 +1492,10 @@ int TrackModel::getCompositionByRow(int row) const
         return -1;
     }
     Q_ASSERT(row <= int(m_allClips.size() + m_allCompositions.size()));
-    auto it = m_allCompositions.cbegin();
-    std::advance(it, row - int(m_allClips.size()));
+    auto it = m_allCompositions.nth(row - int(m_allClips.size()));
+    if (it == m_allCompositions.cend()) {
+        return -1;
+    }
     return (*it).first;
 }
 
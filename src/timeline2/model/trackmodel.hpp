@@ -7,6 +7,7 @@
 
 #include "definitions.h"
 #include "undohelper.hpp"
+#include "utils/rankedmap.hpp"
 #include <QReadWriteLock>
 #include <QSharedPointer>
 #include <memory>
@@ -360,9 +361,9 @@ private:
     QMap<int, int> m_mixList;
 
     /** This is important to keep an ordered structure to store the clips, since we use their ids order as row order*/
-    std::map<int, std::shared_ptr<ClipModel>> m_allClips;
+    RankedMap<int, std::shared_ptr<ClipModel>> m_allClips;
     /** This is important to keep an ordered structure to store the compositions, since we use their ids order as row order*/
-    std::map<int, std::shared_ptr<CompositionModel>> m_allCompositions;
+    RankedMap<int, std::shared_ptr<CompositionModel>> m_allCompositions;
 
     /** We store the positions of the compositions. In Melt, the compositions are not inserted at the track level, but we keep
      *  those positions here to check for moves and resize
@@ -14,17 +14,19 @@
 #include "mainwindow.h"
 #include "monitor/monitor.h"
 #include "profiles/profilemodel.hpp"
+#include "timeline2/model/timelineitemmodel.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/cachebudget.h"
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
 #include <KMessageBox>
-#include <QCollator>
 #include <QCryptographicHash>
 #include <QMutexLocker>
 #include <QSaveFile>
 #include <QStandardPaths>
+#include <QtConcurrent>
 
 PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *parent)
     : QObject(parent)
@@ -58,9 +60,7 @@ PreviewManager::~PreviewManager()
 {
     if (m_initialized) {
         abortRendering();
-        if (m_undoDir.dirName() == QLatin1String("undo")) {
-            m_undoDir.removeRecursively();
-        }
+        m_evictionJob.waitForFinished();
         if ((pCore->currentDoc()->url().isEmpty() && m_cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot).isEmpty()) ||
             m_cacheDir.entryList(QDir::AllEntries | QDir::NoDotAndDotDot).isEmpty()) {
             if (m_cacheDir.dirName() == QLatin1String("preview")) {
@@ -91,14 +91,13 @@ bool PreviewManager::initialize()
         return false;
     }
     if (m_uuid == doc->uuid()) {
-        if (m_cacheDir.dirName() != QLatin1String("preview") || m_cacheDir == QDir() ||
-            (!m_cacheDir.exists(QStringLiteral("undo")) && !m_cacheDir.mkdir(QStringLiteral("undo"))) || !m_cacheDir.absolutePath().contains(documentId)) {
+        if (m_cacheDir.dirName() != QLatin1String("preview") || m_cacheDir == QDir() || !m_cacheDir.absolutePath().contains(documentId)) {
             pCore->displayMessage(i18n("Something is wrong with cache folder %1", m_cacheDir.absolutePath()), ErrorMessage);
             return false;
         }
     } else {
         if (m_cacheDir.dirName().toLatin1() != QCryptographicHash::hash(m_uuid.toByteArray(), QCryptographicHash::Md5).toHex() || m_cacheDir == QDir() ||
-            (!m_cacheDir.exists(QStringLiteral("undo")) && !m_cacheDir.mkdir(QStringLiteral("undo"))) || !m_cacheDir.absolutePath().contains(documentId)) {
+            !m_cacheDir.absolutePath().contains(documentId)) {
             pCore->displayMessage(i18n("Something is wrong with cache folder %1", m_cacheDir.absolutePath()), ErrorMessage);
             return false;
         }
@@ -107,16 +106,19 @@ bool PreviewManager::initialize()
         pCore->displayMessage(i18n("Invalid timeline preview parameters"), ErrorMessage);
         return false;
     }
-    m_undoDir = QDir(m_cacheDir.absoluteFilePath(QStringLiteral("undo")));
+    m_chunksDir = doc->getCacheDir(CachePreviewChunks, &ok);
 
     // Make sure our cache dirs are inside the temporary folder
-    if (!m_cacheDir.makeAbsolute() || !m_undoDir.makeAbsolute() || !m_undoDir.mkpath(QStringLiteral("."))) {
+    if (!ok || !m_cacheDir.makeAbsolute() || !m_chunksDir.makeAbsolute()) {
         pCore->displayMessage(i18n("Something is wrong with cache folders"), ErrorMessage);
         return false;
     }
+    if (m_cacheDir.exists(QStringLiteral("undo"))) {
+        // Previous versions kept a copy of the chunks for each undo step, they are now found by content
+        QDir undoDir(m_cacheDir.absoluteFilePath(QStringLiteral("undo")));
+        undoDir.removeRecursively();
+    }
 
-    connect(this, &PreviewManager::cleanupOldPreviews, this, &PreviewManager::doCleanupOldPreviews);
-    connect(doc, &KdenliveDoc::removeInvalidUndo, this, &PreviewManager::slotRemoveInvalidUndo, Qt::DirectConnection);
     m_previewTimer.setSingleShot(true);
     m_previewTimer.setInterval(3000);
     connect(&m_previewTimer, &QTimer::timeout, this, &PreviewManager::startPreviewRender);
@@ -150,37 +152,40 @@ void PreviewManager::loadChunks(QVariantList previewChunks, QVariantList dirtyCh
         dirtyChunks = m_dirtyChunks;
     }
 
-    QStringList existingChuncks;
-    if (!previewChunks.isEmpty()) {
-        existingChuncks = m_cacheDir.entryList(QDir::Files);
-    }
-
+    // Chunks are only reused if their content did not change since they were rendered
+    const QMap<int, QString> hashes = chunkHashes(previewChunks);
+    QMap<int, QString> foundChunks;
     int max = playlist.count();
-    std::shared_ptr<Mlt::Producer> clip;
-    m_tractor->lock();
-    if (max == 0) {
-        // Empty timeline preview, mark all as dirty
-        for (auto &prev : previewChunks) {
-            dirtyChunks << prev;
-        }
-    }
-    for (int i = 0; i < max; i++) {
-        if (playlist.is_blank(i)) {
+    for (const auto &prev : qAsConst(previewChunks)) {
+        const int position = prev.toInt();
+        const QString hash = hashes.value(position);
+        if (!hash.isEmpty() && m_chunksDir.exists(chunkFile(hash))) {
+            CacheBudget::touch(chunkFile(hash));
+            foundChunks.insert(position, chunkFile(hash));
             continue;
         }
-        int position = playlist.clip_start(i);
-        if (previewChunks.contains(QString::number(position))) {
-            if (existingChuncks.contains(QString("%1.%2").arg(position).arg(m_extension))) {
-                clip.reset(playlist.get_clip(i));
-                m_renderedChunks << position;
-                m_previewTrack->insert_at(position, clip.get(), 1);
+        // Chunk rendered by a previous version, named by its position
+        const QString legacyFile = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(position).arg(m_extension));
+        int ix = max > 0 ? playlist.get_clip_index_at(position) : -1;
+        if (ix > -1 && ix < max && !playlist.is_blank(ix) && playlist.clip_start(ix) == position && QFile::exists(legacyFile)) {
+            if (!hash.isEmpty() && QFile::rename(legacyFile, chunkFile(hash))) {
+                foundChunks.insert(position, chunkFile(hash));
             } else {
-                dirtyChunks << position;
+                foundChunks.insert(position, legacyFile);
             }
+        } else {
+            dirtyChunks << position;
         }
     }
-    m_previewTrack->consolidate_blanks();
-    m_tractor->unlock();
+    m_dirtyMutex.lock();
+    for (auto i = foundChunks.cbegin(); i != foundChunks.cend(); ++i) {
+        if (!m_renderedChunks.contains(i.key())) {
+            m_renderedChunks << i.key();
+        }
+    }
+    m_dirtyMutex.unlock();
+    reloadChunks(foundChunks);
+    updateChunkIndex();
     if (!dirtyChunks.isEmpty()) {
         std::sort(dirtyChunks.begin(), dirtyChunks.end(), chunkSort);
         QMutexLocker lock(&m_dirtyMutex);
@@ -325,105 +330,132 @@ void PreviewManager::invalidatePreviews()
         m_previewTimer.stop();
         timer = true;
     }
-    KdenliveDoc *doc = pCore->currentDoc();
-    int stackIx = doc->commandStack()->index();
-    int stackMax = doc->commandStack()->count();
-    if (stackIx == stackMax && !m_undoDir.exists(QString::number(stackIx - 1))) {
-        // We just added a new command in stack, archive existing chunks
-        int ix = stackIx - 1;
-        m_undoDir.mkdir(QString::number(ix));
-        bool foundPreviews = false;
-        for (const auto &i : m_dirtyChunks) {
-            QString current = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-            if (m_cacheDir.rename(current, QStringLiteral("undo/%1/%2").arg(ix).arg(current))) {
-                foundPreviews = true;
-            }
-        }
-        if (!foundPreviews) {
-            // No preview files found, remove undo folder
-            m_undoDir.rmdir(QString::number(ix));
-        } else {
-            // new chunks archived, cleanup old ones
-            Q_EMIT cleanupOldPreviews();
-        }
-    } else {
-        // Restore existing chunks, delete others
-        // Check if we just undo the last stack action, then backup, otherwise delete
-        bool lastUndo = false;
-        if (stackIx + 1 == stackMax) {
-            if (!m_undoDir.exists(QString::number(stackMax))) {
-                lastUndo = true;
-                bool foundPreviews = false;
-                m_undoDir.mkdir(QString::number(stackMax));
-                for (const auto &i : m_dirtyChunks) {
-                    QString current = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-                    if (m_cacheDir.rename(current, QStringLiteral("undo/%1/%2").arg(stackMax).arg(current))) {
-                        foundPreviews = true;
-                    }
-                }
-                if (!foundPreviews) {
-                    m_undoDir.rmdir(QString::number(stackMax));
-                }
-            }
-        }
-        bool moveFile = true;
-        QDir tmpDir = m_undoDir;
-        if (!tmpDir.cd(QString::number(stackIx))) {
-            moveFile = false;
-        }
-        QVariantList foundChunks;
-        for (const auto &i : m_dirtyChunks) {
-            QString cacheFileName = QStringLiteral("%1.%2").arg(i.toInt()).arg(m_extension);
-            if (!lastUndo) {
-                m_cacheDir.remove(cacheFileName);
-            }
-            if (moveFile) {
-                if (QFile::copy(tmpDir.absoluteFilePath(cacheFileName), m_cacheDir.absoluteFilePath(cacheFileName))) {
-                    foundChunks << i;
-                } else {
-                    qDebug() << "// ERROR PROCESSE CHUNK: " << i << ", " << cacheFileName;
-                }
-            }
-        }
-        if (!foundChunks.isEmpty()) {
-            std::sort(foundChunks.begin(), foundChunks.end(), chunkSort);
-            m_dirtyMutex.lock();
-            for (auto &ck : foundChunks) {
-                m_dirtyChunks.removeAll(ck);
-                m_renderedChunks << ck;
-            }
-            m_dirtyMutex.unlock();
-            Q_EMIT dirtyChunksChanged();
-            Q_EMIT renderedChunksChanged();
-            reloadChunks(foundChunks);
-        }
-    }
-    doc->setModified(true);
+    // After an undo or if an operation restored a previous state, the chunks are already rendered
+    reuseRenderedChunks();
+    pCore->currentDoc()->setModified(true);
     if (timer) {
         m_previewTimer.start();
     }
 }
 
-void PreviewManager::doCleanupOldPreviews()
+QMap<int, QString> PreviewManager::chunkHashes(const QVariantList &chunks) const
+{
+    std::shared_ptr<TimelineItemModel> timeline = pCore->currentDoc()->getTimeline(m_uuid, true);
+    if (!timeline || chunks.isEmpty()) {
+        return {};
+    }
+    const QString renderParams = QStringLiteral("%1 %2").arg(m_extension, m_consumerParams.join(QLatin1Char(' ')));
+    return timeline->previewChunkHashes(chunks, KdenliveSettings::timelinechunks(), renderParams.toUtf8());
+}
+
+QString PreviewManager::chunkFile(const QString &hash) const
 {
-    if (m_undoDir.dirName() != QLatin1String("undo")) {
+    return m_chunksDir.absoluteFilePath(QStringLiteral("%1.%2").arg(hash, m_extension));
+}
+
+void PreviewManager::reuseRenderedChunks()
+{
+    m_dirtyMutex.lock();
+    const QVariantList dirtyChunks = m_dirtyChunks;
+    m_dirtyMutex.unlock();
+    const QMap<int, QString> hashes = chunkHashes(dirtyChunks);
+    QMap<int, QString> foundChunks;
+    for (auto i = hashes.cbegin(); i != hashes.cend(); ++i) {
+        const QString fileName = chunkFile(i.value());
+        if (QFile::exists(fileName)) {
+            CacheBudget::touch(fileName);
+            foundChunks.insert(i.key(), fileName);
+        }
+    }
+    if (foundChunks.isEmpty()) {
         return;
     }
-    QStringList dirs = m_undoDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    m_dirtyMutex.lock();
+    for (auto i = foundChunks.cbegin(); i != foundChunks.cend(); ++i) {
+        m_dirtyChunks.removeAll(i.key());
+        m_renderedChunks << i.key();
+    }
+    m_dirtyMutex.unlock();
+    Q_EMIT dirtyChunksChanged();
+    Q_EMIT renderedChunksChanged();
+    reloadChunks(foundChunks);
+    updateChunkIndex();
+}
 
-    // Use QCollator to do a natural sorting so that 10 is after 2
-    QCollator collator;
-    collator.setNumericMode(true);
-    std::sort(dirs.begin(), dirs.end(), [&collator](const QString &file1, const QString &file2) { return collator.compare(file1, file2) < 0; });
-    bool ok;
-    while (dirs.count() > 5) {
-        QDir tmp = m_undoDir;
-        QString dirName = dirs.takeFirst();
-        dirName.toInt(&ok);
-        if (ok && tmp.cd(dirName)) {
-            tmp.removeRecursively();
+QStringList PreviewManager::renderedTimeline() const
+{
+    std::shared_ptr<TimelineItemModel> timeline = pCore->currentDoc()->getTimeline(m_uuid, true);
+    if (!timeline || !m_initialized) {
+        return {};
+    }
+    const int duration = timeline->duration();
+    const int chunkSize = KdenliveSettings::timelinechunks();
+    QVariantList chunks;
+    for (int frame = 0; frame < duration; frame += chunkSize) {
+        chunks << frame;
+    }
+    QStringList files;
+    const QMap<int, QString> hashes = chunkHashes(chunks);
+    for (const QString &hash : hashes) {
+        const QString fileName = chunkFile(hash);
+        if (!QFile::exists(fileName)) {
+            return {};
+        }
+        files << fileName;
+    }
+    return files;
+}
+
+QStringList PreviewManager::usedChunkFiles() const
+{
+    QStringList files;
+    if (m_previewTrack == nullptr) {
+        return files;
+    }
+    for (int i = 0; i < m_previewTrack->count(); i++) {
+        if (m_previewTrack->is_blank(i)) {
+            continue;
         }
+        std::unique_ptr<Mlt::Producer> clip(m_previewTrack->get_clip(i));
+        files << QString::fromUtf8(clip->parent().get("resource"));
     }
+    return files;
+}
+
+void PreviewManager::updateChunkIndex()
+{
+    CacheBudget::writeChunkIndex(m_cacheDir, usedChunkFiles());
+}
+
+void PreviewManager::enforceCacheBudget()
+{
+    if (KdenliveSettings::previewcachebudget() <= 0 || m_evictionJob.isRunning()) {
+        return;
+    }
+    bool ok = false;
+    const QDir cacheRoot = pCore->currentDoc()->getCacheDir(CacheRoot, &ok);
+    if (!ok) {
+        return;
+    }
+    // The indexes of all the project sequences, not only this one, list the chunks to keep
+    const QDir projectPreviews = pCore->currentDoc()->getCacheDir(CachePreview, &ok);
+    if (!ok) {
+        return;
+    }
+    const qint64 budget = qint64(1048576) * KdenliveSettings::previewcachebudget();
+    const QStringList usedFiles = usedChunkFiles();
+    const QDir chunksDir = m_chunksDir;
+    m_evictionJob = QtConcurrent::run([cacheRoot, projectPreviews, chunksDir, budget, usedFiles]() {
+        QStringList protectedFiles = usedFiles;
+        const QStringList indexed = CacheBudget::readChunkIndex(projectPreviews);
+        for (const QString &chunk : indexed) {
+            protectedFiles << chunksDir.absoluteFilePath(chunk);
+        }
+        qint64 freed = CacheBudget::evict(cacheRoot, budget, protectedFiles);
+        if (freed > 0) {
+            qDebug() << "::: Removed" << freed << "bytes of least recently used cached previews and thumbnails";
+        }
+    });
 }
 
 void PreviewManager::clearPreviewRange(bool resetZones)
@@ -543,9 +575,12 @@ bool PreviewManager::hasDefinedRange() const
 void PreviewManager::startPreviewRender()
 {
     QMutexLocker lock(&m_previewMutex);
+    // Another sequence or project may have rendered the same content
+    reuseRenderedChunks();
     if (!m_dirtyChunks.isEmpty()) {
         // Abort any rendering
         abortRendering();
+        m_chunkHashes = chunkHashes(m_dirtyChunks);
         m_waitingThumbs.clear();
         // clear log
         m_errorLog.clear();
@@ -630,6 +665,10 @@ void PreviewManager::processEnded(int exitCode, QProcess::ExitStatus status)
     } else {
         // Normal exit and exit code 0: everything okay
         pCore->currentDoc()->previewProgress(1000);
+        updateChunkIndex();
+        enforceCacheBudget();
+        // Nested instances of this sequence may now use the rendered chunks
+        pCore->currentDoc()->setSequenceThumbRequiresUpdate(m_uuid);
     }
     workingPreview = -1;
     m_warnOnCrash = true;
@@ -647,25 +686,6 @@ void PreviewManager::slotProcessDirtyChunks()
     }
 }
 
-void PreviewManager::slotRemoveInvalidUndo(int ix)
-{
-    QMutexLocker lock(&m_previewMutex);
-    if (m_undoDir.dirName() != QLatin1String("undo")) {
-        // Make sure we delete correct folder
-        return;
-    }
-    QStringList dirs = m_undoDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    bool ok;
-    for (const QString &dir : qAsConst(dirs)) {
-        if (dir.toInt(&ok) >= ix && ok) {
-            QDir tmp = m_undoDir;
-            if (tmp.cd(dir)) {
-                tmp.removeRecursively();
-            }
-        }
-    }
-}
-
 void PreviewManager::invalidatePreview(int startFrame, int endFrame)
 {
     if (m_previewTrack == nullptr) {
@@ -736,21 +756,19 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     m_previewGatherTimer.start();
 }
 
-void PreviewManager::reloadChunks(const QVariantList &chunks)
+void PreviewManager::reloadChunks(const QMap<int, QString> &chunks)
 {
     if (m_previewTrack == nullptr || chunks.isEmpty()) {
         return;
     }
     m_tractor->lock();
-    for (const auto &ix : chunks) {
-        if (m_previewTrack->is_blank_at(ix.toInt())) {
-            QString fileName = m_cacheDir.absoluteFilePath(QStringLiteral("%1.%2").arg(ix.toInt()).arg(m_extension));
-            fileName.prepend(QStringLiteral("avformat:"));
+    for (auto i = chunks.cbegin(); i != chunks.cend(); ++i) {
+        if (m_previewTrack->is_blank_at(i.key())) {
+            const QString fileName = QStringLiteral("avformat:%1").arg(i.value());
             Mlt::Producer prod(pCore->getProjectProfile(), fileName.toUtf8().constData());
             if (prod.is_valid()) {
-                // m_ruler->updatePreview(ix, true);
                 prod.set("mlt_service", "avformat-novalidate");
-                m_previewTrack->insert_at(ix.toInt(), &prod, 1);
+                m_previewTrack->insert_at(i.key(), &prod, 1);
             }
         }
     }
@@ -782,7 +800,20 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
         return;
     }
     if (m_previewTrack->is_blank_at(frame)) {
-        Mlt::Producer prod(pCore->getProjectProfile(), QString("avformat:%1").arg(file).toUtf8().constData());
+        // Store the chunk under its content hash so that it can be reused
+        QString fileName = file;
+        const QString hash = m_chunkHashes.value(frame);
+        if (!hash.isEmpty()) {
+            const QString storedFile = chunkFile(hash);
+            if (QFile::exists(storedFile)) {
+                // Same content rendered twice in this job
+                QFile::remove(file);
+                fileName = storedFile;
+            } else if (QFile::rename(file, storedFile)) {
+                fileName = storedFile;
+            }
+        }
+        Mlt::Producer prod(pCore->getProjectProfile(), QString("avformat:%1").arg(fileName).toUtf8().constData());
         if (prod.is_valid() && prod.get_length() == KdenliveSettings::timelinechunks()) {
             m_dirtyMutex.lock();
             m_dirtyChunks.removeAll(QVariant(frame));
@@ -797,8 +828,8 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
             pCore->currentDoc()->previewProgress(progress);
             pCore->currentDoc()->setModified(true);
         } else {
-            qCDebug(KDENLIVE_LOG) << "* * * INVALID PROD: " << file;
-            corruptedChunk(frame, file);
+            qCDebug(KDENLIVE_LOG) << "* * * INVALID PROD: " << fileName;
+            corruptedChunk(frame, fileName);
         }
     } else {
         qCDebug(KDENLIVE_LOG) << "* * * NON EMPTY PROD: " << frame;
@@ -10,6 +10,7 @@
 
 #include <QDir>
 #include <QFuture>
+#include <QMap>
 #include <QMutex>
 #include <QProcess>
 #include <QTimer>
@@ -30,6 +31,8 @@ class Producer;
     This allow us to get a preview with a smooth playback of our project.
     Only the preview zone is rendered. Once defined, a preview zone shows as a red line below
     the timeline ruler. As chunks are rendered, the zone turns to green.
+    Rendered chunks are stored under a hash of their content, so that a chunk is never rendered
+    twice for the same content, even after an undo or in another sequence or project.
  */
 class PreviewManager : public QObject
 {
@@ -79,6 +82,9 @@ public:
     bool hasDefinedRange() const;
     /** @brief Returns true if the render process is still running */
     bool isRunning() const;
+    /** @brief Returns the stored chunks rendering the whole timeline, in timeline order, or an empty list if some are not rendered.
+     *  Nested instances of this sequence use them instead of compositing its tracks */
+    QStringList renderedTimeline() const;
 
 private:
     Mlt::Tractor *m_tractor;
@@ -91,8 +97,10 @@ private:
     QProcess m_previewProcess;
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
-    /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
-    QDir m_undoDir;
+    /** @brief: The directory storing the rendered chunks, named by the hash of their content. It is shared by all sequences and projects. */
+    QDir m_chunksDir;
+    /** @brief: The content hash of the chunks in the current render job. */
+    QMap<int, QString> m_chunkHashes;
     QMutex m_previewMutex;
     QStringList m_consumerParams;
     QString m_extension;
@@ -102,15 +110,28 @@ private:
     QTimer m_previewGatherTimer;
     bool m_initialized;
     QList<int> m_waitingThumbs;
-    QFuture<void> m_previewThread;
+    /** @brief: The cache eviction job, started when a render ends. */
+    QFuture<void> m_evictionJob;
     /** @brief: The count of chunks to process - to calculate job progress */
     int m_chunksToRender;
     /** @brief: The count of already processed chunks - to calculate job progress */
     int m_processedChunks;
     /** @brief: The render process output, useful in case of failure */
     QString m_errorLog;
-    /** @brief: After an undo/redo, if we have preview history, use it. */
-    void reloadChunks(const QVariantList &chunks);
+    /** @brief: Insert the chunk files in the preview track, the map keys are the chunks first frame. */
+    void reloadChunks(const QMap<int, QString> &chunks);
+    /** @brief: Get the content hash of @param chunks, empty if the timeline is not available. */
+    QMap<int, QString> chunkHashes(const QVariantList &chunks) const;
+    /** @brief: The stored file for a chunk with content @param hash. */
+    QString chunkFile(const QString &hash) const;
+    /** @brief: Mark the dirty chunks whose content was already rendered, for example before an undo, as rendered. */
+    void reuseRenderedChunks();
+    /** @brief: The chunk files currently inserted in the preview track. */
+    QStringList usedChunkFiles() const;
+    /** @brief: Record the shared chunks used by this timeline so that the cache usage can be reported per project. */
+    void updateChunkIndex();
+    /** @brief: Remove the least recently used cached previews and thumbnails beyond the cache budget, in a thread. */
+    void enforceCacheBudget();
     /** @brief: A chunk failed to render, abort. */
     void corruptedChunk(int workingPreview, const QString &fileName);
     /** @brief: Get a compressed list of chunks, like: "0-500,525,575". */
@@ -122,12 +143,8 @@ private:
     static bool chunkSort(const QVariant &c1, const QVariant &c2) { return c1.toInt() < c2.toInt(); };
 
 private Q_SLOTS:
-    /** @brief: To avoid filling the hard drive, remove preview undo history after 5 steps. */
-    void doCleanupOldPreviews();
     /** @brief: Start the real rendering process. */
     void doPreviewRender(const QString &scene); // std::shared_ptr<Mlt::Producer> sourceProd);
-    /** @brief: If user does an undo, then makes a new timeline operation, delete undo history of more recent stack . */
-    void slotRemoveInvalidUndo(int ix);
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
     /** @brief: Process preview rendering output. */
@@ -153,7 +170,6 @@ protected:
 
 Q_SIGNALS:
     void abortPreview();
-    void cleanupOldPreviews();
     void previewRender(int frame, const QString &file, int progress);
     void dirtyChunksChanged();
     void renderedChunksChanged();
@@ -11,11 +11,22 @@
 #include "core.h"
 #include "kdenlivesettings.h"
 #include <QElapsedTimer>
+#include <QFontMetrics>
+#include <QGuiApplication>
+#include <QMatrix4x4>
 #include <QPainter>
 #include <QPainterPath>
 #include <QQuickPaintedItem>
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QSGSimpleRectNode>
+#include <QSGSimpleTextureNode>
+#include <QSGTransformNode>
+#include <QSGVertexColorMaterial>
 #include <QtMath>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 class TimelineTriangle : public QQuickPaintedItem
 {
@@ -121,7 +132,90 @@ private:
     QColor m_color;
 };
 
-class TimelineWaveform : public QQuickPaintedItem
+namespace {
+using WavePoint = QSGGeometry::ColoredPoint2D;
+
+/** @brief Append a quad with two parallel vertical sides, as two triangles */
+void appendTrapezoid(std::vector<WavePoint> &points, float x0, float top0, float bottom0, float x1, float top1, float bottom1, const QColor &color,
+                     qreal opacity = 1.)
+{
+    // The vertex color material expects premultiplied colors
+    const qreal alpha = color.alphaF() * opacity;
+    const auto r = uchar(qRound(color.red() * alpha));
+    const auto g = uchar(qRound(color.green() * alpha));
+    const auto b = uchar(qRound(color.blue() * alpha));
+    const auto a = uchar(qRound(255 * alpha));
+    WavePoint corners[4];
+    corners[0].set(x0, top0, r, g, b, a);
+    corners[1].set(x1, top1, r, g, b, a);
+    corners[2].set(x0, bottom0, r, g, b, a);
+    corners[3].set(x1, bottom1, r, g, b, a);
+    points.push_back(corners[0]);
+    points.push_back(corners[1]);
+    points.push_back(corners[2]);
+    points.push_back(corners[2]);
+    points.push_back(corners[1]);
+    points.push_back(corners[3]);
+}
+
+void appendRect(std::vector<WavePoint> &points, float x0, float y0, float x1, float y1, const QColor &color, qreal opacity = 1.)
+{
+    appendTrapezoid(points, x0, y0, y1, x1, y0, y1, color, opacity);
+}
+
+QSGGeometryNode *createVertexColorNode()
+{
+    auto *node = new QSGGeometryNode;
+    auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_ColoredPoint2D(), 0);
+    geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+    node->setGeometry(geometry);
+    node->setFlag(QSGNode::OwnsGeometry);
+    node->setMaterial(new QSGVertexColorMaterial);
+    node->setFlag(QSGNode::OwnsMaterial);
+    return node;
+}
+
+void setVertices(QSGGeometryNode *node, const std::vector<WavePoint> &points)
+{
+    QSGGeometry *geometry = node->geometry();
+    geometry->allocate(int(points.size()));
+    if (!points.empty()) {
+        memcpy(geometry->vertexDataAsColoredPoint2D(), points.data(), points.size() * sizeof(WavePoint));
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+}
+
+/** @brief Scene graph nodes of a waveform: static background and guides, panned levels and channel labels */
+class WaveformNode : public QSGNode
+{
+public:
+    WaveformNode()
+        : background(new QSGSimpleRectNode)
+        , guides(createVertexColorNode())
+        , pan(new QSGTransformNode)
+        , levels(createVertexColorNode())
+    {
+        background->setColor(Qt::transparent);
+        appendChildNode(background);
+        appendChildNode(guides);
+        pan->appendChildNode(levels);
+        appendChildNode(pan);
+    }
+    QSGSimpleRectNode *background;
+    QSGGeometryNode *guides;
+    QSGTransformNode *pan;
+    QSGGeometryNode *levels;
+    QSGSimpleTextureNode *labels{nullptr};
+};
+} // namespace
+
+/** @class TimelineWaveform
+    @brief Draws the audio levels of a clip.
+    The levels are turned into vertex geometry covering the item and a margin of one item width on each side.
+    The geometry is only rebuilt when the levels, zoom, size or colors change, panning (a change of the in point)
+    inside the margin only moves the existing geometry.
+ */
+class TimelineWaveform : public QQuickItem
 {
     Q_OBJECT
     Q_PROPERTY(QColor fillColor0 MEMBER m_bgColor NOTIFY propertyChanged)
@@ -144,18 +238,16 @@ class TimelineWaveform : public QQuickPaintedItem
 
 public:
     TimelineWaveform(QQuickItem *parent = nullptr)
-        : QQuickPaintedItem(parent)
+        : QQuickItem(parent)
         , m_repaint(false)
         , m_speed(1.)
         , m_opaquePaint(false)
     {
-        setAntialiasing(false);
-        setOpaquePainting(m_opaquePaint);
+        setFlag(QQuickItem::ItemHasContents, true);
+        // The geometry extends past the item to allow panning without rebuilding it
+        setClip(true);
         setEnabled(false);
         m_precisionFactor = 1;
-        // setRenderTarget(QQuickPaintedItem::FramebufferObject);
-        // setMipmap(true);
-        // setTextureSize(QSize(1, 1));
         connect(this, &TimelineWaveform::levelsChanged, [&]() {
             if (!m_binId.isEmpty()) {
                 if (m_audioLevels.isEmpty() && m_stream >= 0) {
@@ -163,6 +255,7 @@ public:
                 } else {
                     // Clip changed, reset levels
                     m_audioLevels.clear();
+                    m_levelsVersion++;
                 }
             }
         });
@@ -173,168 +266,276 @@ public:
         connect(this, &TimelineWaveform::propertyChanged, this, static_cast<void (QQuickItem::*)()>(&QQuickItem::update));
     }
 
-    void paint(QPainter *painter) override
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override
     {
+        auto *node = static_cast<WaveformNode *>(oldNode);
+        if (!node) {
+            node = new WaveformNode;
+        }
         if (m_binId.isEmpty()) {
-            return;
+            clearNode(node);
+            return node;
         }
         if (m_audioLevels.isEmpty() && m_stream >= 0) {
             m_audioLevels = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId, m_stream);
             if (m_audioLevels.isEmpty()) {
-                return;
+                clearNode(node);
+                return node;
             }
+            m_levelsVersion++;
             m_audioMax = KdenliveSettings::normalizechannels() ? pCore->projectItemModel()->getAudioMaxLevel(m_binId, m_stream) : 0;
         }
+        if (m_outPoint == m_inPoint || m_channels <= 0 || m_scale <= 0. || qFuzzyIsNull(m_speed)) {
+            clearNode(node);
+            return node;
+        }
+        const QRectF bgRect(0, 0, width(), height());
+        node->background->setRect(bgRect);
+        node->background->setColor(m_opaquePaint ? m_bgColor : QColor(Qt::transparent));
 
-        if (m_outPoint == m_inPoint) {
-            return;
+        GeometryKey key;
+        key.levelsVersion = m_levelsVersion;
+        key.scale = m_scale;
+        key.speed = m_speed;
+        key.channels = m_channels;
+        key.width = width();
+        key.height = height();
+        key.allChannels = KdenliveSettings::displayallchannels();
+        key.audioMax = m_audioMax;
+        key.color = m_color.rgba();
+        key.color2 = m_color2.rgba();
+        key.bgColor = m_bgColor.rgba();
+        key.firstChunk = m_firstChunk;
+
+        const qreal indicesPrPixel = m_channels / m_scale * qAbs(m_speed);
+        const bool reverse = m_speed < 0;
+        int inPoint = m_inPoint;
+        if (reverse) {
+            inPoint = qMin(inPoint, m_audioLevels.length() - m_channels);
         }
-        QRectF bgRect(0, 0, width(), height());
-        if (m_opaquePaint) {
-            painter->fillRect(bgRect, m_bgColor);
+        const int startPos = int(inPoint / indicesPrPixel);
+        const bool sameGeometry = m_builtKey.isValid() && m_builtKey == key;
+        if (!sameGeometry) {
+            // Guides and labels only depend on size and colors
+            buildGuides(node, key);
+            updateLabels(node, key);
         }
-        QPen pen(painter->pen());
-        double increment = qMax(1., m_scale / m_channels);           // qMax(1., 1. / qAbs(indicesPrPixel));
-        qreal indicesPrPixel = m_channels / m_scale * qAbs(m_speed); // qreal(m_outPoint - m_inPoint) / width() * m_precisionFactor;
-        int h = int(height());
-        double offset = 0;
-        bool pathDraw = increment > 1.2;
-        if (increment > 1. && !pathDraw) {
-            pen.setWidth(int(ceil(increment)));
-            offset = pen.width() / 2.;
-            pen.setColor(m_color);
-            pen.setCapStyle(Qt::FlatCap);
-        } else if (pathDraw) {
-            pen.setWidth(0);
-            painter->setBrush(m_color);
-            pen.setColor(m_bgColor.darker(200));
-        } else {
-            pen.setColor(m_color);
+        // Horizontal offset of the built levels for the current in point
+        const int shift = reverse ? startPos - m_builtStartPos : m_builtStartPos - startPos;
+        if (!sameGeometry || qAbs(shift) > m_builtMargin) {
+            buildLevels(node, startPos, reverse, indicesPrPixel);
+            m_builtStartPos = startPos;
+            m_builtKey = key;
+            m_currentShift = 0;
+            node->pan->setMatrix(QMatrix4x4());
+        } else if (shift != m_currentShift) {
+            QMatrix4x4 matrix;
+            matrix.translate(shift, 0);
+            node->pan->setMatrix(matrix);
+            m_currentShift = shift;
         }
-        painter->setPen(pen);
+        return node;
+    }
+
+Q_SIGNALS:
+    void levelsChanged();
+    void propertyChanged();
+    void normalizeChanged();
+    void inPointChanged();
+    void audioChannelsChanged();
+
+private:
+    /** @brief Everything the built geometry depends on, except the in point */
+    struct GeometryKey
+    {
+        int levelsVersion{-1};
+        double scale{0.};
+        double speed{0.};
+        int channels{0};
+        qreal width{0.};
+        qreal height{0.};
+        bool allChannels{false};
+        double audioMax{0.};
+        QRgb color{0};
+        QRgb color2{0};
+        QRgb bgColor{0};
+        bool firstChunk{false};
+        bool isValid() const { return levelsVersion >= 0; }
+        bool operator==(const GeometryKey &other) const
+        {
+            return levelsVersion == other.levelsVersion && qFuzzyCompare(scale, other.scale) && qFuzzyCompare(speed, other.speed) &&
+                   channels == other.channels && qFuzzyCompare(width, other.width) && qFuzzyCompare(height, other.height) &&
+                   allChannels == other.allChannels && qFuzzyCompare(1. + audioMax, 1. + other.audioMax) && color == other.color &&
+                   color2 == other.color2 && bgColor == other.bgColor && firstChunk == other.firstChunk;
+        }
+    };
+
+    void clearNode(WaveformNode *node)
+    {
+        node->background->setRect(QRectF());
+        setVertices(node->guides, {});
+        setVertices(node->levels, {});
+        if (node->labels) {
+            node->removeChildNode(node->labels);
+            delete node->labels;
+            node->labels = nullptr;
+        }
+        m_builtKey = GeometryKey();
+    }
+
+    /** @brief Channel backgrounds and median lines */
+    void buildGuides(WaveformNode *node, const GeometryKey &key)
+    {
+        std::vector<WavePoint> points;
+        if (key.allChannels) {
+            const float w = float(key.width);
+            const double channelHeight = key.height / m_channels;
+            for (int channel = 0; channel < m_channels; channel++) {
+                const float top = float(channel * channelHeight);
+                const float y = float(channel * channelHeight + channelHeight / 2);
+                if (channel % 2 == 0) {
+                    // Add dark background on odd channels
+                    appendRect(points, 0, top, w, float(top + channelHeight), Qt::black, 0.2);
+                }
+                appendRect(points, 0, y, w, y + 1, channel % 2 == 0 ? m_color : m_color2, 0.5);
+            }
+        }
+        setVertices(node->guides, points);
+    }
+
+    void updateLabels(WaveformNode *node, const GeometryKey &key)
+    {
+        if (node->labels) {
+            node->removeChildNode(node->labels);
+            delete node->labels;
+            node->labels = nullptr;
+        }
+        if (!key.allChannels || !m_firstChunk || m_channels < 2 || m_channels > 6 || !window()) {
+            return;
+        }
+        const QStringList channelNames{QStringLiteral("L"), QStringLiteral("R"), QStringLiteral("C"),
+                                       QStringLiteral("LFE"), QStringLiteral("BL"), QStringLiteral("BR")};
+        const QFontMetrics metrics(QGuiApplication::font());
+        const QSize size(metrics.horizontalAdvance(channelNames.at(3)) + 4, qCeil(key.height));
+        const qreal ratio = window()->effectiveDevicePixelRatio();
+        QImage img(size * ratio, QImage::Format_ARGB32_Premultiplied);
+        img.setDevicePixelRatio(ratio);
+        img.fill(Qt::transparent);
+        QPainter painter(&img);
+        painter.setFont(QGuiApplication::font());
+        const double channelHeight = key.height / m_channels;
+        for (int channel = 0; channel < m_channels; channel++) {
+            painter.setPen(channel % 2 == 0 ? m_color : m_color2);
+            const double y = channel * channelHeight + channelHeight / 2;
+            painter.drawText(2, int(y + channelHeight / 2), channelNames.at(channel));
+        }
+        painter.end();
+        node->labels = new QSGSimpleTextureNode;
+        node->labels->setTexture(window()->createTextureFromImage(img));
+        node->labels->setOwnsTexture(true);
+        node->labels->setRect(QRectF(QPointF(0, 0), size));
+        node->appendChildNode(node->labels);
+    }
+
+    /** @brief Build the levels geometry for the in point @param startPos (in pixels) */
+    void buildLevels(WaveformNode *node, int startPos, bool reverse, qreal indicesPrPixel)
+    {
+        std::vector<WavePoint> points;
+        const double increment = qMax(1., m_scale / m_channels);
+        const bool pathDraw = increment > 1.2;
+        const int penWidth = increment > 1. ? int(ceil(increment)) : 1;
+        const double offset = increment > 1. && !pathDraw ? penWidth / 2. : 0.;
+        const int maxLength = m_audioLevels.length();
+        const double h = height();
         double scaleFactor = 255;
         if (m_audioMax > 1) {
             scaleFactor = m_audioMax;
         }
-        bool reverse = m_speed < 0;
-        int maxLength = m_audioLevels.length();
-        if (reverse) {
-            m_inPoint = qMin(m_inPoint, maxLength - m_channels);
-        }
-        int startPos = int(m_inPoint / indicesPrPixel);
+        m_builtMargin = qCeil(width());
+        const int firstColumn = qFloor(-m_builtMargin / increment);
+        const double lastPos = width() + m_builtMargin;
+        auto levelIndex = [&](double i) {
+            int idx;
+            if (reverse) {
+                idx = qCeil((startPos - i) * indicesPrPixel);
+                idx -= idx % m_channels;
+            } else {
+                idx = qCeil((startPos + i) * indicesPrPixel);
+                idx += idx % m_channels;
+            }
+            return idx;
+        };
         if (!KdenliveSettings::displayallchannels()) {
             // Draw merged channels
-            double i = 0;
-            int j = 0;
-            int idx = 0;
-            QPainterPath path;
-            if (pathDraw) {
-                path.moveTo(j - 1, height());
-            }
-            for (; i <= width(); j++) {
-                double level;
-                i = j * increment;
-                if (reverse) {
-                    idx = qCeil((startPos - i) * indicesPrPixel);
-                    idx -= idx % m_channels;
-                } else {
-                    idx = qCeil((startPos + i) * indicesPrPixel);
-                    idx += idx % m_channels;
+            const QColor outline = m_bgColor.darker(200);
+            points.reserve(size_t(qMax(0., (lastPos + m_builtMargin) / increment + 2)) * (pathDraw ? 12 : 6));
+            for (int j = firstColumn;; j++) {
+                const double i = j * increment;
+                if (i > lastPos) {
+                    break;
                 }
-                i -= offset;
+                const int idx = levelIndex(i);
                 if (idx + m_channels >= maxLength || idx < 0) {
-                    break;
+                    continue;
                 }
-                level = m_audioLevels.at(idx) / scaleFactor;
+                double level = m_audioLevels.at(idx) / scaleFactor;
                 for (int k = 1; k < m_channels; k++) {
                     level = qMax(level, m_audioLevels.at(idx + k) / scaleFactor);
                 }
+                const float top = float(h - level * h);
                 if (pathDraw) {
-                    double val = height() - level * height();
-                    path.lineTo(i, val);
-                    path.lineTo((j + 1) * increment - offset, val);
+                    const float x0 = float(i - offset);
+                    const float x1 = float((j + 1) * increment - offset);
+                    appendRect(points, x0, top, x1, float(h), m_color);
+                    appendRect(points, x0, top, x1, top + 1, outline);
                 } else {
-                    painter->drawLine(int(i), h, int(i), int(h - (h * level)));
+                    const float x0 = float(int(i - offset) - (penWidth > 1 ? penWidth / 2 : 0));
+                    appendRect(points, x0, top, x0 + penWidth, float(h), m_color);
                 }
             }
-            if (pathDraw) {
-                path.lineTo(i, height());
-                painter->drawPath(path);
-            }
         } else {
-            double channelHeight = height() / m_channels;
-            QPen pen(painter->pen());
             // Draw separate channels
+            const double channelHeight = h / m_channels;
             scaleFactor = channelHeight / (2 * scaleFactor);
-            bgRect.setHeight(channelHeight);
-            // Path for vector drawing
             for (int channel = 0; channel < m_channels; channel++) {
-                double level;
                 // y is channel median pos
-                double y = (channel * channelHeight) + channelHeight / 2;
-                QPainterPath path;
-                path.moveTo(-1, y);
-                if (channel % 2 == 0) {
-                    // Add dark background on odd channels
-                    painter->setOpacity(0.2);
-                    bgRect.moveTo(0, channel * channelHeight);
-                    painter->fillRect(bgRect, Qt::black);
-                }
-                // Draw channel median line
-                pen.setColor(channel % 2 == 0 ? m_color : m_color2);
-                painter->setBrush(channel % 2 == 0 ? m_color : m_color2);
-                painter->setOpacity(0.5);
-                pen.setWidthF(0);
-                painter->setPen(pen);
-                painter->drawLine(QLineF(0., y, width(), y));
-                pen.setWidth(int(ceil(increment)));
-                painter->setPen(pathDraw ? Qt::NoPen : pen);
-                painter->setOpacity(1);
-                double i = 0;
-                int j = 0;
-                int idx = 0;
-                for (; i <= width(); j++) {
-                    i = j * increment;
-                    if (reverse) {
-                        idx = qCeil((startPos - i) * indicesPrPixel);
-                        idx -= idx % m_channels;
-                    } else {
-                        idx = qCeil((startPos + i) * indicesPrPixel);
-                        idx += idx % m_channels;
+                const double y = (channel * channelHeight) + channelHeight / 2;
+                const QColor &color = channel % 2 == 0 ? m_color : m_color2;
+                bool hasPrevious = false;
+                float previousX = 0;
+                float previousLevel = 0;
+                for (int j = firstColumn;; j++) {
+                    const double i = j * increment;
+                    if (i > lastPos) {
+                        break;
                     }
-                    i -= offset;
-                    idx += channel;
-                    if (idx >= maxLength || idx < 0) break;
+                    const int idx = levelIndex(i) + channel;
+                    if (idx >= maxLength || idx < 0) {
+                        hasPrevious = false;
+                        continue;
+                    }
+                    const float level = float(m_audioLevels.at(idx) * scaleFactor);
                     if (pathDraw) {
-                        level = m_audioLevels.at(idx) * scaleFactor;
-                        path.lineTo(i, y - level);
+                        // Connect the successive levels, mirrored around the median
+                        const float x = float(i - offset);
+                        if (hasPrevious) {
+                            appendTrapezoid(points, previousX, float(y) - previousLevel, float(y) + previousLevel, x, float(y) - level, float(y) + level,
+                                            color);
+                        }
+                        previousX = x;
+                        previousLevel = level;
+                        hasPrevious = true;
                     } else {
-                        level = m_audioLevels.at(idx) * scaleFactor; // divide height by 510 (2*255) to get height
-                        painter->drawLine(int(i), int(y - level), int(i), int(y + level));
+                        const float x0 = float(int(i - offset) - (penWidth > 1 ? penWidth / 2 : 0));
+                        appendRect(points, x0, float(y) - level, x0 + penWidth, float(y) + level, color);
                     }
                 }
-                if (pathDraw) {
-                    path.lineTo(i, y);
-                    painter->drawPath(path);
-                    QTransform tr(1, 0, 0, -1, 0, 2 * y);
-                    painter->drawPath(tr.map(path));
-                }
-                if (m_firstChunk && m_channels > 1 && m_channels < 7) {
-                    const QStringList chanelNames{"L", "R", "C", "LFE", "BL", "BR"};
-                    painter->drawText(2, int(y + channelHeight / 2), chanelNames[channel]);
-                }
             }
         }
+        setVertices(node->levels, points);
     }
 
-Q_SIGNALS:
-    void levelsChanged();
-    void propertyChanged();
-    void normalizeChanged();
-    void inPointChanged();
-    void audioChannelsChanged();
-
-private:
     QVector<uint8_t> m_audioLevels;
     int m_inPoint;
     int m_outPoint;
@@ -354,6 +555,14 @@ private:
     bool m_firstChunk;
     bool m_opaquePaint;
     int m_index;
+    /** @brief Incremented each time the levels are reset or loaded */
+    int m_levelsVersion{0};
+    GeometryKey m_builtKey;
+    /** @brief In point (in pixels) of the built levels geometry */
+    int m_builtStartPos{0};
+    /** @brief Width of the geometry built on each side of the item */
+    int m_builtMargin{0};
+    int m_currentShift{0};
 };
 
 class TimelineRecWaveform : public QQuickPaintedItem
@@ -12,62 +12,246 @@
 #include "doc/kthumb.h"
 #include "utils/thumbnailcache.hpp"
 
-#include <QCryptographicHash>
 #include <QDebug>
+#include <QQuickTextureFactory>
+#include <QThread>
+#include <algorithm>
 #include <mlt++/MltFilter.h>
 #include <mlt++/MltProfile.h>
 
-ThumbnailProvider::ThumbnailProvider()
-    : QQuickImageProvider(QQmlImageProviderBase::Image, QQmlImageProviderBase::ForceAsynchronousImageLoading)
+// Number of frames decoded ahead when thumbnails are requested with a regular step
+#define PREFETCH_COUNT 4
+// Idle thumb producers kept per clip
+#define MAX_IDLE_PRODUCERS 2
+// Number of clips keeping warm thumb producers
+#define MAX_PRODUCER_CLIPS 16
+// Number of times a request is queued again while the clip thumb producer is busy
+#define MAX_ATTEMPTS 10
+
+ThumbnailRenderer *ThumbnailRenderer::get()
 {
+    static ThumbnailRenderer renderer;
+    return &renderer;
 }
 
-ThumbnailProvider::~ThumbnailProvider() = default;
+ThumbnailRenderer::ThumbnailRenderer()
+{
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+}
+
+QString ThumbnailRenderer::requestKey(const QString &binId, int frame)
+{
+    return QStringLiteral("%1#%2").arg(binId).arg(frame);
+}
+
+void ThumbnailRenderer::request(const QString &binId, const QString &generation, int frameNumber, int duration, ThumbnailResponse *response)
+{
+    const QString key = requestKey(binId, frameNumber);
+    QMutexLocker lock(&m_mutex);
+    auto it = m_requests.constFind(key);
+    if (it != m_requests.constEnd()) {
+        // Already queued or decoding, share the result
+        it.value()->responses.push_back(response);
+        it.value()->prefetch = false;
+        return;
+    }
+    auto request = std::make_shared<Request>();
+    request->binId = binId;
+    request->generation = generation;
+    request->frame = frameNumber;
+    request->responses.push_back(response);
+    m_requests.insert(key, request);
+
+    // Thumbnails of a scrolled clip are requested with a constant frame step
+    ScrollState &state = m_scroll[binId];
+    const int step = frameNumber - state.frame;
+    const bool regular = state.frame >= 0 && step != 0 && step == state.step;
+    state.step = step;
+    state.frame = frameNumber;
+    lock.unlock();
+
+    enqueue(request);
+    if (regular) {
+        prefetch(binId, generation, frameNumber, step, duration);
+    }
+}
+
+void ThumbnailRenderer::prefetch(const QString &binId, const QString &generation, int frame, int step, int duration)
+{
+    for (int i = 1; i <= PREFETCH_COUNT; ++i) {
+        const int position = frame + i * step;
+        if (position < 0 || position >= duration) {
+            break;
+        }
+        if (ThumbnailCache::get()->hasThumbnail(binId, position, true)) {
+            continue;
+        }
+        const QString key = requestKey(binId, position);
+        QMutexLocker lock(&m_mutex);
+        if (m_requests.contains(key)) {
+            continue;
+        }
+        auto request = std::make_shared<Request>();
+        request->binId = binId;
+        request->generation = generation;
+        request->frame = position;
+        request->prefetch = true;
+        m_requests.insert(key, request);
+        lock.unlock();
+        enqueue(request);
+    }
+}
 
-QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+void ThumbnailRenderer::enqueue(const std::shared_ptr<Request> &request)
 {
+    // Visible thumbnails go before prefetched ones
+    m_pool.start([this, request]() { process(request); }, request->prefetch ? 0 : 1);
+}
+
+bool ThumbnailRenderer::cancel(ThumbnailResponse *response)
+{
+    QMutexLocker lock(&m_mutex);
+    bool waiting = false;
+    for (auto &request : m_requests) {
+        auto &responses = request->responses;
+        auto it = std::remove(responses.begin(), responses.end(), response);
+        waiting = waiting || it != responses.end();
+        responses.erase(it, responses.end());
+    }
+    return waiting;
+}
+
+void ThumbnailRenderer::process(const std::shared_ptr<Request> &request)
+{
+    const QString key = requestKey(request->binId, request->frame);
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!request->prefetch && request->responses.empty()) {
+            // All requesters went away (scrolled out of view), their responses were finished on cancel
+            m_requests.remove(key);
+            return;
+        }
+    }
     QImage result;
-    // id is binID/#frameNumber
-    QString binId = id.section('/', 0, 0);
-    bool ok;
-    int frameNumber = id.section('#', -1).toInt(&ok);
-    if (ok) {
-        std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
-        if (binClip) {
-            int duration = binClip->frameDuration();
-            if (frameNumber > duration) {
-                // for endless loopable clips, we rewrite the position
-                frameNumber = frameNumber - ((frameNumber / duration) * duration);
+    std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(request->binId);
+    if (binClip) {
+        const QString hash = binClip->hashForThumbs();
+        result = ThumbnailCache::get()->getThumbnail(hash, request->binId, request->frame);
+        if (result.isNull()) {
+            const bool shared = binClip->clipType() == ClipType::Timeline || binClip->clipType() == ClipType::Playlist;
+            const std::shared_ptr<QMutex> clipLock = clipMutex(request->binId);
+            // Sequences and playlists give their master producer, only seek it from one thread at a time
+            QMutexLocker sharedLock(shared ? clipLock.get() : nullptr);
+            std::unique_ptr<Mlt::Producer> prod = takeProducer(binClip, request->generation, shared ? nullptr : clipLock.get());
+            if (prod) {
+                result = makeThumbnail(prod.get(), request->frame);
+                if (!result.isNull()) {
+                    ThumbnailCache::get()->storeThumbnail(request->binId, request->frame, result, false);
+                }
+                if (!shared) {
+                    releaseProducer(request->binId, request->generation, std::move(prod));
+                }
+            } else if (binClip->statusReady() && request->attempts < MAX_ATTEMPTS) {
+                // The thumb producer is being used by a clip job, try again instead of delivering a blank image that is never cached
+                sharedLock.unlock();
+                request->attempts++;
+                QThread::msleep(20);
+                enqueue(request);
+                return;
             }
-            result = ThumbnailCache::get()->getThumbnail(binClip->hashForThumbs(), binId, frameNumber);
-            if (!result.isNull()) {
+        }
+    }
+    QMutexLocker lock(&m_mutex);
+    m_requests.remove(key);
+    for (ThumbnailResponse *response : request->responses) {
+        response->deliver(result);
+    }
+    request->responses.clear();
+}
 
-                *size = result.size();
-                return result;
-            }
-            std::unique_ptr<Mlt::Producer> prod = binClip->getThumbProducer();
-            if (prod && prod->is_valid()) {
-                if (binClip->clipType() != ClipType::Timeline && binClip->clipType() != ClipType::Playlist) {
-                    Mlt::Profile *prodProfile = &pCore->thumbProfile();
-                    Mlt::Filter scaler(*prodProfile, "swscale");
-                    Mlt::Filter padder(*prodProfile, "resize");
-                    Mlt::Filter converter(*prodProfile, "avcolor_space");
-                    prod->attach(scaler);
-                    prod->attach(padder);
-                    prod->attach(converter);
-                }
-                result = makeThumbnail(std::move(prod), frameNumber, requestedSize);
-                ThumbnailCache::get()->storeThumbnail(binId, frameNumber, result, false);
+std::shared_ptr<QMutex> ThumbnailRenderer::clipMutex(const QString &binId)
+{
+    QMutexLocker lock(&m_producersMutex);
+    std::shared_ptr<QMutex> &mutex = m_clipMutexes[binId];
+    if (!mutex) {
+        mutex = std::make_shared<QMutex>();
+    }
+    return mutex;
+}
+
+std::unique_ptr<Mlt::Producer> ThumbnailRenderer::takeProducer(const std::shared_ptr<ProjectClip> &clip, const QString &generation, QMutex *buildMutex)
+{
+    const bool reusable = clip->clipType() != ClipType::Timeline && clip->clipType() != ClipType::Playlist;
+    if (reusable) {
+        QMutexLocker lock(&m_producersMutex);
+        auto it = m_producers.find(clip->binId());
+        if (it != m_producers.end()) {
+            if (it->second.generation != generation) {
+                // The clip was reloaded, its producers are outdated
+                it->second.idle.clear();
+                it->second.generation = generation;
+            } else if (!it->second.idle.empty()) {
+                std::unique_ptr<Mlt::Producer> prod = std::move(it->second.idle.back());
+                it->second.idle.pop_back();
+                return prod;
             }
         }
     }
-    if (size) *size = result.size();
-    return result;
+    std::unique_ptr<Mlt::Producer> prod;
+    {
+        // The clip refuses to build a second thumb producer while one is being built
+        QMutexLocker buildLock(buildMutex);
+        prod = clip->getThumbProducer();
+    }
+    if (!prod || !prod->is_valid()) {
+        return nullptr;
+    }
+    if (reusable) {
+        Mlt::Profile *prodProfile = &pCore->thumbProfile();
+        Mlt::Filter scaler(*prodProfile, "swscale");
+        Mlt::Filter padder(*prodProfile, "resize");
+        Mlt::Filter converter(*prodProfile, "avcolor_space");
+        prod->attach(scaler);
+        prod->attach(padder);
+        prod->attach(converter);
+    }
+    return prod;
 }
 
-QImage ThumbnailProvider::makeThumbnail(std::unique_ptr<Mlt::Producer> producer, int frameNumber, const QSize &requestedSize)
+void ThumbnailRenderer::releaseProducer(const QString &binId, const QString &generation, std::unique_ptr<Mlt::Producer> producer)
+{
+    QMutexLocker lock(&m_producersMutex);
+    ProducerPool &pool = m_producers[binId];
+    if (pool.generation.isEmpty()) {
+        pool.generation = generation;
+    }
+    if (pool.generation == generation && pool.idle.size() < MAX_IDLE_PRODUCERS) {
+        pool.idle.push_back(std::move(producer));
+    }
+    m_recentClips.remove(binId);
+    m_recentClips.push_back(binId);
+    while (m_recentClips.size() > MAX_PRODUCER_CLIPS) {
+        m_producers.erase(m_recentClips.front());
+        m_recentClips.pop_front();
+    }
+}
+
+void ThumbnailRenderer::clear()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+    QMutexLocker lock(&m_mutex);
+    m_requests.clear();
+    m_scroll.clear();
+    lock.unlock();
+    QMutexLocker producersLock(&m_producersMutex);
+    m_producers.clear();
+    m_clipMutexes.clear();
+    m_recentClips.clear();
+}
+
+QImage ThumbnailRenderer::makeThumbnail(Mlt::Producer *producer, int frameNumber)
 {
-    Q_UNUSED(requestedSize)
     producer->seek(frameNumber);
     std::unique_ptr<Mlt::Frame> frame(producer->get_frame());
     if (frame == nullptr || !frame->is_valid()) {
@@ -82,3 +266,55 @@ QImage ThumbnailProvider::makeThumbnail(std::unique_ptr<Mlt::Producer> producer,
     int fullWidth = qRound(imageHeight * pCore->getCurrentDar());
     return KThumb::getFrame(frame.get(), imageWidth, imageHeight, fullWidth);
 }
+
+QQuickTextureFactory *ThumbnailResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+void ThumbnailResponse::cancel()
+{
+    // The QML engine only deletes the response once it is finished
+    if (ThumbnailRenderer::get()->cancel(this)) {
+        deliver(QImage());
+    }
+}
+
+void ThumbnailResponse::deliver(const QImage &image)
+{
+    m_image = image;
+    // The requester only connects to finished once the response is returned, notify from its thread
+    QMetaObject::invokeMethod(
+        this, [this]() { Q_EMIT finished(); }, Qt::QueuedConnection);
+}
+
+ThumbnailProvider::ThumbnailProvider() = default;
+
+ThumbnailProvider::~ThumbnailProvider() = default;
+
+QQuickImageResponse *ThumbnailProvider::requestImageResponse(const QString &id, const QSize &requestedSize)
+{
+    Q_UNUSED(requestedSize)
+    auto *response = new ThumbnailResponse();
+    // id is binID/#frameNumber
+    QString binId = id.section('/', 0, 0);
+    bool ok;
+    int frameNumber = id.section('#', -1).toInt(&ok);
+    std::shared_ptr<ProjectClip> binClip = ok ? pCore->projectItemModel()->getClipByBinID(binId) : nullptr;
+    if (!binClip) {
+        response->deliver(QImage());
+        return response;
+    }
+    int duration = binClip->frameDuration();
+    if (duration > 0 && frameNumber > duration) {
+        // for endless loopable clips, we rewrite the position
+        frameNumber = frameNumber - ((frameNumber / duration) * duration);
+    }
+    QImage result = ThumbnailCache::get()->getThumbnail(binClip->hashForThumbs(), binId, frameNumber);
+    if (!result.isNull()) {
+        response->deliver(result);
+        return response;
+    }
+    ThumbnailRenderer::get()->request(binId, id.section('/', 1, 1), frameNumber, duration, response);
+    return response;
+}
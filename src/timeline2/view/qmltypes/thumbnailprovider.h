@@ -7,21 +7,105 @@
 
 #pragma once
 
-#include <KImageCache>
-#include <QCache>
-#include <QQuickImageProvider>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QQuickAsyncImageProvider>
+#include <QQuickImageResponse>
+#include <QThreadPool>
+#include <list>
+#include <map>
 #include <memory>
 #include <mlt++/MltProducer.h>
 #include <mlt++/MltProfile.h>
+#include <vector>
 
-class ThumbnailProvider : public QQuickImageProvider
+class ProjectClip;
+class ThumbnailResponse;
+
+/** @class ThumbnailRenderer
+    @brief Decodes timeline thumbnails on a thread pool, shared by all thumbnail providers.
+    Requests for the same frame are coalesced into one decode, requests whose image is not wanted
+    anymore are dropped before decoding. Each clip keeps a few thumb producers alive between requests
+    so that they don't have to be rebuilt, and frames following a regular scroll pattern are prefetched.
+ */
+class ThumbnailRenderer
 {
 public:
-    explicit ThumbnailProvider();
-    ~ThumbnailProvider() override;
-    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+    static ThumbnailRenderer *get();
+    /** @brief Queue the decoding of a thumbnail, @param response is delivered when it is ready
+     *  @param generation identifies the state of the clip, it changes when the clip is reloaded
+     *  @param duration the clip duration, frames past it are not prefetched
+     */
+    void request(const QString &binId, const QString &generation, int frameNumber, int duration, ThumbnailResponse *response);
+    /** @brief The image of @param response is not needed anymore.
+     *  @returns true if it was waiting for a thumbnail, false if it was already delivered */
+    bool cancel(ThumbnailResponse *response);
+    /** @brief Wait for the running decodes and release all producers, for example when the project is closed */
+    void clear();
+
+private:
+    ThumbnailRenderer();
+    struct Request
+    {
+        QString binId;
+        QString generation;
+        int frame;
+        bool prefetch = false;
+        /** @brief Number of times the request was queued again because the clip producer was busy */
+        int attempts = 0;
+        std::vector<ThumbnailResponse *> responses;
+    };
+    struct ProducerPool
+    {
+        QString generation;
+        std::vector<std::unique_ptr<Mlt::Producer>> idle;
+    };
+    /** @brief Last requested frame and frame step for a clip, used to predict the next requests */
+    struct ScrollState
+    {
+        int frame = -1;
+        int step = 0;
+    };
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    QHash<QString, std::shared_ptr<Request>> m_requests;
+    QHash<QString, ScrollState> m_scroll;
+    QMutex m_producersMutex;
+    std::map<QString, ProducerPool> m_producers;
+    /** @brief Clips ordered from least to most recently used, to limit the number of warm producers */
+    std::list<QString> m_recentClips;
+    /** @brief Serializes the thumb producer creation of each clip, and the decoding of the shared sequence and playlist producers */
+    std::map<QString, std::shared_ptr<QMutex>> m_clipMutexes;
+
+    static QString requestKey(const QString &binId, int frame);
+    void enqueue(const std::shared_ptr<Request> &request);
+    void process(const std::shared_ptr<Request> &request);
+    void prefetch(const QString &binId, const QString &generation, int frame, int step, int duration);
+    std::shared_ptr<QMutex> clipMutex(const QString &binId);
+    /** @brief Get an idle thumb producer of @param clip or build one, holding @param buildMutex while it is built */
+    std::unique_ptr<Mlt::Producer> takeProducer(const std::shared_ptr<ProjectClip> &clip, const QString &generation, QMutex *buildMutex);
+    void releaseProducer(const QString &binId, const QString &generation, std::unique_ptr<Mlt::Producer> producer);
+    QImage makeThumbnail(Mlt::Producer *producer, int frameNumber);
+};
+
+class ThumbnailResponse : public QQuickImageResponse
+{
+    Q_OBJECT
+public:
+    QQuickTextureFactory *textureFactory() const override;
+    void cancel() override;
+    /** @brief Set the image and notify the requester, can be called from any thread */
+    void deliver(const QImage &image);
 
 private:
-    Mlt::Profile m_profile;
-    QImage makeThumbnail(std::unique_ptr<Mlt::Producer> producer, int frameNumber, const QSize &requestedSize);
+    QImage m_image;
+};
+
+class ThumbnailProvider : public QQuickAsyncImageProvider
+{
+public:
+    explicit ThumbnailProvider();
+    ~ThumbnailProvider() override;
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize) override;
 };
@@ -3319,30 +3319,34 @@ void TimelineController::setAudioRef(int clipId)
         }
     }
     m_audioRef = clipId;
+    m_audioAlignments.clear();
+    m_pendingAlignments = 0;
     std::unique_ptr<AudioEnvelope> envelope(new AudioEnvelope(getClipBinId(clipId), clipId));
     m_audioCorrelator.reset(new AudioCorrelation(std::move(envelope)));
-    connect(m_audioCorrelator.get(), &AudioCorrelation::gotAudioAlignData, this, [&](int cid, int shift) {
+    connect(m_audioCorrelator.get(), &AudioCorrelation::gotAudioAlignData, this, [&](int cid, int shift, double confidence) {
+        m_pendingAlignments--;
         // Ensure the clip was not deleted while processing calculations
         if (m_model->isClip(cid)) {
             int pos = m_model->getClipPosition(m_audioRef) + shift - m_model->getClipIn(m_audioRef);
-            bool result = m_model->requestClipMove(cid, m_model->getClipTrackId(cid), pos, true, true, true);
-            if (!result) {
-                pCore->displayMessage(i18n("Cannot move clip to frame %1.", (pos + shift)), ErrorMessage, 500);
-            }
+            m_audioAlignments.push_back({cid, pos, confidence});
         } else {
             // Clip was deleted, discard audio reference
             m_audioRef = -1;
         }
+        if (m_pendingAlignments <= 0) {
+            applyAudioAlignments();
+        }
     });
     connect(m_audioCorrelator.get(), &AudioCorrelation::displayMessage, pCore.get(), &Core::displayMessage);
 }
 
 void TimelineController::alignAudio(int clipId)
 {
-    // find other clip
+    std::unordered_set<int> clipsToAnalyse;
     if (clipId == -1) {
-        clipId = getMainSelectedClip();
-        if (clipId == -1) {
+        // Align the whole selection
+        clipsToAnalyse = m_model->getCurrentSelection();
+        if (clipsToAnalyse.empty()) {
             pCore->displayMessage(i18n("No clip selected"), ErrorMessage, 500);
             return;
         }
@@ -3352,12 +3356,15 @@ void TimelineController::alignAudio(int clipId)
         return;
     }
     const QString masterBinClipId = getClipBinId(m_audioRef);
-    std::unordered_set<int> clipsToAnalyse;
-    if (m_model->m_groups->isInGroup(clipId)) {
-        clipsToAnalyse = m_model->getGroupElements(clipId);
+    if (clipId > -1) {
+        if (m_model->m_groups->isInGroup(clipId)) {
+            clipsToAnalyse = m_model->getGroupElements(clipId);
+        } else {
+            clipsToAnalyse.insert(clipId);
+        }
+    }
+    if (clipsToAnalyse.size() > 1) {
         m_model->requestClearSelection();
-    } else {
-        clipsToAnalyse.insert(clipId);
     }
     QList<int> processedGroups;
     int processed = 0;
@@ -3387,15 +3394,13 @@ void TimelineController::alignAudio(int clipId)
             // easy, same clip.
             int newPos = m_model->getClipPosition(m_audioRef) - m_model->getClipIn(m_audioRef) + m_model->getClipIn(cid);
             if (newPos) {
-                bool result = m_model->requestClipMove(cid, m_model->getClipTrackId(cid), newPos, true, true, true);
+                m_audioAlignments.push_back({cid, newPos, 1.});
                 processed++;
-                if (!result) {
-                    pCore->displayMessage(i18n("Cannot move clip to frame %1.", newPos), ErrorMessage, 500);
-                }
                 continue;
             }
         }
         processed++;
+        m_pendingAlignments++;
         // Perform audio calculation
         auto *envelope =
             new AudioEnvelope(otherBinId, cid, size_t(m_model->getClipIn(cid)), size_t(m_model->getClipPlaytime(cid)), size_t(m_model->getClipPosition(cid)));
@@ -3404,7 +3409,55 @@ void TimelineController::alignAudio(int clipId)
     if (processed == 0) {
         // TODO: improve feedback message after freeze
         pCore->displayMessage(i18n("Select a clip to apply an effect"), ErrorMessage, 500);
+    } else if (m_pendingAlignments == 0) {
+        // Only copies of the reference clip, no analysis needed
+        applyAudioAlignments();
+    } else {
+        pCore->displayMessage(i18np("Analyzing audio of %1 clip", "Analyzing audio of %1 clips", m_pendingAlignments), ProcessingJobMessage, 0);
+    }
+}
+
+void TimelineController::applyAudioAlignments()
+{
+    if (m_audioAlignments.empty()) {
+        return;
+    }
+    // Below this correlation, the alignment is probably wrong
+    const double lowConfidence = 0.3;
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    QStringList results;
+    bool uncertain = false;
+    int moved = 0;
+    for (const AudioAlignment &alignment : m_audioAlignments) {
+        const int cid = alignment.clipId;
+        if (!m_model->isClip(cid)) {
+            continue;
+        }
+        bool result;
+        if (m_model->m_groups->isInGroup(cid)) {
+            int groupId = m_model->m_groups->getRootId(cid);
+            int delta = alignment.position - m_model->getClipPosition(cid);
+            result = delta == 0 || m_model->requestGroupMove(cid, groupId, 0, delta, true, true, undo, redo);
+        } else {
+            result = m_model->requestClipMove(cid, m_model->getClipTrackId(cid), alignment.position, true, true, true, true, undo, redo);
+        }
+        if (!result) {
+            pCore->displayMessage(i18n("Cannot move clip to frame %1.", alignment.position), ErrorMessage, 500);
+            continue;
+        }
+        moved++;
+        uncertain = uncertain || alignment.confidence < lowConfidence;
+        results << i18nc("@info clip name and alignment confidence", "%1 (%2%)", m_model->getClipName(cid), qRound(100 * alignment.confidence));
+    }
+    m_audioAlignments.clear();
+    if (moved == 0) {
+        return;
     }
+    pCore->pushUndo(undo, redo, i18np("Align clip", "Align clips", moved));
+    const QString message = i18np("Aligned clip: %2", "Aligned %1 clips: %2", moved, results.join(QStringLiteral(", ")));
+    pCore->displayMessage(uncertain ? i18n("%1. Low confidence results may be wrong.", message) : message,
+                          uncertain ? ErrorMessage : OperationCompletedMessage, 500);
 }
 
 void TimelineController::switchTrackActive(int trackId)
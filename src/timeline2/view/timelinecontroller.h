@@ -473,6 +473,9 @@ public:
     Q_INVOKABLE void splitAudio(int clipId);
     Q_INVOKABLE void splitVideo(int clipId);
     Q_INVOKABLE void setAudioRef(int clipId = -1);
+    /** @brief Align clips on the audio reference. If @param clipId is -1, all selected clips are aligned in one operation,
+     *  otherwise the clip (or its group) is aligned
+     */
     Q_INVOKABLE void alignAudio(int clipId = -1);
     Q_INVOKABLE void urlDropped(QStringList droppedFile, int frame, int tid);
 
@@ -791,9 +794,22 @@ private:
     /** @brief The position of the active subtitle in the menu list*/
     int m_activeSubPosition{-1};
 
+    /** @brief An audio alignment result waiting for the other clips of its batch */
+    struct AudioAlignment
+    {
+        int clipId;
+        int position;
+        double confidence;
+    };
+    std::vector<AudioAlignment> m_audioAlignments;
+    /** @brief Number of clips of the audio alignment batch still being analyzed */
+    int m_pendingAlignments{0};
+
     int getMenuOrTimelinePos() const;
     /** @brief Prepare the preview manager */
     void connectPreviewManager();
+    /** @brief Move the clips of the finished audio alignment batch, as a single undo operation */
+    void applyAudioAlignments();
 
 Q_SIGNALS:
     void selected(Mlt::Producer *producer);
@@ -0,0 +1,178 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "cachebudget.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+struct CachedFile
+{
+    QString path;
+    qint64 size;
+    QDateTime lastUsed;
+};
+
+const QString indexName()
+{
+    return QStringLiteral("chunks.index");
+}
+
+/** @brief Collect the cached files in @param path, scene lists being rendered and indexes are not part of the cache */
+qint64 collect(const QString &path, bool recursive, QVector<CachedFile> &files)
+{
+    qint64 size = 0;
+    QDirIterator it(path, QDir::Files | QDir::NoDotAndDotDot, recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        if (info.fileName() == indexName() || info.suffix() == QLatin1String("mlt")) {
+            continue;
+        }
+        files.append({info.absoluteFilePath(), info.size(), info.lastModified()});
+        size += info.size();
+    }
+    return size;
+}
+
+/** @brief The project folders are named by the document id, the number of milliseconds since epoch at creation */
+QStringList projectFolders(const QDir &cacheRoot)
+{
+    QStringList folders = cacheRoot.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    folders.erase(std::remove_if(folders.begin(), folders.end(),
+                                 [](const QString &name) {
+                                     bool ok;
+                                     name.toLongLong(&ok);
+                                     return !ok;
+                                 }),
+                  folders.end());
+    return folders;
+}
+} // namespace
+
+void CacheBudget::touch(const QString &file)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    // Eviction does not need a finer resolution, this avoids a write on every cache hit
+    if (QFileInfo(file).lastModified().secsTo(now) < 86400) {
+        return;
+    }
+    // Changing the file time requires write access on Windows
+    QFile f(file);
+    if (f.open(QIODevice::ReadWrite)) {
+        f.setFileTime(now, QFileDevice::FileModificationTime);
+    }
+}
+
+void CacheBudget::writeChunkIndex(const QDir &previewDir, const QStringList &chunkFiles)
+{
+    QSaveFile file(previewDir.absoluteFilePath(indexName()));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return;
+    }
+    for (const QString &chunk : chunkFiles) {
+        file.write(QFileInfo(chunk).fileName().toUtf8());
+        file.write("\n");
+    }
+    file.commit();
+}
+
+QStringList CacheBudget::readChunkIndex(const QDir &previewDir)
+{
+    QStringList chunks;
+    QDirIterator it(previewDir.absolutePath(), {indexName()}, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            continue;
+        }
+        const QStringList lines = QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+        for (const QString &line : lines) {
+            if (!chunks.contains(line)) {
+                chunks << line;
+            }
+        }
+    }
+    return chunks;
+}
+
+CacheBudget::Report CacheBudget::usage(const QDir &cacheRoot)
+{
+    Report report;
+    QVector<CachedFile> files;
+    const QDir sharedDir(cacheRoot.absoluteFilePath(QStringLiteral("previewchunks")));
+    report.sharedPreviews = collect(sharedDir.absolutePath(), false, files);
+    report.total = report.sharedPreviews;
+    const QStringList folders = projectFolders(cacheRoot);
+    for (const QString &folder : folders) {
+        const QDir projectDir(cacheRoot.absoluteFilePath(folder));
+        ProjectUsage project;
+        project.documentId = folder;
+        project.lastUsed = QFileInfo(projectDir.absolutePath()).lastModified();
+        // The last saved path of the project is stored as a hidden file name
+        const QStringList saved = projectDir.entryList({QStringLiteral("*.kdenlive")}, QDir::Files | QDir::Hidden, QDir::Time);
+        if (!saved.isEmpty()) {
+            project.projectFile = QUrl::fromPercentEncoding(saved.constFirst().toUtf8()).mid(1);
+        }
+        files.clear();
+        const QDir previewDir(projectDir.absoluteFilePath(QStringLiteral("preview")));
+        project.previews = collect(previewDir.absolutePath(), true, files);
+        project.thumbnails = collect(projectDir.absoluteFilePath(QStringLiteral("videothumbs")), false, files);
+        project.thumbnails += collect(projectDir.absoluteFilePath(QStringLiteral("audiothumbs")), false, files);
+        for (const CachedFile &file : qAsConst(files)) {
+            project.lastUsed = qMax(project.lastUsed, file.lastUsed);
+        }
+        const QStringList chunks = readChunkIndex(previewDir);
+        for (const QString &chunk : chunks) {
+            const QFileInfo info(sharedDir.absoluteFilePath(chunk));
+            if (info.exists()) {
+                project.sharedPreviews += info.size();
+                project.lastUsed = qMax(project.lastUsed, info.lastModified());
+            }
+        }
+        report.total += project.previews + project.thumbnails;
+        report.projects << project;
+    }
+    std::sort(report.projects.begin(), report.projects.end(),
+              [](const ProjectUsage &a, const ProjectUsage &b) { return a.lastUsed > b.lastUsed; });
+    return report;
+}
+
+qint64 CacheBudget::evict(const QDir &cacheRoot, qint64 budget, const QStringList &protectedFiles)
+{
+    QVector<CachedFile> files;
+    qint64 total = collect(cacheRoot.absoluteFilePath(QStringLiteral("previewchunks")), false, files);
+    const QStringList folders = projectFolders(cacheRoot);
+    for (const QString &folder : folders) {
+        const QDir projectDir(cacheRoot.absoluteFilePath(folder));
+        total += collect(projectDir.absoluteFilePath(QStringLiteral("preview")), true, files);
+        total += collect(projectDir.absoluteFilePath(QStringLiteral("videothumbs")), false, files);
+        total += collect(projectDir.absoluteFilePath(QStringLiteral("audiothumbs")), false, files);
+    }
+    if (total <= budget) {
+        return 0;
+    }
+    QSet<QString> keep;
+    for (const QString &file : protectedFiles) {
+        keep.insert(QFileInfo(file).absoluteFilePath());
+    }
+    std::sort(files.begin(), files.end(), [](const CachedFile &a, const CachedFile &b) { return a.lastUsed < b.lastUsed; });
+    qint64 freed = 0;
+    for (const CachedFile &file : qAsConst(files)) {
+        if (total - freed <= budget) {
+            break;
+        }
+        if (!keep.contains(file.path) && QFile::remove(file.path)) {
+            freed += file.size;
+        }
+    }
+    return freed;
+}
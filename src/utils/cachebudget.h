@@ -0,0 +1,58 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDateTime>
+#include <QDir>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/** @namespace CacheBudget
+    @brief Keeps the timeline previews and thumbnails cached for all projects within a disk budget.
+    When the budget is exceeded, the least recently used files are removed first, whatever project they belong to.
+    File systems are often mounted without access time updates, so the cache users mark the files they read with
+    touch(), which updates their modification time.
+    Only QtCore is used so that the cache can be reported and cleaned from the command line.
+ */
+namespace CacheBudget {
+/** @brief The cache usage of a project, sizes are in bytes */
+struct ProjectUsage
+{
+    QString documentId;
+    /** @brief The last saved path of the project, if known */
+    QString projectFile;
+    /** @brief Timeline previews in the project cache folder */
+    qint64 previews = 0;
+    /** @brief Shared timeline preview chunks used by the project */
+    qint64 sharedPreviews = 0;
+    /** @brief Audio and video thumbnails */
+    qint64 thumbnails = 0;
+    QDateTime lastUsed;
+};
+
+struct Report
+{
+    QVector<ProjectUsage> projects;
+    /** @brief Size of all the shared timeline preview chunks */
+    qint64 sharedPreviews = 0;
+    /** @brief Size of all the files managed by the budget */
+    qint64 total = 0;
+};
+
+/** @brief Mark the cached @param file as used now, the file time is only updated if it is older than a day */
+void touch(const QString &file);
+/** @brief Record the shared chunks used by a project timeline, @param previewDir is the timeline preview cache folder */
+void writeChunkIndex(const QDir &previewDir, const QStringList &chunkFiles);
+/** @brief The shared chunks used by the timeline previews of a project, read from the indexes under @param previewDir */
+QStringList readChunkIndex(const QDir &previewDir);
+/** @brief Collect the cache usage of the projects in @param cacheRoot */
+Report usage(const QDir &cacheRoot);
+/** @brief Remove the least recently used previews and thumbnails of @param cacheRoot until they fit in @param budget bytes.
+    @param protectedFiles are currently used and never removed
+    @returns the number of bytes freed */
+qint64 evict(const QDir &cacheRoot, qint64 budget, const QStringList &protectedFiles = QStringList());
+} // namespace CacheBudget
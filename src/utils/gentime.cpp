@@ -6,112 +6,64 @@
 
 #include "gentime.h"
 
-double GenTime::s_delta = 0.00001;
+constexpr qint64 GenTime::TicksPerSecond;
 
-GenTime::GenTime()
+GenTime::GenTime(double seconds)
+    : m_ticks(qRound64(seconds * TicksPerSecond))
 {
-    m_time = 0.0;
 }
 
-GenTime::GenTime(double seconds)
+GenTime::GenTime(int frames, double framesPerSecond)
+    : m_ticks(frames * ticksPerFrame(framesPerSecond))
 {
-    m_time = seconds;
 }
 
-GenTime::GenTime(int frames, double framesPerSecond)
+qint64 GenTime::ticksPerFrame(double framesPerSecond)
 {
-    m_time = (double)frames / framesPerSecond;
+    if (framesPerSecond <= 0) {
+        return TicksPerSecond;
+    }
+    // Exact for all rates dividing 705600000, like 24, 25, 30, 48, 50, 60, 120 and their NTSC variants
+    return qMax(qint64(1), qRound64(TicksPerSecond / framesPerSecond));
 }
 
 double GenTime::seconds() const
 {
-    return m_time;
+    return double(m_ticks) / TicksPerSecond;
 }
 
 double GenTime::ms() const
 {
-    return m_time * 1000;
+    return double(m_ticks) * 1000. / TicksPerSecond;
 }
 
 int GenTime::frames(double framesPerSecond) const
 {
-    return (int)floor(m_time * framesPerSecond + 0.5);
+    const qint64 frameTicks = ticksPerFrame(framesPerSecond);
+    // Round to the nearest frame, halves rounded up like floor(x + 0.5)
+    qint64 frames = m_ticks / frameTicks;
+    qint64 remainder = m_ticks % frameTicks;
+    if (remainder < 0) {
+        remainder += frameTicks;
+        frames--;
+    }
+    if (2 * remainder >= frameTicks) {
+        frames++;
+    }
+    return int(frames);
 }
 
 QString GenTime::toString() const
 {
-    return QStringLiteral("%1 s").arg(m_time, 0, 'f', 2);
-}
-
-GenTime GenTime::operator-()
-{
-    return GenTime(-m_time);
-}
-
-GenTime &GenTime::operator+=(GenTime op)
-{
-    m_time += op.m_time;
-    return *this;
-}
-
-GenTime &GenTime::operator-=(GenTime op)
-{
-    m_time -= op.m_time;
-    return *this;
-}
-
-GenTime GenTime::operator+(GenTime op) const
-{
-    return GenTime(m_time + op.m_time);
-}
-
-GenTime GenTime::operator-(GenTime op) const
-{
-    return GenTime(m_time - op.m_time);
+    return QStringLiteral("%1 s").arg(seconds(), 0, 'f', 2);
 }
 
 GenTime GenTime::operator*(double op) const
 {
-    return GenTime(m_time * op);
+    return fromTicks(qRound64(double(m_ticks) * op));
 }
 
 GenTime GenTime::operator/(double op) const
 {
-    return GenTime(m_time / op);
-}
-
-bool GenTime::operator<(GenTime op) const
-{
-    return m_time + s_delta < op.m_time;
-}
-
-bool GenTime::operator>(GenTime op) const
-{
-    return m_time > op.m_time + s_delta;
-}
-
-bool GenTime::operator>=(GenTime op) const
-{
-    return m_time + s_delta >= op.m_time;
-}
-
-bool GenTime::operator<=(GenTime op) const
-{
-    return m_time <= op.m_time + s_delta;
-}
-
-bool GenTime::operator==(GenTime op) const
-{
-    return fabs(m_time - op.m_time) < s_delta;
-}
-
-bool GenTime::operator!=(GenTime op) const
-{
-    return fabs(m_time - op.m_time) >= s_delta;
-}
-
-// static
-void GenTime::setFps(double fps)
-{
-    s_delta = 0.9 / fps;
+    return fromTicks(qRound64(double(m_ticks) / op));
 }
@@ -7,18 +7,28 @@
 #pragma once
 
 #include <QString>
+#include <QtGlobal>
 #include <cmath>
 
 /**
  * @class GenTime
  * @brief Encapsulates a time, which can be set in various forms and outputted in various forms.
+ * The time is stored as an integer number of ticks of 1/705600000 second (also known as flicks). Frame durations of
+ * all the usual frame rates, including the NTSC ones like 30000/1001, are an exact number of ticks, so times built
+ * from frames are exact and the comparisons are a total order, which allows to use GenTime as a map key.
  * @author Jason Wood
  */
 class GenTime
 {
 public:
+    /** @brief Number of ticks in one second */
+    static constexpr qint64 TicksPerSecond = 705600000;
+
     /** @brief Creates a GenTime object, with a time of 0 seconds. */
-    GenTime();
+    constexpr GenTime()
+        : m_ticks(0)
+    {
+    }
 
     /** @brief Creates a GenTime object, with time given in seconds. */
     explicit GenTime(double seconds);
@@ -26,13 +36,19 @@ public:
     /** @brief Creates a GenTime object, by passing number of frames and how many frames per second. */
     GenTime(int frames, double framesPerSecond);
 
+    /** @brief Creates a GenTime object from a number of ticks. */
+    static constexpr GenTime fromTicks(qint64 ticks) { return GenTime(ticks, TicksTag()); }
+
+    /** @brief Gets the time, in ticks. */
+    constexpr qint64 ticks() const { return m_ticks; }
+
     /** @brief Gets the time, in seconds. */
     double seconds() const;
 
     /** @brief Gets the time, in milliseconds */
     double ms() const;
 
-    /** @brief Gets the time in frames.
+    /** @brief Gets the time in frames, rounded to the nearest frame.
      * @param framesPerSecond Number of frames per second */
     int frames(double framesPerSecond) const;
 
@@ -43,51 +59,61 @@ public:
      */
 
     /// Unary minus
-    GenTime operator-();
+    constexpr GenTime operator-() const { return fromTicks(-m_ticks); }
 
     /// Addition
-    GenTime &operator+=(GenTime op);
+    GenTime &operator+=(GenTime op)
+    {
+        m_ticks += op.m_ticks;
+        return *this;
+    }
 
     /// Subtraction
-    GenTime &operator-=(GenTime op);
+    GenTime &operator-=(GenTime op)
+    {
+        m_ticks -= op.m_ticks;
+        return *this;
+    }
 
     /** @brief Adds two GenTimes. */
-    GenTime operator+(GenTime op) const;
+    constexpr GenTime operator+(GenTime op) const { return fromTicks(m_ticks + op.m_ticks); }
 
     /** @brief Subtracts one genTime from another. */
-    GenTime operator-(GenTime op) const;
+    constexpr GenTime operator-(GenTime op) const { return fromTicks(m_ticks - op.m_ticks); }
 
-    /** @brief Multiplies one GenTime by a double value, returning a GenTime. */
+    /** @brief Multiplies one GenTime by a double value, returning a GenTime rounded to the nearest tick. */
     GenTime operator*(double op) const;
 
-    /** @brief Divides one GenTime by a double value, returning a GenTime. */
+    /** @brief Divides one GenTime by a double value, returning a GenTime rounded to the nearest tick. */
     GenTime operator/(double op) const;
 
-    /** All the comparison operators considers that two GenTime that differs by less
-    than one frame are equal.
-    The fps used to carry this computation must be set using the static function setFps
-    */
-    bool operator<(GenTime op) const;
+    /** The comparison operators are exact, use frames() to compare times at a frame accuracy */
+    constexpr bool operator<(GenTime op) const { return m_ticks < op.m_ticks; }
 
-    bool operator>(GenTime op) const;
+    constexpr bool operator>(GenTime op) const { return m_ticks > op.m_ticks; }
 
-    bool operator>=(GenTime op) const;
+    constexpr bool operator>=(GenTime op) const { return m_ticks >= op.m_ticks; }
 
-    bool operator<=(GenTime op) const;
+    constexpr bool operator<=(GenTime op) const { return m_ticks <= op.m_ticks; }
 
-    bool operator==(GenTime op) const;
+    constexpr bool operator==(GenTime op) const { return m_ticks == op.m_ticks; }
 
-    bool operator!=(GenTime op) const;
+    constexpr bool operator!=(GenTime op) const { return m_ticks != op.m_ticks; }
 
-    /** @brief Sets the fps used to determine if two GenTimes are equal */
-    static void setFps(double fps);
+    /** @brief The number of ticks of one frame at @param framesPerSecond */
+    static qint64 ticksPerFrame(double framesPerSecond);
 
 private:
-    /** Holds the time in seconds for this object. */
-    double m_time;
-
-    /** A delta value that is used to get around floating point rounding issues. */
-    static double s_delta;
+    struct TicksTag
+    {
+    };
+    constexpr GenTime(qint64 ticks, TicksTag)
+        : m_ticks(ticks)
+    {
+    }
+
+    /** Holds the time in ticks for this object. */
+    qint64 m_ticks;
 };
 
-Q_DECLARE_TYPEINFO(GenTime, Q_COMPLEX_TYPE); //TODO Q_COMPLEX_TYPE is the default, but does Q_MOVABLE_TYPE fit better?
+Q_DECLARE_TYPEINFO(GenTime, Q_MOVABLE_TYPE);
@@ -0,0 +1,227 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+
+/** @class RankedMap
+    @brief An ordered map that also gives the rank of its keys in logarithmic time.
+    List models that use the key order as row order can map an id to its row with rank() and a row to its item
+    with nth(), where walking a std::map with std::distance or std::advance is linear. The items are stored in a
+    std::map and the ranks in a treap of the keys whose nodes know the size of their subtree.
+    The interface follows std::map for the operations used by the models.
+ */
+template <typename Key, typename T> class RankedMap
+{
+public:
+    using container = std::map<Key, T>;
+    using iterator = typename container::iterator;
+    using const_iterator = typename container::const_iterator;
+
+    iterator begin() { return m_items.begin(); }
+    iterator end() { return m_items.end(); }
+    const_iterator begin() const { return m_items.begin(); }
+    const_iterator end() const { return m_items.end(); }
+    const_iterator cbegin() const { return m_items.cbegin(); }
+    const_iterator cend() const { return m_items.cend(); }
+    size_t size() const { return m_items.size(); }
+    bool empty() const { return m_items.empty(); }
+    size_t count(const Key &key) const { return m_items.count(key); }
+    iterator find(const Key &key) { return m_items.find(key); }
+    const_iterator find(const Key &key) const { return m_items.find(key); }
+    T &at(const Key &key) { return m_items.at(key); }
+    const T &at(const Key &key) const { return m_items.at(key); }
+    /** @brief Access the item of @param key, inserting a default constructed one if needed */
+    T &operator[](const Key &key);
+    size_t erase(const Key &key);
+    void clear();
+
+    /** @brief The number of keys smaller than @param key, or -1 if it is not in the map */
+    int rank(const Key &key) const;
+    /** @brief The item at position @param row in key order, or end() if out of range */
+    iterator nth(int row);
+    const_iterator nth(int row) const;
+
+private:
+    struct Node
+    {
+        Key key;
+        uint32_t priority;
+        int size{1};
+        std::unique_ptr<Node> left;
+        std::unique_ptr<Node> right;
+    };
+    container m_items;
+    std::unique_ptr<Node> m_root;
+    uint32_t m_seed{2463534242u};
+
+    uint32_t nextPriority();
+    static int subtreeSize(const std::unique_ptr<Node> &node) { return node ? node->size : 0; }
+    static void updateSize(Node *node) { node->size = 1 + subtreeSize(node->left) + subtreeSize(node->right); }
+    /** @brief Split @param node in the keys smaller than @param key and the others */
+    static void split(std::unique_ptr<Node> node, const Key &key, std::unique_ptr<Node> &smaller, std::unique_ptr<Node> &others);
+    static std::unique_ptr<Node> merge(std::unique_ptr<Node> smaller, std::unique_ptr<Node> larger);
+    void insertKey(std::unique_ptr<Node> &node, std::unique_ptr<Node> &newNode);
+    static void eraseKey(std::unique_ptr<Node> &node, const Key &key);
+    const Key *keyAt(int row) const;
+};
+
+template <typename Key, typename T> uint32_t RankedMap<Key, T>::nextPriority()
+{
+    // xorshift32, priorities only need to be well spread
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+    return m_seed;
+}
+
+template <typename Key, typename T>
+void RankedMap<Key, T>::split(std::unique_ptr<Node> node, const Key &key, std::unique_ptr<Node> &smaller, std::unique_ptr<Node> &others)
+{
+    if (!node) {
+        smaller.reset();
+        others.reset();
+        return;
+    }
+    if (node->key < key) {
+        std::unique_ptr<Node> right = std::move(node->right);
+        split(std::move(right), key, node->right, others);
+        updateSize(node.get());
+        smaller = std::move(node);
+    } else {
+        std::unique_ptr<Node> left = std::move(node->left);
+        split(std::move(left), key, smaller, node->left);
+        updateSize(node.get());
+        others = std::move(node);
+    }
+}
+
+template <typename Key, typename T>
+std::unique_ptr<typename RankedMap<Key, T>::Node> RankedMap<Key, T>::merge(std::unique_ptr<Node> smaller, std::unique_ptr<Node> larger)
+{
+    if (!smaller) {
+        return larger;
+    }
+    if (!larger) {
+        return smaller;
+    }
+    if (smaller->priority > larger->priority) {
+        smaller->right = merge(std::move(smaller->right), std::move(larger));
+        updateSize(smaller.get());
+        return smaller;
+    }
+    larger->left = merge(std::move(smaller), std::move(larger->left));
+    updateSize(larger.get());
+    return larger;
+}
+
+template <typename Key, typename T> void RankedMap<Key, T>::insertKey(std::unique_ptr<Node> &node, std::unique_ptr<Node> &newNode)
+{
+    if (!node) {
+        node = std::move(newNode);
+        return;
+    }
+    if (newNode->priority > node->priority) {
+        split(std::move(node), newNode->key, newNode->left, newNode->right);
+        updateSize(newNode.get());
+        node = std::move(newNode);
+        return;
+    }
+    insertKey(newNode->key < node->key ? node->left : node->right, newNode);
+    updateSize(node.get());
+}
+
+template <typename Key, typename T> void RankedMap<Key, T>::eraseKey(std::unique_ptr<Node> &node, const Key &key)
+{
+    if (!node) {
+        return;
+    }
+    if (key < node->key) {
+        eraseKey(node->left, key);
+    } else if (node->key < key) {
+        eraseKey(node->right, key);
+    } else {
+        node = merge(std::move(node->left), std::move(node->right));
+        return;
+    }
+    updateSize(node.get());
+}
+
+template <typename Key, typename T> T &RankedMap<Key, T>::operator[](const Key &key)
+{
+    auto result = m_items.emplace(key, T());
+    if (result.second) {
+        std::unique_ptr<Node> node(new Node{key, nextPriority(), 1, nullptr, nullptr});
+        insertKey(m_root, node);
+    }
+    return result.first->second;
+}
+
+template <typename Key, typename T> size_t RankedMap<Key, T>::erase(const Key &key)
+{
+    if (m_items.erase(key) == 0) {
+        return 0;
+    }
+    eraseKey(m_root, key);
+    return 1;
+}
+
+template <typename Key, typename T> void RankedMap<Key, T>::clear()
+{
+    m_items.clear();
+    m_root.reset();
+}
+
+template <typename Key, typename T> int RankedMap<Key, T>::rank(const Key &key) const
+{
+    int rank = 0;
+    const Node *node = m_root.get();
+    while (node != nullptr) {
+        if (key < node->key) {
+            node = node->left.get();
+        } else if (node->key < key) {
+            rank += subtreeSize(node->left) + 1;
+            node = node->right.get();
+        } else {
+            return rank + subtreeSize(node->left);
+        }
+    }
+    return -1;
+}
+
+template <typename Key, typename T> const Key *RankedMap<Key, T>::keyAt(int row) const
+{
+    if (row < 0 || row >= subtreeSize(m_root)) {
+        return nullptr;
+    }
+    const Node *node = m_root.get();
+    while (node != nullptr) {
+        const int leftSize = subtreeSize(node->left);
+        if (row < leftSize) {
+            node = node->left.get();
+        } else if (row == leftSize) {
+            return &node->key;
+        } else {
+            row -= leftSize + 1;
+            node = node->right.get();
+        }
+    }
+    return nullptr;
+}
+
+template <typename Key, typename T> typename RankedMap<Key, T>::iterator RankedMap<Key, T>::nth(int row)
+{
+    const Key *key = keyAt(row);
+    return key ? m_items.find(*key) : m_items.end();
+}
+
+template <typename Key, typename T> typename RankedMap<Key, T>::const_iterator RankedMap<Key, T>::nth(int row) const
+{
+    const Key *key = keyAt(row);
+    return key ? m_items.find(*key) : m_items.end();
+}
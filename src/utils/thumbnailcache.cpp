@@ -9,6 +9,7 @@
 #include "core.h"
 #include "doc/kdenlivedoc.h"
 #include "project/projectmanager.h"
+#include "utils/cachebudget.h"
 #include <QDir>
 #include <QMutexLocker>
 #include <list>
@@ -144,6 +145,7 @@ QImage ThumbnailCache::getAudioThumbnail(const QString &binId, bool volatileOnly
             m_storedOnDisk[binId].push_back(-1);
         }
         locker.unlock();
+        CacheBudget::touch(thumbFolder.absoluteFilePath(key));
         return QImage(thumbFolder.absoluteFilePath(key));
     }
     return QImage();
@@ -186,6 +188,7 @@ QImage ThumbnailCache::getThumbnail(QString hash, const QString &binId, int pos,
             m_storedOnDisk[binId].push_back(pos);
         }
         locker.unlock();
+        CacheBudget::touch(thumbFolder.absoluteFilePath(hash));
         return QImage(thumbFolder.absoluteFilePath(hash));
     }
     locker.unlock();
@@ -210,6 +213,7 @@ QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatile
             m_storedOnDisk[binId].push_back(pos);
         }
         locker.unlock();
+        CacheBudget::touch(thumbFolder.absoluteFilePath(key));
         return QImage(thumbFolder.absoluteFilePath(key));
     }
     return QImage();
@@ -0,0 +1,163 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <memory>
+#include <vector>
+
+// Events recorded per thread, older ones are kept and newer ones dropped past this limit
+#define MAX_THREAD_EVENTS 1000000
+
+std::atomic<bool> Trace::recording(false);
+
+namespace {
+struct Event
+{
+    const char *category;
+    const char *name;
+    qint64 start;
+    qint64 duration;
+};
+
+/** @brief Events of one thread. The mutex is only contended while the trace is written */
+struct ThreadBuffer
+{
+    QMutex mutex;
+    std::vector<Event> events;
+    quint64 threadId = 0;
+    QString threadName;
+    qint64 dropped = 0;
+};
+
+QMutex traceMutex;
+QString tracePath;
+QElapsedTimer traceClock;
+bool postRoutineAdded = false;
+// Buffers of all threads that recorded events, kept when their thread exits
+std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+
+ThreadBuffer *currentBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->threadId = quint64(quintptr(QThread::currentThreadId()));
+        QThread *thread = QThread::currentThread();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread()) {
+            buffer->threadName = QStringLiteral("Main");
+        } else if (thread && !thread->objectName().isEmpty()) {
+            buffer->threadName = thread->objectName();
+        } else {
+            buffer->threadName = QStringLiteral("Thread %1").arg(buffer->threadId);
+        }
+        QMutexLocker lock(&traceMutex);
+        threadBuffers.push_back(buffer);
+    }
+    return buffer.get();
+}
+
+QByteArray escaped(const QString &text)
+{
+    QByteArray result = text.toUtf8();
+    result.replace('\\', "\\\\");
+    result.replace('"', "\\\"");
+    return result;
+}
+
+void writeOnExit()
+{
+    Trace::stop();
+}
+} // namespace
+
+void Trace::start(const QString &path)
+{
+#ifdef KDENLIVE_TRACING
+    QMutexLocker lock(&traceMutex);
+    tracePath = path;
+    traceClock.start();
+    if (!postRoutineAdded) {
+        qAddPostRoutine(writeOnExit);
+        postRoutineAdded = true;
+    }
+    recording = true;
+#else
+    qWarning() << "Kdenlive was built without trace support, not recording" << path;
+#endif
+}
+
+qint64 Trace::now()
+{
+    return traceClock.nsecsElapsed() / 1000;
+}
+
+void Trace::addEvent(const char *category, const char *name, qint64 start, qint64 duration)
+{
+    if (!isRecording()) {
+        // Scope ended after the trace was written
+        return;
+    }
+    ThreadBuffer *buffer = currentBuffer();
+    QMutexLocker lock(&buffer->mutex);
+    if (buffer->events.size() < MAX_THREAD_EVENTS) {
+        buffer->events.push_back({category, name, start, duration});
+    } else {
+        buffer->dropped++;
+    }
+}
+
+bool Trace::stop()
+{
+    if (!recording.exchange(false)) {
+        return true;
+    }
+    QMutexLocker lock(&traceMutex);
+    QSaveFile file(tracePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write trace file" << tracePath;
+        return false;
+    }
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto &buffer : threadBuffers) {
+        QMutexLocker bufferLock(&buffer->mutex);
+        const QByteArray tid = QByteArray::number(buffer->threadId);
+        QByteArray data;
+        data.reserve(int(buffer->events.size()) * 96 + 128);
+        data.append(first ? "" : ",\n");
+        first = false;
+        data.append("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" + tid + ",\"args\":{\"name\":\"" + escaped(buffer->threadName) +
+                    "\"}}");
+        for (const Event &event : buffer->events) {
+            data.append(",\n{\"ph\":\"X\",\"cat\":\"");
+            data.append(event.category);
+            data.append("\",\"name\":\"");
+            data.append(event.name);
+            data.append("\",\"ts\":" + QByteArray::number(event.start) + ",\"dur\":" + QByteArray::number(event.duration) + ",\"pid\":" + pid +
+                        ",\"tid\":" + tid + '}');
+        }
+        if (buffer->dropped > 0) {
+            qWarning() << "Trace buffer full," << buffer->dropped << "events dropped for thread" << buffer->threadName;
+        }
+        buffer->events.clear();
+        buffer->dropped = 0;
+        file.write(data);
+    }
+    file.write("\n]}\n");
+    if (!file.commit()) {
+        qWarning() << "Cannot write trace file" << tracePath;
+        return false;
+    }
+    qDebug() << "Trace written to" << tracePath;
+    return true;
+}
@@ -0,0 +1,84 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "config-kdenlive.h"
+
+#include <QString>
+#include <atomic>
+
+/** @namespace Trace
+    @brief Timing of hot paths, exported as a Chrome trace event file that can be opened in chrome://tracing or Perfetto.
+    Code is instrumented with the KDENLIVE_TRACE macro, which records the duration of the enclosing scope:
+    @code
+    void TimelineModel::requestClipMove(...)
+    {
+        KDENLIVE_TRACE("timeline", "requestClipMove");
+        ...
+    }
+    @endcode
+    Category and name must be string literals. Recording is started with the --trace command line option, when it is
+    not running an instrumented scope only costs an atomic read. Building without KDENLIVE_TRACING removes the
+    instrumentation completely.
+ */
+namespace Trace {
+/** @brief Start recording, the trace is written to @param path when the application exits or when stop() is called */
+void start(const QString &path);
+/** @brief Stop recording and write the trace file, returns false if it could not be written */
+bool stop();
+/** @brief Microseconds elapsed since recording started */
+qint64 now();
+/** @brief Record an event that started at @param start and lasted @param duration microseconds */
+void addEvent(const char *category, const char *name, qint64 start, qint64 duration);
+
+extern std::atomic<bool> recording;
+
+inline bool isRecording()
+{
+#ifdef KDENLIVE_TRACING
+    return recording.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+} // namespace Trace
+
+/** @class TraceScope
+    @brief Records a trace event covering its lifetime, use it through the KDENLIVE_TRACE macro
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const char *name)
+        : m_category(category)
+        , m_name(name)
+        , m_start(Trace::isRecording() ? Trace::now() : -1)
+    {
+    }
+    ~TraceScope()
+    {
+        if (m_start >= 0) {
+            Trace::addEvent(m_category, m_name, m_start, Trace::now() - m_start);
+        }
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_start;
+};
+
+#ifdef KDENLIVE_TRACING
+#define KDENLIVE_TRACE_CONCAT_(a, b) a##b
+#define KDENLIVE_TRACE_CONCAT(a, b) KDENLIVE_TRACE_CONCAT_(a, b)
+#define KDENLIVE_TRACE(category, name) TraceScope KDENLIVE_TRACE_CONCAT(traceScope_, __LINE__)(category, name)
+#else
+#define KDENLIVE_TRACE(category, name)                                                                                                                         \
+    do {                                                                                                                                                       \
+    } while (false)
+#endif
@@ -0,0 +1,105 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "bin/binsearchindex.h"
+#include "bin/model/markerlistmodel.hpp"
+#include "bin/projectfolder.h"
+#include "core.h"
+#include "doc/docundostack.hpp"
+#include "doc/kdenlivedoc.h"
+
+TEST_CASE("Bin search index", "[BinSearch]")
+{
+    auto binModel = pCore->projectItemModel();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    QString folderId;
+    REQUIRE(binModel->requestAddFolder(folderId, QStringLiteral("Interviews"), binModel->getRootFolder()->clipId(), undo, redo));
+    auto folder = binModel->getFolderByBinId(folderId);
+    auto clip = binModel->getClipByBinID(KdenliveTests::createProducer(pCore->getProjectProfile(), "red", binModel));
+    auto clip2 = binModel->getClipByBinID(KdenliveTests::createProducer(pCore->getProjectProfile(), "blue", binModel));
+    clip->setDescription(QStringLiteral("Harbour at dawn"));
+    binModel->updateSearchIndex(clip.get());
+
+    const BinSearchIndex &index = binModel->searchIndex();
+    REQUIRE(index.contains(folder->getId()));
+    REQUIRE(index.contains(clip->getId()));
+    REQUIRE(index.contains(clip2->getId()));
+    BinSearchIndex::Query query;
+
+    SECTION("Text search is case insensitive")
+    {
+        query.text = QStringLiteral("HARBOUR");
+        REQUIRE(index.matches(query) == QSet<int>({clip->getId()}));
+        // Too short to use the trigrams
+        query.text = QStringLiteral("Ha");
+        REQUIRE(index.matches(query).contains(clip->getId()));
+        query.text = QStringLiteral("harbour at dusk");
+        REQUIRE(index.matches(query).isEmpty());
+        query.text = QStringLiteral("interview");
+        REQUIRE(index.matches(query) == QSet<int>({folder->getId()}));
+    }
+
+    SECTION("Marker comments are searchable")
+    {
+        REQUIRE(clip2->getMarkerModel()->addMarker(GenTime(0.5), QStringLiteral("Goal scored")));
+        query.text = QStringLiteral("goal sc");
+        REQUIRE(index.matches(query) == QSet<int>({clip2->getId()}));
+        REQUIRE(index.matches(clip2->getId(), query));
+    }
+
+    SECTION("Rating, type and usage filters")
+    {
+        clip2->AbstractProjectItem::setRating(4);
+        binModel->updateSearchIndex(clip2.get());
+        query.ratings = {4};
+        REQUIRE(index.matches(query) == QSet<int>({clip2->getId()}));
+        // As in the bin, the search text does not restrict the other filters
+        query.text = QStringLiteral("harbour");
+        REQUIRE(index.matches(query) == QSet<int>({clip2->getId()}));
+        query = BinSearchIndex::Query();
+        query.types = {int(clip->clipType())};
+        REQUIRE(index.matches(query).contains(clip->getId()));
+        REQUIRE(index.matches(query).contains(clip2->getId()));
+        REQUIRE_FALSE(index.matches(query).contains(folder->getId()));
+        query = BinSearchIndex::Query();
+        query.usage = BinSearchIndex::UsageFilter::Used;
+        REQUIRE(index.matches(query).isEmpty());
+        query.usage = BinSearchIndex::UsageFilter::Unused;
+        REQUIRE(index.matches(query).contains(clip->getId()));
+    }
+
+    SECTION("Matching items are displayed with their folders")
+    {
+        REQUIRE(clip->changeParent(folder));
+        query.text = QStringLiteral("dawn");
+        const QSet<int> matches = index.matches(query);
+        REQUIRE(matches == QSet<int>({clip->getId()}));
+        const QSet<int> displayed = index.withAncestors(matches);
+        REQUIRE(displayed.contains(clip->getId()));
+        REQUIRE(displayed.contains(folder->getId()));
+        REQUIRE_FALSE(displayed.contains(clip2->getId()));
+    }
+
+    SECTION("Removed items leave the index")
+    {
+        const int clipId = clip->getId();
+        REQUIRE(binModel->requestBinClipDeletion(clip, undo, redo));
+        REQUIRE_FALSE(index.contains(clipId));
+        query.text = QStringLiteral("harbour");
+        REQUIRE(index.matches(query).isEmpty());
+    }
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
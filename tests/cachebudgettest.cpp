@@ -0,0 +1,81 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "utils/cachebudget.h"
+#include <QTemporaryDir>
+
+namespace {
+void createFile(const QDir &dir, const QString &name, int size, int ageInSeconds)
+{
+    dir.mkpath(QStringLiteral("."));
+    QFile file(dir.absoluteFilePath(name));
+    file.open(QIODevice::WriteOnly);
+    file.write(QByteArray(size, 'x'));
+    file.setFileTime(QDateTime::currentDateTime().addSecs(-ageInSeconds), QFileDevice::FileModificationTime);
+    file.close();
+}
+} // namespace
+
+TEST_CASE("Cache disk budget", "[CacheBudget]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    const QDir root(tmp.path());
+    const QDir shared(root.absoluteFilePath(QStringLiteral("previewchunks")));
+    const QDir preview(root.absoluteFilePath(QStringLiteral("1700000000000/preview")));
+    const QDir thumbs(root.absoluteFilePath(QStringLiteral("1700000000000/videothumbs")));
+    createFile(shared, QStringLiteral("old.mp4"), 1000, 3000);
+    createFile(shared, QStringLiteral("recent.mp4"), 1000, 10);
+    createFile(thumbs, QStringLiteral("thumb.jpg"), 500, 2000);
+    createFile(preview, QStringLiteral("render.mlt"), 200, 5000);
+    CacheBudget::writeChunkIndex(preview, {shared.absoluteFilePath(QStringLiteral("recent.mp4"))});
+    // Not a project folder
+    createFile(QDir(root.absoluteFilePath(QStringLiteral("proxy"))), QStringLiteral("proxy.mkv"), 4000, 8000);
+
+    SECTION("Usage is reported per project")
+    {
+        const CacheBudget::Report report = CacheBudget::usage(root);
+        REQUIRE(report.sharedPreviews == 2000);
+        REQUIRE(report.total == 2500);
+        REQUIRE(report.projects.size() == 1);
+        REQUIRE(report.projects.constFirst().documentId == QStringLiteral("1700000000000"));
+        REQUIRE(report.projects.constFirst().thumbnails == 500);
+        REQUIRE(report.projects.constFirst().previews == 0);
+        REQUIRE(report.projects.constFirst().sharedPreviews == 1000);
+        REQUIRE(CacheBudget::readChunkIndex(root.absoluteFilePath(QStringLiteral("1700000000000"))) == QStringList({QStringLiteral("recent.mp4")}));
+    }
+
+    SECTION("Least recently used files are removed first")
+    {
+        REQUIRE(CacheBudget::evict(root, 3000) == 0);
+        REQUIRE(CacheBudget::evict(root, 1500) == 1000);
+        REQUIRE_FALSE(shared.exists(QStringLiteral("old.mp4")));
+        REQUIRE(thumbs.exists(QStringLiteral("thumb.jpg")));
+        REQUIRE(shared.exists(QStringLiteral("recent.mp4")));
+        // Scene lists and files outside of the budget are kept
+        REQUIRE(preview.exists(QStringLiteral("render.mlt")));
+        REQUIRE(root.exists(QStringLiteral("proxy/proxy.mkv")));
+    }
+
+    SECTION("Touching only updates files older than a day")
+    {
+        createFile(thumbs, QStringLiteral("stale.jpg"), 100, 3 * 86400);
+        const QDateTime recent = QFileInfo(shared.absoluteFilePath(QStringLiteral("recent.mp4"))).lastModified();
+        CacheBudget::touch(shared.absoluteFilePath(QStringLiteral("recent.mp4")));
+        CacheBudget::touch(thumbs.absoluteFilePath(QStringLiteral("stale.jpg")));
+        REQUIRE(QFileInfo(shared.absoluteFilePath(QStringLiteral("recent.mp4"))).lastModified() == recent);
+        REQUIRE(QFileInfo(thumbs.absoluteFilePath(QStringLiteral("stale.jpg"))).lastModified().secsTo(QDateTime::currentDateTime()) < 60);
+    }
+
+    SECTION("Used files are never removed")
+    {
+        REQUIRE(CacheBudget::evict(root, 0, {shared.absoluteFilePath(QStringLiteral("old.mp4"))}) == 1500);
+        REQUIRE(shared.exists(QStringLiteral("old.mp4")));
+        REQUIRE_FALSE(shared.exists(QStringLiteral("recent.mp4")));
+        REQUIRE_FALSE(thumbs.exists(QStringLiteral("thumb.jpg")));
+    }
+}
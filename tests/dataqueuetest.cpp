@@ -0,0 +1,161 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "monitor/scopes/dataqueue.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace {
+struct TimedItem
+{
+    int index{-1};
+    std::chrono::steady_clock::time_point pushed;
+};
+} // namespace
+
+TEST_CASE("DataQueue overflow policies", "[DataQueue]")
+{
+    SECTION("Discard oldest keeps the most recent items")
+    {
+        DataQueue<int> queue(3, DataQueue<int>::OverflowModeDiscardOldest);
+        for (int i = 0; i < 5; i++) {
+            queue.push(i);
+        }
+        REQUIRE(queue.count() == 3);
+        REQUIRE(queue.pop() == 2);
+        REQUIRE(queue.pop() == 3);
+        REQUIRE(queue.pop() == 4);
+        int value;
+        REQUIRE_FALSE(queue.tryPop(value));
+    }
+
+    SECTION("Discard newest keeps the first items")
+    {
+        DataQueue<int> queue(3, DataQueue<int>::OverflowModeDiscardNewest);
+        for (int i = 0; i < 5; i++) {
+            queue.push(i);
+        }
+        REQUIRE(queue.count() == 3);
+        REQUIRE(queue.pop() == 0);
+        REQUIRE(queue.pop() == 1);
+        REQUIRE(queue.pop() == 2);
+        REQUIRE(queue.count() == 0);
+    }
+
+    SECTION("Wait blocks the producer until an item is popped")
+    {
+        DataQueue<int> queue(2, DataQueue<int>::OverflowModeWait);
+        queue.push(0);
+        queue.push(1);
+        std::atomic<bool> pushed(false);
+        std::thread producer([&queue, &pushed]() {
+            queue.push(2);
+            pushed = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE_FALSE(pushed);
+        REQUIRE(queue.pop() == 0);
+        producer.join();
+        REQUIRE(pushed);
+        REQUIRE(queue.pop() == 1);
+        REQUIRE(queue.pop() == 2);
+    }
+}
+
+TEST_CASE("DataQueue single producer, multiple consumers", "[DataQueue]")
+{
+    const int itemCount = 20000;
+    const int consumerCount = 3;
+    DataQueue<int> queue(8, DataQueue<int>::OverflowModeWait);
+    std::vector<std::vector<int>> received(consumerCount);
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < consumerCount; c++) {
+        consumers.emplace_back([&, c]() {
+            for (;;) {
+                int item = queue.pop();
+                if (item < 0) {
+                    // End marker
+                    break;
+                }
+                received[size_t(c)].push_back(item);
+            }
+        });
+    }
+    for (int i = 0; i < itemCount; i++) {
+        queue.push(i);
+    }
+    for (int c = 0; c < consumerCount; c++) {
+        queue.push(-1);
+    }
+    for (auto &consumer : consumers) {
+        consumer.join();
+    }
+
+    // Every item is received exactly once, in push order for each consumer
+    std::vector<int> all;
+    for (int c = 0; c < consumerCount; c++) {
+        REQUIRE(std::is_sorted(received[size_t(c)].begin(), received[size_t(c)].end()));
+        all.insert(all.end(), received[size_t(c)].begin(), received[size_t(c)].end());
+    }
+    std::sort(all.begin(), all.end());
+    std::vector<int> expected(size_t(itemCount));
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(all == expected);
+    REQUIRE(queue.count() == 0);
+}
+
+TEST_CASE("DataQueue throughput and latency benchmark", "[.][benchmark][DataQueue]")
+{
+    const int itemCount = 200000;
+    const int consumerCount = 3;
+    DataQueue<TimedItem> queue(8, DataQueue<TimedItem>::OverflowModeWait);
+    std::vector<int> receivedCount(consumerCount, 0);
+    std::vector<double> maxLatency(consumerCount, 0.);
+    std::vector<double> totalLatency(consumerCount, 0.);
+
+    QElapsedTimer timer;
+    timer.start();
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < consumerCount; c++) {
+        consumers.emplace_back([&, c]() {
+            for (;;) {
+                TimedItem item = queue.pop();
+                if (item.index < 0) {
+                    // End marker
+                    break;
+                }
+                double latency = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - item.pushed).count();
+                maxLatency[size_t(c)] = std::max(maxLatency[size_t(c)], latency);
+                totalLatency[size_t(c)] += latency;
+                receivedCount[size_t(c)]++;
+            }
+        });
+    }
+    for (int i = 0; i < itemCount; i++) {
+        queue.push({i, std::chrono::steady_clock::now()});
+    }
+    for (int c = 0; c < consumerCount; c++) {
+        queue.push({-1, std::chrono::steady_clock::now()});
+    }
+    for (auto &consumer : consumers) {
+        consumer.join();
+    }
+    const qint64 elapsed = qMax(qint64(1), timer.elapsed());
+
+    const double latencySum = std::accumulate(totalLatency.begin(), totalLatency.end(), 0.);
+    const double latencyMax = *std::max_element(maxLatency.begin(), maxLatency.end());
+    qDebug() << "DataQueue throughput:" << itemCount * 1000 / elapsed << "items/s, mean latency:" << latencySum / itemCount
+             << "us, max latency:" << latencyMax << "us";
+    REQUIRE(std::accumulate(receivedCount.begin(), receivedCount.end(), 0) == itemCount);
+}
@@ -87,6 +87,25 @@ TEST_CASE("Effects groups", "[Effects]")
         undoStack->undo();
         state(0);
     }
+    SECTION("Add an effect to grouped clips in one undo entry")
+    {
+        int undoIndex = undoStack->index();
+        REQUIRE(timeline->addClipEffect(cid2, anEffect).count() == 3);
+        state(1);
+        REQUIRE(undoStack->index() == undoIndex + 1);
+        // The effects share their description but not their parameters
+        auto clipModel1 = timeline->getClipEffectStackModel(cid1);
+        auto clipModel3 = timeline->getClipEffectStackModel(cid3);
+        REQUIRE(clipModel1->getAssetModelById(anEffect) != clipModel3->getAssetModelById(anEffect));
+        auto *command = new AssetCommand(clipModel1->getAssetModelById(anEffect),
+                                         clipModel1->getAssetModelById(anEffect)->getParamIndexFromName(QStringLiteral("u")), QStringLiteral("90"));
+        pCore->pushUndo(command);
+        effectState(cid1, QStringLiteral("u"), QStringLiteral("90"));
+        effectState(cid3, QStringLiteral("u"), QStringLiteral("75"));
+        undoStack->undo();
+        undoStack->undo();
+        state(0);
+    }
     SECTION("Add an effect to grouped clips, edit param")
     {
         timeline->addClipEffect(cid1, anEffect);
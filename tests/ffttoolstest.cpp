@@ -0,0 +1,188 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "lib/audio/fftTools.h"
+
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+audioShortVector makeSignal(int samples, int channels)
+{
+    audioShortVector signal(samples * channels);
+    for (int i = 0; i < samples; ++i) {
+        // Two sines, plus a different signal on the other channels
+        const double value = 0.5 * sin(2 * M_PI * 440. * i / 48000.) + 0.25 * sin(2 * M_PI * 5000. * i / 48000.);
+        for (int c = 0; c < channels; ++c) {
+            signal[i * channels + c] = qint16(32767. * value / (c + 1));
+        }
+    }
+    return signal;
+}
+
+/** The FFT as computed before plans were introduced: one configuration allocated per call,
+    string keyed window cache and per call buffers. Kept as reference and for the benchmark. */
+void legacyFftNormalized(QHash<QString, QVector<float>> &windows, const audioShortVector &audioFrame, uint channel, uint numChannels, float *freqSpectrum,
+                         FFTTools::WindowType windowType, uint windowSize)
+{
+    const uint numSamples = uint(audioFrame.size()) / numChannels;
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(int(windowSize), 0, nullptr, nullptr);
+    const QString winSig = QStringLiteral("s%1_t%2_p%3").arg(windowSize).arg(windowType).arg(0., 0, 'f', 3);
+    if (!windows.contains(winSig)) {
+        windows.insert(winSig, FFTTools::window(windowType, int(windowSize), 0));
+    }
+    const QVector<float> window = windows.value(winSig);
+    auto *freqData = new kiss_fft_cpx[windowSize / 2 + 1];
+    auto *data = new float[windowSize];
+    std::fill(data, data + windowSize, 0.f);
+    for (uint i = 0; i < numSamples && i < windowSize; ++i) {
+        data[i] = float(audioFrame.data()[i * numChannels + channel]) / 32767.0f * window[int(i)];
+    }
+    kiss_fftr(cfg, data, freqData);
+    const float scale = 1.0f / window[int(windowSize)];
+    for (uint i = 0; i < windowSize / 2; ++i) {
+        freqSpectrum[i] = 20 * logf(powf(powf(fabs(freqData[i].r * scale), 2) + powf(fabs(freqData[i].i * scale), 2), .5) / (float(windowSize) / 2.0f)) / logf(10);
+    }
+    delete[] freqData;
+    delete[] data;
+    kiss_fftr_free(cfg);
+}
+} // namespace
+
+TEST_CASE("FFT plans", "[FFTTools]")
+{
+    SECTION("Plans are shared per size and direction")
+    {
+        FFTPlanPtr forward = FFTTools::plan(512);
+        REQUIRE(forward == FFTTools::plan(512));
+        REQUIRE(forward != FFTTools::plan(1024));
+        FFTPlanPtr inverse = FFTTools::plan(512, true);
+        REQUIRE(inverse != forward);
+        REQUIRE(inverse->isInverse());
+        REQUIRE(forward->size() == 512);
+    }
+
+    SECTION("Forward and inverse transforms round trip")
+    {
+        const int size = 256;
+        FFTBuffer<float> data(size);
+        for (int i = 0; i < size; ++i) {
+            data[size_t(i)] = float(sin(i * 0.1) + 0.3 * cos(i * 0.7));
+        }
+        FFTBuffer<kiss_fft_cpx> freq(size / 2 + 1);
+        FFTBuffer<float> result(size);
+        FFTTools::plan(size)->forward(data.data(), freq.data());
+        FFTTools::plan(size, true)->inverse(freq.data(), result.data());
+        for (int i = 0; i < size; ++i) {
+            REQUIRE(result[size_t(i)] / size == Approx(data[size_t(i)]).margin(1e-4));
+        }
+    }
+
+    SECTION("A plan can be used by several threads at once")
+    {
+        const int size = 1024;
+        FFTBuffer<float> data(size);
+        for (int i = 0; i < size; ++i) {
+            data[size_t(i)] = float(sin(i * 0.05));
+        }
+        FFTPlanPtr plan = FFTTools::plan(size);
+        FFTBuffer<kiss_fft_cpx> reference(size / 2 + 1);
+        plan->forward(data.data(), reference.data());
+        std::vector<int> mismatches(4, 0);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < mismatches.size(); ++t) {
+            threads.emplace_back([&, t]() {
+                FFTBuffer<kiss_fft_cpx> freq(size / 2 + 1);
+                for (int run = 0; run < 500; ++run) {
+                    plan->forward(data.data(), freq.data());
+                    for (size_t i = 0; i < freq.size(); ++i) {
+                        if (freq[i].r != reference[i].r || freq[i].i != reference[i].i) {
+                            mismatches[t]++;
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        for (int count : mismatches) {
+            REQUIRE(count == 0);
+        }
+    }
+}
+
+TEST_CASE("Normalized FFT", "[FFTTools]")
+{
+    const uint windowSize = 2048;
+    const audioShortVector signal = makeSignal(8192, 2);
+    FFTTools tools;
+    QHash<QString, QVector<float>> legacyWindows;
+
+    SECTION("Results match the previous implementation")
+    {
+        std::vector<float> spectrum(windowSize / 2);
+        std::vector<float> expected(windowSize / 2);
+        tools.fftNormalized(signal, 1, 2, spectrum.data(), FFTTools::Window_Hamming, windowSize);
+        legacyFftNormalized(legacyWindows, signal, 1, 2, expected.data(), FFTTools::Window_Hamming, windowSize);
+        for (size_t i = 0; i < spectrum.size(); ++i) {
+            REQUIRE(spectrum[i] == Approx(expected[i]).margin(1e-3));
+        }
+        // The 440 Hz peak is found in the right bin and is the highest one
+        const size_t peakBin = size_t(std::max_element(spectrum.begin(), spectrum.end()) - spectrum.begin());
+        REQUIRE(peakBin == size_t(qRound(440. * windowSize / 48000.)));
+    }
+
+    SECTION("Batched transforms match single transforms")
+    {
+        const uint hop = windowSize / 4;
+        const int count = 10;
+        std::vector<float> batch(count * windowSize / 2);
+        tools.fftNormalizedBatch(signal, 0, 2, batch.data(), FFTTools::Window_Triangle, windowSize, hop, count);
+        std::vector<float> single(windowSize / 2);
+        for (int w = 0; w < count; ++w) {
+            audioShortVector part = signal.mid(int(uint(w) * hop * 2));
+            tools.fftNormalized(part, 0, 2, single.data(), FFTTools::Window_Triangle, windowSize);
+            for (size_t i = 0; i < single.size(); ++i) {
+                REQUIRE(batch[size_t(w) * windowSize / 2 + i] == Approx(single[i]).margin(1e-4));
+            }
+        }
+    }
+}
+
+TEST_CASE("Normalized FFT benchmark", "[.][benchmark][FFTTools]")
+{
+    const uint windowSize = 2048;
+    const audioShortVector signal = makeSignal(8192, 2);
+    FFTTools tools;
+    QHash<QString, QVector<float>> legacyWindows;
+
+    const uint hop = windowSize / 8;
+    const int count = int((uint(signal.size() / 2) - windowSize) / hop) + 1;
+    const int runs = 20;
+    std::vector<float> spectra(size_t(count) * windowSize / 2);
+    QElapsedTimer timer;
+    timer.start();
+    for (int run = 0; run < runs; ++run) {
+        for (int w = 0; w < count; ++w) {
+            audioShortVector part = signal.mid(int(uint(w) * hop * 2), int(windowSize * 2));
+            legacyFftNormalized(legacyWindows, part, 0, 2, spectra.data() + size_t(w) * windowSize / 2, FFTTools::Window_Hamming, windowSize);
+        }
+    }
+    const qint64 legacy = qMax(qint64(1), timer.nsecsElapsed());
+    timer.restart();
+    for (int run = 0; run < runs; ++run) {
+        tools.fftNormalizedBatch(signal, 0, 2, spectra.data(), FFTTools::Window_Hamming, windowSize, hop, count);
+    }
+    const qint64 batched = qMax(qint64(1), timer.nsecsElapsed());
+    qDebug() << "FFT of" << count * runs << "windows of" << windowSize << "samples, previous:" << legacy / 1000 << "us, batched:" << batched / 1000
+             << "us, speedup:" << double(legacy) / batched;
+}
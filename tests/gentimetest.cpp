@@ -0,0 +1,134 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "utils/gentime.h"
+
+#include <QElapsedTimer>
+#include <cmath>
+#include <map>
+#include <random>
+
+namespace {
+/** GenTime as it was before ticks were introduced: seconds as a double and comparisons considering
+    that times closer than a frame are equal. Kept as reference for the benchmark. */
+class LegacyTime
+{
+public:
+    LegacyTime(int frames, double fps)
+        : m_time(double(frames) / fps)
+    {
+    }
+    bool operator<(const LegacyTime &op) const { return m_time + s_delta < op.m_time; }
+    int frames(double fps) const { return int(floor(m_time * fps + 0.5)); }
+    static double s_delta;
+
+private:
+    double m_time;
+};
+double LegacyTime::s_delta = 0.9 / 25.;
+
+/** Insert, look up, iterate and remove items as the keyframe and subtitle models do */
+template <typename Time> qint64 mapOperations(const std::vector<int> &positions, double fps)
+{
+    std::map<Time, std::pair<QString, Time>> items;
+    for (int frame : positions) {
+        items[Time(frame, fps)] = {QString(), Time(frame + 5, fps)};
+    }
+    qint64 checksum = 0;
+    for (int frame : positions) {
+        auto it = items.find(Time(frame, fps));
+        if (it != items.end()) {
+            checksum += it->second.second.frames(fps);
+        }
+        auto next = items.upper_bound(Time(frame, fps));
+        if (next != items.end()) {
+            checksum += next->first.frames(fps);
+        }
+    }
+    for (int frame : positions) {
+        items.erase(Time(frame, fps));
+    }
+    return checksum;
+}
+
+std::vector<int> randomPositions(size_t count)
+{
+    std::vector<int> positions(count);
+    std::mt19937 generator(7);
+    for (auto &position : positions) {
+        // Spread the items so that they do not overlap
+        position = int(generator() % 2000000) * 10;
+    }
+    return positions;
+}
+} // namespace
+
+TEST_CASE("GenTime is exact and totally ordered", "[GenTime]")
+{
+    SECTION("Frames are converted without rounding errors")
+    {
+        const std::vector<double> rates = {24000. / 1001., 24., 25., 30000. / 1001., 30., 50., 60000. / 1001., 60., 120.};
+        for (double fps : rates) {
+            for (int frame = -1000; frame < 500000; frame += 37) {
+                const GenTime time(frame, fps);
+                REQUIRE(time.frames(fps) == frame);
+                REQUIRE(GenTime(frame / fps) == time);
+                REQUIRE(GenTime(frame + 1, fps) - time == GenTime(1, fps));
+            }
+        }
+        REQUIRE(GenTime(1.3).frames(25.) == 33);
+        // Halves are rounded up
+        REQUIRE(GenTime(0.5 / 25.).frames(25.) == 1);
+        REQUIRE(GenTime(-0.5 / 25.).frames(25.) == 0);
+        REQUIRE(GenTime(-1.5 / 25.).frames(25.) == -1);
+    }
+
+    SECTION("Times closer than a frame are different")
+    {
+        const GenTime time(10, 25.);
+        const GenTime close = time + GenTime::fromTicks(1);
+        REQUIRE(time != close);
+        REQUIRE(time < close);
+        REQUIRE_FALSE(close < time);
+        REQUIRE(close.frames(25.) == 10);
+        std::map<GenTime, int> map;
+        map[time] = 1;
+        map[close] = 2;
+        REQUIRE(map.size() == 2);
+        REQUIRE(map.at(GenTime(10, 25.)) == 1);
+    }
+
+    SECTION("Arithmetic is usable at compile time")
+    {
+        constexpr GenTime second = GenTime::fromTicks(GenTime::TicksPerSecond);
+        constexpr GenTime twoSeconds = second + second;
+        static_assert(twoSeconds.ticks() == 2 * GenTime::TicksPerSecond, "constexpr addition");
+        static_assert(second < twoSeconds && -second < GenTime(), "constexpr comparison");
+        REQUIRE(twoSeconds.seconds() == 2.);
+    }
+
+    SECTION("Maps keep the behaviour of the previous implementation")
+    {
+        const std::vector<int> positions = randomPositions(2000);
+        REQUIRE(mapOperations<GenTime>(positions, 25.) == mapOperations<LegacyTime>(positions, 25.));
+    }
+}
+
+TEST_CASE("GenTime map operations benchmark", "[.][benchmark][GenTime]")
+{
+    const double fps = 25.;
+    const std::vector<int> positions = randomPositions(200000);
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 legacyChecksum = mapOperations<LegacyTime>(positions, fps);
+    const qint64 legacy = qMax(qint64(1), timer.nsecsElapsed());
+    timer.restart();
+    const qint64 checksum = mapOperations<GenTime>(positions, fps);
+    const qint64 ticks = qMax(qint64(1), timer.nsecsElapsed());
+    qDebug() << "Map operations on" << positions.size() << "items, previous:" << legacy / 1000 << "us, ticks:" << ticks / 1000 << "us";
+    REQUIRE(checksum == legacyChecksum);
+}
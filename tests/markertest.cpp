@@ -66,7 +66,6 @@ TEST_CASE("Marker model", "[MarkerListModel]")
 {
     auto binModel = pCore->projectItemModel();
     fps = pCore->getCurrentFps();
-    GenTime::setFps(fps);
     std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
     KdenliveDoc document(undoStack);
     pCore->projectManager()->testSetDocument(&document);
@@ -0,0 +1,111 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "doc/kdenlivedoc.h"
+#include "jobs/proxytask.h"
+#include "xml/xml.hpp"
+
+#include <QTemporaryDir>
+
+TEST_CASE("Proxy of the used ranges", "[ProxyRanges]")
+{
+    SECTION("Used ranges are merged with their handles")
+    {
+        const QVector<QPoint> used = {QPoint(500, 600), QPoint(100, 200), QPoint(180, 250), QPoint(2990, 3100)};
+        // Without handles only the overlapping ranges are merged
+        REQUIRE(ProxyTask::mergeRanges(used, 0, 3000) == QVector<QPoint>({QPoint(100, 250), QPoint(500, 600), QPoint(2990, 2999)}));
+        REQUIRE(ProxyTask::mergeRanges(used, 125, 3000) == QVector<QPoint>({QPoint(0, 725), QPoint(2865, 2999)}));
+        REQUIRE(ProxyTask::mergeRanges({QPoint(10, 20), QPoint(21, 30)}, 0, 100) == QVector<QPoint>({QPoint(10, 30)}));
+        // Time remapped clips use the whole source
+        REQUIRE(ProxyTask::mergeRanges({QPoint(0, INT_MAX)}, 125, 3000) == QVector<QPoint>({QPoint(0, 2999)}));
+        REQUIRE(ProxyTask::mergeRanges({QPoint(4000, 4100)}, 0, 3000).isEmpty());
+    }
+
+    SECTION("Trimming outside of the proxy ranges is detected")
+    {
+        const QVector<QPoint> covered = ProxyTask::mergeRanges({QPoint(100, 200), QPoint(500, 600)}, 25, 3000);
+        REQUIRE(ProxyTask::coversRanges(covered, {QPoint(90, 210), QPoint(520, 600)}));
+        REQUIRE_FALSE(ProxyTask::coversRanges(covered, {QPoint(90, 300)}));
+        REQUIRE_FALSE(ProxyTask::coversRanges(covered, {QPoint(700, 710)}));
+        REQUIRE_FALSE(ProxyTask::coversRanges({}, {QPoint(0, 1)}));
+    }
+
+    SECTION("Ranges are stored in a clip property")
+    {
+        const QVector<QPoint> ranges = {QPoint(0, 725), QPoint(2865, 2999)};
+        REQUIRE(ProxyTask::rangesToString(ranges) == QStringLiteral("0:725;2865:2999"));
+        REQUIRE(ProxyTask::rangesFromString(ProxyTask::rangesToString(ranges)) == ranges);
+        REQUIRE(ProxyTask::rangesFromString(QString()).isEmpty());
+        REQUIRE(ProxyTask::rangesFromString(QStringLiteral("12:4;a:3")).isEmpty());
+        REQUIRE(ProxyTask::isRangeProxy(QStringLiteral("/tmp/proxy/abc.mkv.mlt")));
+        REQUIRE_FALSE(ProxyTask::isRangeProxy(QStringLiteral("/tmp/proxy/abc.mkv")));
+    }
+}
+
+TEST_CASE("Reopen a project with a range proxy", "[ProxyRanges]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+
+    // Create document
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+
+    // A range proxy with one segment, placed like ProxyTask does
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString source = QFileInfo(sourcesPath + "/small.mkv").absoluteFilePath();
+    REQUIRE(QFile::copy(source, dir.filePath(QStringLiteral("abc-0-24.mkv"))));
+    const QString proxyPath = dir.filePath(QStringLiteral("abc.mkv.mlt"));
+    QFile file(proxyPath);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    file.write("<mlt LC_NUMERIC=\"C\"><producer id=\"segment0\"><property name=\"resource\">abc-0-24.mkv</property>"
+               "<property name=\"mlt_service\">avformat</property></producer><playlist id=\"proxy\">"
+               "<entry producer=\"segment0\" in=\"0\" out=\"24\"/><blank length=\"5\"/></playlist></mlt>");
+    file.close();
+    REQUIRE(ProxyTask::rangeProxySegments(proxyPath) == QStringList({dir.filePath(QStringLiteral("abc-0-24.mkv"))}));
+
+    // The clip as it is read from the saved project: the xml producer of the proxy with the properties of the clip
+    std::shared_ptr<Mlt::Producer> producer = std::make_shared<Mlt::Producer>(pCore->getProjectProfile(), "xml", proxyPath.toUtf8().constData());
+    REQUIRE(producer->is_valid());
+    producer->set("resource", proxyPath.toUtf8().constData());
+    producer->set("kdenlive:proxy", proxyPath.toUtf8().constData());
+    producer->set("kdenlive:originalurl", source.toUtf8().constData());
+    producer->set("kdenlive:proxyranges", "0:24");
+    producer->set("kdenlive:clip_type", 0);
+    producer->set("audio_index", 1);
+    producer->set("video_index", 0);
+    QString binId = QString::number(binModel->getFreeClipId());
+    auto binClip = ProjectClip::construct(binId, QIcon(), binModel, producer);
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+    REQUIRE(binModel->addItem(binClip, binModel->getRootFolder()->clipId(), undo, redo));
+
+    SECTION("The clip keeps its type and audio streams")
+    {
+        REQUIRE(binClip->clipType() == ClipType::AV);
+        REQUIRE(binClip->audioInfo() != nullptr);
+        REQUIRE(binClip->audioInfo()->streams().keys() == QList<int>({1}));
+        REQUIRE(binClip->getProducerIntProperty(QStringLiteral("audio_index")) == 1);
+    }
+
+    SECTION("Audio producers select the stream in the segments")
+    {
+        QDomDocument doc;
+        doc.setContent(ProxyTask::rangeProxyXml(proxyPath, 1, 0));
+        const QDomElement segment = doc.documentElement().firstChildElement(QStringLiteral("producer"));
+        REQUIRE(Xml::getXmlProperty(segment, QStringLiteral("resource")) == dir.filePath(QStringLiteral("abc-0-24.mkv")));
+        REQUIRE(Xml::getXmlProperty(segment, QStringLiteral("audio_index")) == QStringLiteral("1"));
+        REQUIRE(Xml::getXmlProperty(segment, QStringLiteral("astream")) == QStringLiteral("0"));
+    }
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
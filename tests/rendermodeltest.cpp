@@ -279,3 +279,24 @@ TEST_CASE("Tests of the render functions to use guides for sections", "[RenderRe
         CHECK(sections.at(2).second == out);
     }
 }
+
+TEST_CASE("Render arguments of jobs sharing a playlist", "[RenderRequestGuides]")
+{
+    RenderRequest::RenderJob job;
+    job.playlistPath = QStringLiteral("/tmp/shared.mlt");
+    job.outputPath = QStringLiteral("/tmp/out-chapter.mp4");
+
+    // A job with its own playlist uses the range and target of the playlist
+    QStringList args = RenderRequest::argsByJob(job);
+    CHECK(args.at(2) == job.playlistPath);
+    CHECK_FALSE(args.contains(QStringLiteral("--in")));
+    CHECK_FALSE(args.contains(QStringLiteral("--output")));
+
+    job.in = 25;
+    job.out = 50;
+    args = RenderRequest::argsByJob(job);
+    CHECK(args.at(2) == job.playlistPath);
+    CHECK(args.at(args.indexOf(QStringLiteral("--in")) + 1) == QStringLiteral("25"));
+    CHECK(args.at(args.indexOf(QStringLiteral("--out")) + 1) == QStringLiteral("50"));
+    CHECK(args.at(args.indexOf(QStringLiteral("--output")) + 1) == job.outputPath);
+}
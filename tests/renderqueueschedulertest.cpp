@@ -0,0 +1,104 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "render/renderqueuescheduler.h"
+
+using State = RenderQueueScheduler::State;
+
+static RenderQueueScheduler::Job makeJob(const QString &id, int threads, int memory = 0, State state = State::Waiting)
+{
+    RenderQueueScheduler::Job job;
+    job.id = id;
+    job.output = id + QStringLiteral(".mp4");
+    job.threads = threads;
+    job.memory = memory;
+    job.state = state;
+    return job;
+}
+
+TEST_CASE("Render queue admission", "[RenderQueue]")
+{
+    RenderQueueScheduler::Budget budget;
+    budget.threads = 8;
+    budget.memory = 4000;
+
+    SECTION("Jobs are started while they fit in the budget")
+    {
+        std::vector<RenderQueueScheduler::Job> queue = {makeJob("a", 4, 1000), makeJob("b", 2, 1000), makeJob("c", 4, 1000)};
+        auto admitted = RenderQueueScheduler::admit(queue, budget);
+        REQUIRE(admitted == std::vector<size_t>({0, 1}));
+        // Running jobs consume the budget
+        queue[0].state = State::Running;
+        queue[1].state = State::Running;
+        REQUIRE(RenderQueueScheduler::admit(queue, budget).empty());
+        queue[0].state = State::Done;
+        REQUIRE(RenderQueueScheduler::admit(queue, budget) == std::vector<size_t>({2}));
+    }
+
+    SECTION("Memory budget is respected")
+    {
+        std::vector<RenderQueueScheduler::Job> queue = {makeJob("a", 1, 3000), makeJob("b", 1, 2000)};
+        REQUIRE(RenderQueueScheduler::admit(queue, budget) == std::vector<size_t>({0}));
+        budget.memory = 0;
+        REQUIRE(RenderQueueScheduler::admit(queue, budget) == std::vector<size_t>({0, 1}));
+    }
+
+    SECTION("Queue order is kept")
+    {
+        // The small job queued after a large one waits for it
+        std::vector<RenderQueueScheduler::Job> queue = {makeJob("a", 6, 0, State::Running), makeJob("b", 4), makeJob("c", 1)};
+        REQUIRE(RenderQueueScheduler::admit(queue, budget).empty());
+    }
+
+    SECTION("A job larger than the budget runs alone")
+    {
+        std::vector<RenderQueueScheduler::Job> queue = {makeJob("a", 16), makeJob("b", 1)};
+        REQUIRE(RenderQueueScheduler::admit(queue, budget) == std::vector<size_t>({0}));
+        queue[0].state = State::Running;
+        REQUIRE(RenderQueueScheduler::admit(queue, budget).empty());
+    }
+
+    SECTION("Jobs writing the same file do not run together")
+    {
+        std::vector<RenderQueueScheduler::Job> queue = {makeJob("a", 1), makeJob("b", 1)};
+        queue[1].output = queue[0].output;
+        REQUIRE(RenderQueueScheduler::admit(queue, budget) == std::vector<size_t>({0}));
+    }
+}
+
+TEST_CASE("Render queue dependencies", "[RenderQueue]")
+{
+    RenderQueueScheduler::Budget budget;
+    std::vector<RenderQueueScheduler::Job> queue = {makeJob("pass1", 2), makeJob("pass2", 2), makeJob("other", 2)};
+    queue[1].output = queue[0].output;
+    queue[1].dependsOn = queue[0].id;
+
+    REQUIRE(RenderQueueScheduler::admit(queue, budget) == std::vector<size_t>({0, 2}));
+    queue[0].state = State::Running;
+    queue[2].state = State::Running;
+    REQUIRE(RenderQueueScheduler::admit(queue, budget).empty());
+    REQUIRE(RenderQueueScheduler::blocked(queue).empty());
+
+    SECTION("Dependent job starts when its dependency is done")
+    {
+        queue[0].state = State::Done;
+        REQUIRE(RenderQueueScheduler::admit(queue, budget) == std::vector<size_t>({1}));
+    }
+
+    SECTION("Dependent job is blocked when its dependency failed")
+    {
+        queue[0].state = State::Failed;
+        REQUIRE(RenderQueueScheduler::admit(queue, budget).empty());
+        REQUIRE(RenderQueueScheduler::blocked(queue) == std::vector<size_t>({1}));
+    }
+
+    SECTION("A removed dependency is considered done")
+    {
+        queue.erase(queue.begin());
+        REQUIRE(RenderQueueScheduler::admit(queue, budget) == std::vector<size_t>({0}));
+    }
+}
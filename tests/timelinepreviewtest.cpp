@@ -67,11 +67,14 @@ TEST_CASE("Timeline preview insert-remove", "[TimelinePreview]")
         qDebug() << ":::: WAITING FOR PROGRESS...";
         qApp->processEvents();
     }
-    QFileInfoList list = dir.entryInfoList(QDir::Files, QDir::Time);
+    // Chunks are moved to the shared chunk store, named by their content
+    QDir chunksDir = document.getCacheDir(CachePreviewChunks, &ok);
+    REQUIRE(ok);
+    QFileInfoList list = chunksDir.entryInfoList(QDir::Files, QDir::Time);
     for (auto &file : list) {
-        qDebug() << "::: FOUND FILE: " << dir.absoluteFilePath(file.fileName());
+        qDebug() << "::: FOUND FILE: " << chunksDir.absoluteFilePath(file.fileName());
     }
-    if (list.size() != 3) {
+    if (timeline->previewManager()->previewChunks().first != QStringList{QStringLiteral("0-50")}) {
         QProcess p;
         const QString ffpath = QStandardPaths::findExecutable(QStringLiteral("melt"));
         p.start(ffpath, {QStringLiteral("-query"), QStringLiteral("formats")});
@@ -80,8 +83,12 @@ TEST_CASE("Timeline preview insert-remove", "[TimelinePreview]")
                  << p.readAllStandardOutput() << "\n----------\n"
                  << p.readAllStandardError();
     }
-    // This should create 3 output chunks
-    REQUIRE(list.size() == 3);
+    // All the chunks of the range are rendered
+    REQUIRE(timeline->previewManager()->previewChunks().first == QStringList{QStringLiteral("0-50")});
+    REQUIRE(timeline->previewManager()->previewChunks().second.isEmpty());
+    // The chunks of the empty timeline have the same content, they are stored in the shared chunk store, not in the project preview folder
+    REQUIRE(!list.isEmpty());
+    REQUIRE(dir.entryList({QStringLiteral("*.avi")}, QDir::Files).isEmpty());
 
     // Create and insert clip
     int cid1 = -1;
@@ -89,15 +96,26 @@ TEST_CASE("Timeline preview insert-remove", "[TimelinePreview]")
     QMap<int, QString> audioInfo;
     audioInfo.insert(1, QStringLiteral("stream1"));
     KdenliveTests::setAudioTargets(timeline, audioInfo);
+    const QString emptyHash = timeline->sequenceHash();
     REQUIRE(timeline->requestClipInsertion(binId, tid3, 50, cid1, true, true, false));
     REQUIRE(timeline->getClipsCount() == 1);
+    REQUIRE(timeline->sequenceHash() != emptyHash);
+    // A color clip that does not cover the sequence leaves the background visible, a rendered preview cannot replace it when nested
+    REQUIRE_FALSE(timeline->isOpaque());
     timeline->previewManager()->invalidatePreviews();
-    list = dir.entryInfoList(QDir::Files, QDir::Time);
-    for (auto &file : list) {
-        qDebug() << "::: FOUND FILE AFTER: " << file.fileName();
-    }
     // 2 chunks should remain
-    REQUIRE(list.size() == 2);
+    REQUIRE(timeline->previewManager()->previewChunks().first == QStringList{QStringLiteral("0-25")});
+    REQUIRE(timeline->previewManager()->previewChunks().second == QStringList{QStringLiteral("50")});
+
+    // Undo restores the previous content, its chunk is reused without rendering
+    undoStack->undo();
+    REQUIRE(timeline->getClipsCount() == 0);
+    // Nested instances of the sequence do not need a reload
+    REQUIRE(timeline->sequenceHash() == emptyHash);
+    timeline->previewManager()->invalidatePreviews();
+    REQUIRE(timeline->previewManager()->previewChunks().first == QStringList{QStringLiteral("0-50")});
+    REQUIRE(timeline->previewManager()->previewChunks().second.isEmpty());
+    REQUIRE_FALSE(timeline->previewManager()->isRunning());
     timeline->resetPreviewManager();
     // Ensure preview project folder is deleted on close
     REQUIRE(dir.exists() == false);
@@ -0,0 +1,79 @@
+/*
+    SPDX-FileCopyrightText: 2026 Kdenlive contributors
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "utils/trace.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTemporaryDir>
+#include <thread>
+
+namespace {
+void tracedWork()
+{
+    KDENLIVE_TRACE("test", "tracedWork");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+}
+} // namespace
+
+TEST_CASE("Scoped traces are exported as Chrome trace events", "[Trace]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString path = dir.filePath(QStringLiteral("trace.json"));
+
+    SECTION("Nothing is recorded when tracing is not started")
+    {
+        REQUIRE_FALSE(Trace::isRecording());
+        tracedWork();
+        REQUIRE(Trace::stop());
+        REQUIRE_FALSE(QFile::exists(path));
+    }
+
+#ifdef KDENLIVE_TRACING
+    SECTION("Events of all threads are written")
+    {
+        Trace::start(path);
+        REQUIRE(Trace::isRecording());
+        tracedWork();
+        std::thread worker([]() {
+            tracedWork();
+            tracedWork();
+        });
+        worker.join();
+        REQUIRE(Trace::stop());
+        REQUIRE_FALSE(Trace::isRecording());
+        // Scopes ending after the trace was written are ignored
+        tracedWork();
+
+        QFile file(path);
+        REQUIRE(file.open(QIODevice::ReadOnly));
+        QJsonParseError error;
+        const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+        REQUIRE(error.error == QJsonParseError::NoError);
+        const QJsonArray events = doc.object().value(QStringLiteral("traceEvents")).toArray();
+        int workEvents = 0;
+        QSet<qint64> threads;
+        for (const auto &value : events) {
+            const QJsonObject event = value.toObject();
+            if (event.value(QStringLiteral("ph")).toString() != QLatin1String("X")) {
+                continue;
+            }
+            REQUIRE(event.value(QStringLiteral("cat")).toString() == QLatin1String("test"));
+            REQUIRE(event.value(QStringLiteral("name")).toString() == QLatin1String("tracedWork"));
+            REQUIRE(event.value(QStringLiteral("dur")).toDouble() >= 1000);
+            threads.insert(qint64(event.value(QStringLiteral("tid")).toDouble()));
+            workEvents++;
+        }
+        REQUIRE(workEvents == 3);
+        REQUIRE(threads.size() == 2);
+    }
+#endif
+}
@@ -7,6 +7,9 @@
 #include "test_utils.hpp"
 // test specific headers
 #include "utils/qstringutils.h"
+#include "utils/rankedmap.hpp"
+
+#include <random>
 
 TEST_CASE("Testing for different utils", "[Utils]")
 {
@@ -29,4 +32,36 @@ TEST_CASE("Testing for different utils", "[Utils]")
 
         REQUIRE(names.removeDuplicates() == 0);
     }
+
+    SECTION("Ranked map gives the row of its keys")
+    {
+        RankedMap<int, int> map;
+        std::map<int, int> reference;
+        std::mt19937 generator(42);
+        for (int i = 0; i < 5000; i++) {
+            int key = int(generator() % 500);
+            if (generator() % 3 == 0) {
+                REQUIRE(map.erase(key) == reference.erase(key));
+            } else {
+                map[key] = i;
+                reference[key] = i;
+            }
+        }
+        REQUIRE(map.size() == reference.size());
+        int row = 0;
+        for (const auto &item : reference) {
+            REQUIRE(map.rank(item.first) == row);
+            auto it = map.nth(row);
+            REQUIRE(it != map.end());
+            REQUIRE(it->first == item.first);
+            REQUIRE(it->second == item.second);
+            row++;
+        }
+        REQUIRE(map.nth(row) == map.end());
+        REQUIRE(map.nth(-1) == map.end());
+        REQUIRE(map.rank(1000) == -1);
+        map.clear();
+        REQUIRE(map.empty());
+        REQUIRE(map.rank(reference.begin()->first) == -1);
+    }
 }